@@ -7,6 +7,9 @@ AVehicleImpactEffect::AVehicleImpactEffect(const FObjectInitializer& ObjectIniti
 {
 	PrimaryActorTick.bCanEverTick = true;
 	bAutoDestroyWhenFinished = true;
+
+	// cosmetic only, replay playback spawns its own from replicated vehicle hits
+	bRelevantForNetworkReplays = false;
 }
 
 void AVehicleImpactEffect::PostInitializeComponents()
@@ -0,0 +1,504 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Ghost/VehicleGhostManager.h"
+#include "VehicleGameState.h"
+#include "Pawns/BuggyPawn.h"
+#include "WheeledVehicleMovementComponent.h"
+#include "PhysXVehicleManager.h"
+#include "GameFramework/PlayerStart.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ghost playback"), STAT_GhostPlayback, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ghosts"), STAT_NumGhosts, STATGROUP_VehicleGame);
+
+FVehicleGhostPlayback::FVehicleGhostPlayback(const TSharedPtr<TArray<uint8>>& InData)
+	: Data(InData)
+	, Reader(InData->GetData(), InData->Num())
+	, NextSampleTime(0.0f)
+	, PlaybackTime(0.0f)
+	, EngineRPM(0.0f)
+	, Proxy(nullptr)
+	, Audio(nullptr)
+	, bFinished(false)
+{
+}
+
+AVehicleGhostManager::AVehicleGhostManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	GhostMesh = TSoftObjectPtr<USkeletalMesh>(FSoftObjectPath(TEXT("/Game/Core_Code/Vehicles/VH_Buggy/Mesh/SK_Buggy_Vehicle.SK_Buggy_Vehicle")));
+	GhostMaterial = nullptr;
+	GhostEngineSound = nullptr;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneComp"));
+
+	MaxAudibleGhosts = 3;
+	GhostAudioRadius = 5000.0f;
+	GhostAudioUpdateInterval = 0.25f;
+	bLoopGhosts = false;
+	LastAudioUpdateTime = 0.0f;
+
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+void AVehicleGhostManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState)
+	{
+		VehicleGameState->RegisterGhostManager(this);
+	}
+}
+
+void AVehicleGhostManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UpdateGhosts(DeltaSeconds);
+
+	if (GetWorld()->GetTimeSeconds() >= LastAudioUpdateTime + GhostAudioUpdateInterval)
+	{
+		LastAudioUpdateTime = GetWorld()->GetTimeSeconds();
+		UpdateGhostAudio();
+	}
+}
+
+void AVehicleGhostManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState)
+	{
+		VehicleGameState->UnregisterGhostManager(this);
+	}
+
+	ClearGhosts();
+	LoadedGhostFiles.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+int32 AVehicleGhostManager::AddGhost(const FString& Filename, float StartTime)
+{
+	TSharedPtr<TArray<uint8>>& Data = LoadedGhostFiles.FindOrAdd(Filename);
+	if (!Data.IsValid())
+	{
+		// whole file is kept in memory, a lap is only tens of KB
+		Data = MakeShareable(new TArray<uint8>());
+		if (!FFileHelper::LoadFileToArray(*Data, *Filename))
+		{
+			UE_LOG(LogVehicle, Warning, TEXT("Failed to load ghost file %s"), *Filename);
+			LoadedGhostFiles.Remove(Filename);
+			return INDEX_NONE;
+		}
+	}
+
+	return AddGhostFromData(Data, StartTime);
+}
+
+int32 AVehicleGhostManager::AddGhostFromData(const TSharedPtr<TArray<uint8>>& Data, float StartTime)
+{
+	if (!Data.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	FVehicleGhostPlayback NewGhost(Data);
+	if (!NewGhost.Reader.IsValid() || !NewGhost.Reader.ReadSample(NewGhost.NextSample))
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("Invalid ghost stream"));
+		return INDEX_NONE;
+	}
+	NewGhost.PrevSample = NewGhost.NextSample;
+
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		NewGhost.Proxy = AcquireProxy();
+	}
+
+	const int32 GhostIndex = Ghosts.Add(NewGhost);
+	if (!AdvanceGhost(Ghosts[GhostIndex], StartTime))
+	{
+		ReleaseGhostComponents(Ghosts[GhostIndex]);
+	}
+	return GhostIndex;
+}
+
+void AVehicleGhostManager::ClearGhosts()
+{
+	for (FVehicleGhostPlayback& Ghost : Ghosts)
+	{
+		ReleaseGhostComponents(Ghost);
+	}
+	Ghosts.Reset();
+}
+
+void AVehicleGhostManager::ReleaseGhostComponents(FVehicleGhostPlayback& Ghost)
+{
+	if (Ghost.Proxy)
+	{
+		Ghost.Proxy->SetVisibility(false);
+		FreeProxies.Add(Ghost.Proxy);
+		Ghost.Proxy = nullptr;
+	}
+	if (Ghost.Audio)
+	{
+		Ghost.Audio->Stop();
+		FreeAudio.Add(Ghost.Audio);
+		Ghost.Audio = nullptr;
+	}
+}
+
+int32 AVehicleGhostManager::GetNumGhosts() const
+{
+	return Ghosts.Num();
+}
+
+bool AVehicleGhostManager::GetGhostTransform(int32 GhostIndex, FTransform& OutTransform) const
+{
+	if (Ghosts.IsValidIndex(GhostIndex))
+	{
+		OutTransform = Ghosts[GhostIndex].Transform;
+		return true;
+	}
+	return false;
+}
+
+void AVehicleGhostManager::UpdateGhosts(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GhostPlayback);
+	SET_DWORD_STAT(STAT_NumGhosts, Ghosts.Num());
+
+	for (FVehicleGhostPlayback& Ghost : Ghosts)
+	{
+		if (Ghost.bFinished)
+		{
+			continue;
+		}
+
+		// finished ghosts keep their last transform, their proxy and sound go back to the free lists
+		if (!AdvanceGhost(Ghost, DeltaSeconds))
+		{
+			ReleaseGhostComponents(Ghost);
+			continue;
+		}
+
+		if (Ghost.Proxy)
+		{
+			Ghost.Proxy->SetWorldLocationAndRotation(Ghost.Transform.GetLocation(), Ghost.Transform.GetRotation());
+		}
+		if (Ghost.Audio)
+		{
+			Ghost.Audio->SetPitchMultiplier(FMath::GetMappedRangeValueClamped(FVector2D(0.0f, 7000.0f), FVector2D(0.5f, 2.0f), Ghost.EngineRPM));
+		}
+	}
+}
+
+bool AVehicleGhostManager::AdvanceGhost(FVehicleGhostPlayback& Ghost, float DeltaSeconds)
+{
+	const float SampleInterval = 1.0f / Ghost.Reader.GetSampleRate();
+	Ghost.PlaybackTime += DeltaSeconds;
+
+	// decode forward only as far as needed, PrevSample..NextSample always bracket playback time
+	while (Ghost.PlaybackTime > Ghost.NextSampleTime)
+	{
+		Ghost.PrevSample = Ghost.NextSample;
+		if (Ghost.Reader.ReadSample(Ghost.NextSample))
+		{
+			Ghost.NextSampleTime += SampleInterval;
+			continue;
+		}
+
+		if (!bLoopGhosts || Ghost.NextSampleTime <= 0.0f)
+		{
+			Ghost.PlaybackTime = Ghost.NextSampleTime;
+			Ghost.bFinished = true;
+			break;
+		}
+
+		// jump back to the start without blending across the whole track
+		Ghost.PlaybackTime -= Ghost.NextSampleTime;
+		Ghost.NextSampleTime = 0.0f;
+		Ghost.Reader.Rewind();
+		Ghost.Reader.ReadSample(Ghost.NextSample);
+		Ghost.PrevSample = Ghost.NextSample;
+	}
+
+	const float Alpha = FMath::Clamp(1.0f - (Ghost.NextSampleTime - Ghost.PlaybackTime) / SampleInterval, 0.0f, 1.0f);
+	Ghost.Transform.SetLocation(FMath::Lerp(Ghost.PrevSample.Location, Ghost.NextSample.Location, Alpha));
+	Ghost.Transform.SetRotation(FQuat::Slerp(Ghost.PrevSample.Rotation.Quaternion(), Ghost.NextSample.Rotation.Quaternion(), Alpha));
+	Ghost.EngineRPM = FMath::Lerp(Ghost.PrevSample.EngineRPM, Ghost.NextSample.EngineRPM, Alpha);
+
+	return !Ghost.bFinished;
+}
+
+void AVehicleGhostManager::UpdateGhostAudio()
+{
+	if (GhostEngineSound == nullptr || GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	// one mix for all split-screen views, a ghost is as close as it is to the nearest listener
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+	if (ViewLocations.Num() == 0)
+	{
+		return;
+	}
+
+	// closest running ghosts within radius get the sound
+	TArray<TPair<float, int32>, TInlineAllocator<64>> Candidates;
+	for (int32 i = 0; i < Ghosts.Num(); i++)
+	{
+		float DistSq = MAX_flt;
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			DistSq = FMath::Min(DistSq, FVector::DistSquared(Ghosts[i].Transform.GetLocation(), ViewLocation));
+		}
+		if (!Ghosts[i].bFinished && Ghosts[i].Proxy && DistSq < FMath::Square(GhostAudioRadius))
+		{
+			Candidates.Add(TPair<float, int32>(DistSq, i));
+		}
+	}
+	Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+	Candidates.SetNum(FMath::Min(Candidates.Num(), MaxAudibleGhosts), false);
+
+	for (int32 i = 0; i < Ghosts.Num(); i++)
+	{
+		FVehicleGhostPlayback& Ghost = Ghosts[i];
+		if (Ghost.Audio && !Candidates.ContainsByPredicate([i](const TPair<float, int32>& Candidate) { return Candidate.Value == i; }))
+		{
+			Ghost.Audio->Stop();
+			FreeAudio.Add(Ghost.Audio);
+			Ghost.Audio = nullptr;
+		}
+	}
+
+	for (const TPair<float, int32>& Candidate : Candidates)
+	{
+		FVehicleGhostPlayback& Ghost = Ghosts[Candidate.Value];
+		if (Ghost.Audio)
+		{
+			continue;
+		}
+
+		if (FreeAudio.Num() > 0)
+		{
+			Ghost.Audio = FreeAudio.Pop(false);
+		}
+		else
+		{
+			Ghost.Audio = NewObject<UAudioComponent>(this);
+			Ghost.Audio->bAutoActivate = false;
+			Ghost.Audio->SetSound(GhostEngineSound);
+			Ghost.Audio->RegisterComponent();
+			AudioPool.Add(Ghost.Audio);
+		}
+
+		Ghost.Audio->AttachToComponent(Ghost.Proxy, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		Ghost.Audio->Play();
+	}
+}
+
+USkeletalMeshComponent* AVehicleGhostManager::AcquireProxy()
+{
+	if (FreeProxies.Num() > 0)
+	{
+		USkeletalMeshComponent* Proxy = FreeProxies.Pop(false);
+		Proxy->SetVisibility(true);
+		return Proxy;
+	}
+
+	// reference pose only: no collision, no physics bodies, no animation tick
+	USkeletalMeshComponent* Proxy = NewObject<USkeletalMeshComponent>(this);
+	Proxy->PrimaryComponentTick.bCanEverTick = false;
+	Proxy->bNoSkeletonUpdate = true;
+	Proxy->bGenerateOverlapEvents = false;
+	Proxy->CastShadow = false;
+	Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	// buggies on clients already hold the mesh, so this rarely loads anything
+	Proxy->SetSkeletalMesh(GhostMesh.LoadSynchronous());
+	if (GhostMaterial)
+	{
+		for (int32 i = 0; i < Proxy->GetNumMaterials(); i++)
+		{
+			Proxy->SetMaterial(i, GhostMaterial);
+		}
+	}
+	Proxy->RegisterComponent();
+	return Proxy;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static AVehicleGhostManager* FindOrSpawnGhostManager(UWorld* World)
+{
+	for (TActorIterator<AVehicleGhostManager> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AVehicleGhostManager>(SpawnInfo);
+}
+
+static void GhostPlay(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1 || World == nullptr)
+	{
+		UE_LOG(LogVehicle, Display, TEXT("Usage: vehicle.GhostPlay <Filename> [Count]"));
+		return;
+	}
+
+	AVehicleGhostManager* Manager = FindOrSpawnGhostManager(World);
+	const int32 Count = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1, 1);
+	for (int32 i = 0; i < Count && Manager; i++)
+	{
+		Manager->AddGhost(Args[0], i * 0.5f);
+	}
+}
+
+/** time PhysX vehicle update of every vehicle in the world, s per frame */
+static double MeasureVehicleUpdate(FPhysScene* PhysScene, FPhysXVehicleManager* VehicleManager, int32 NumFrames, float DeltaSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		VehicleManager->Update(PhysScene, PST_Sync, DeltaSeconds);
+	}
+	return (FPlatformTime::Seconds() - StartTime) / NumFrames;
+}
+
+/** time game thread tick and PhysX vehicle update of one driving buggy, s per frame, negative if it could not be spawned */
+static double MeasureLiveBuggy(UWorld* World, int32 NumFrames, float DeltaSeconds)
+{
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	UClass* PawnClass = (GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf(ABuggyPawn::StaticClass())) ? *GameMode->DefaultPawnClass : nullptr;
+	FPhysScene* PhysScene = World->GetPhysicsScene();
+	FPhysXVehicleManager* VehicleManager = PhysScene ? FPhysXVehicleManager::GetVehicleManagerFromScene(PhysScene) : nullptr;
+	if (PawnClass == nullptr || VehicleManager == nullptr)
+	{
+		return -1.0;
+	}
+
+	// manager updates every vehicle of the world, only the time added by the new one counts
+	const double OthersTime = MeasureVehicleUpdate(PhysScene, VehicleManager, NumFrames, DeltaSeconds);
+
+	FTransform SpawnTransform(FVector(0.0f, 0.0f, 500.0f));
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		SpawnTransform = It->GetActorTransform();
+		break;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ABuggyPawn* Buggy = World->SpawnActor<ABuggyPawn>(PawnClass, SpawnTransform, SpawnInfo);
+	UWheeledVehicleMovementComponent* Movement = Buggy ? Buggy->GetVehicleMovementComponent() : nullptr;
+	if (Movement == nullptr)
+	{
+		if (Buggy)
+		{
+			Buggy->Destroy();
+		}
+		return -1.0;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		Movement->SetThrottleInput(1.0f);
+		Buggy->TickActor(DeltaSeconds, LEVELTICK_All, Buggy->PrimaryActorTick);
+		Movement->TickComponent(DeltaSeconds, LEVELTICK_All, &Movement->PrimaryComponentTick);
+		VehicleManager->Update(PhysScene, PST_Sync, DeltaSeconds);
+	}
+	const double FrameTime = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+	Buggy->Destroy();
+	return FMath::Max(FrameTime - OthersTime, 0.0);
+}
+
+static void GhostPlaybackBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const int32 NumGhosts = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50, 1);
+	const int32 NumFrames = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 600, 1);
+	const int32 SampleRate = 20;
+
+	// one minute lap shared by all ghosts
+	TSharedPtr<TArray<uint8>> Data = MakeShareable(new TArray<uint8>());
+	{
+		FMemoryWriter MemoryWriter(*Data);
+		FVehicleGhostWriter Writer(&MemoryWriter, SampleRate);
+		for (int32 i = 0; i < SampleRate * 60; i++)
+		{
+			Writer.AddSample(FVehicleGhostSample::MakeSynthetic((float)i / SampleRate));
+		}
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	AVehicleGhostManager* Manager = World->SpawnActor<AVehicleGhostManager>(SpawnInfo);
+	if (Manager == nullptr)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < NumGhosts; i++)
+	{
+		Manager->AddGhostFromData(Data, i * 0.5f);
+	}
+
+	const float DeltaSeconds = 1.0f / 60.0f;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		Manager->UpdateGhosts(DeltaSeconds);
+	}
+	const double FrameTime = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+	Manager->Destroy();
+
+	UE_LOG(LogVehicle, Display, TEXT("Ghost playback: %d ghosts, %.3f ms per frame, %.2f us per ghost (%d frames, stream %d bytes)"),
+		NumGhosts, FrameTime * 1000.0, FrameTime * 1e6 / NumGhosts, NumFrames, Data->Num());
+
+	const double BuggyFrameTime = MeasureLiveBuggy(World, NumFrames, DeltaSeconds);
+	if (BuggyFrameTime < 0.0)
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("Live buggy: not measured, needs a game mode with buggy default pawn and PhysX vehicles"));
+		return;
+	}
+
+	// rigid body solver step of the chassis is not included, the live buggy costs at least this much
+	UE_LOG(LogVehicle, Display, TEXT("Live buggy: %.3f ms per frame for tick and vehicle update, %d ghosts cost %.2fx of one live buggy"),
+		BuggyFrameTime * 1000.0, NumGhosts, BuggyFrameTime > 0.0 ? FrameTime / BuggyFrameTime : 0.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GhostPlayCmd(
+	TEXT("vehicle.GhostPlay"),
+	TEXT("Plays ghost file. Usage: vehicle.GhostPlay <Filename> [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&GhostPlay));
+
+static FAutoConsoleCommandWithWorldAndArgs GhostPlaybackBenchmarkCmd(
+	TEXT("vehicle.GhostPlaybackBenchmark"),
+	TEXT("Measures game thread cost of ghost playback against one live buggy. Usage: vehicle.GhostPlaybackBenchmark [NumGhosts] [NumFrames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&GhostPlaybackBenchmark));
@@ -0,0 +1,160 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Ghost/VehicleGhostRecorderComponent.h"
+#include "WheeledVehicle.h"
+#include "WheeledVehicleMovementComponent.h"
+#include "VehicleWheel.h"
+
+static TAutoConsoleVariable<int32> CVarGhostRecord(
+	TEXT("vehicle.GhostRecord"),
+	0,
+	TEXT("Record every vehicle into Saved/Ghosts on the server.\n")
+	TEXT("0: off, 1: on"));
+
+UVehicleGhostRecorderComponent::UVehicleGhostRecorderComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	SampleRate = 20;
+	SampleAccumulator = 0.0f;
+}
+
+void UVehicleGhostRecorderComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	EnableAutoRecording();
+}
+
+void UVehicleGhostRecorderComponent::EnableAutoRecording()
+{
+	// wait for PlayerState before opening the file, it names the ghost
+	if (CVarGhostRecord.GetValueOnGameThread() != 0 && GetOwnerRole() == ROLE_Authority)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UVehicleGhostRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UVehicleGhostRecorderComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!IsRecording())
+	{
+		APawn* OwnerPawn = Cast<APawn>(GetOwner());
+		if (OwnerPawn == nullptr || OwnerPawn->PlayerState == nullptr)
+		{
+			return;
+		}
+		StartRecording();
+	}
+
+	if (IsRecording())
+	{
+		// fixed rate stream, repeat the state if frame is longer than sample interval
+		const float SampleInterval = 1.0f / SampleRate;
+		SampleAccumulator += DeltaTime;
+		if (SampleAccumulator >= SampleInterval)
+		{
+			FVehicleGhostSample Sample;
+			CaptureSample(Sample);
+			while (SampleAccumulator >= SampleInterval)
+			{
+				GhostWriter->AddSample(Sample);
+				SampleAccumulator -= SampleInterval;
+			}
+		}
+	}
+}
+
+void UVehicleGhostRecorderComponent::StartRecording()
+{
+	StopRecording();
+
+	APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	const FString RacerName = (OwnerPawn && OwnerPawn->PlayerState) ? OwnerPawn->PlayerState->PlayerName : GetOwner()->GetName();
+	const FString GhostDir = FPaths::ProjectSavedDir() / TEXT("Ghosts");
+	GhostFilename = GhostDir / FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s_%s.vghost"), 
+		*GetWorld()->GetMapName(), *RacerName, *FDateTime::Now().ToString()));
+
+	IFileManager::Get().MakeDirectory(*GhostDir, true);
+	GhostArchive.Reset(IFileManager::Get().CreateFileWriter(*GhostFilename));
+	if (!GhostArchive.IsValid())
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("Failed to open ghost file %s"), *GhostFilename);
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	GhostWriter.Reset(new FVehicleGhostWriter(GhostArchive.Get(), SampleRate));
+	SampleAccumulator = 1.0f / SampleRate;
+	SetComponentTickEnabled(true);
+}
+
+void UVehicleGhostRecorderComponent::StopRecording()
+{
+	if (IsRecording())
+	{
+		GhostWriter->Flush();
+		UE_LOG(LogVehicle, Log, TEXT("Ghost %s: %d samples, %lld bytes"), *GhostFilename, GhostWriter->GetNumSamples(), GhostWriter->GetTotalBytes());
+		GhostWriter.Reset();
+		GhostArchive.Reset();
+		SetComponentTickEnabled(false);
+	}
+}
+
+bool UVehicleGhostRecorderComponent::IsRecording() const
+{
+	return GhostWriter.IsValid();
+}
+
+const FString& UVehicleGhostRecorderComponent::GetGhostFilename() const
+{
+	return GhostFilename;
+}
+
+void UVehicleGhostRecorderComponent::CaptureSample(FVehicleGhostSample& OutSample) const
+{
+	AWheeledVehicle* Vehicle = Cast<AWheeledVehicle>(GetOwner());
+	if (Vehicle == nullptr)
+	{
+		return;
+	}
+
+	OutSample.Location = Vehicle->GetActorLocation();
+	OutSample.Rotation = Vehicle->GetActorRotation();
+
+	UWheeledVehicleMovementComponent* VehicleMovement = Vehicle->GetVehicleMovementComponent();
+	if (VehicleMovement == nullptr)
+	{
+		return;
+	}
+
+	OutSample.EngineRPM = VehicleMovement->GetEngineRotationSpeed();
+	for (int32 i = 0; i < VehicleMovement->Wheels.Num() && i < ARRAY_COUNT(OutSample.SuspensionOffset); i++)
+	{
+		OutSample.SuspensionOffset[i] = VehicleMovement->Wheels[i]->GetSuspensionOffset();
+	}
+	if (VehicleMovement->Wheels.Num() > 0)
+	{
+		OutSample.SteerAngle = VehicleMovement->Wheels[0]->GetSteerAngle();
+	}
+
+	// smoothed inputs are protected in the movement component, read them through reflection
+	static const UFloatProperty* ThrottleProperty = FindField<UFloatProperty>(UWheeledVehicleMovementComponent::StaticClass(), TEXT("ThrottleInput"));
+	static const UFloatProperty* SteeringProperty = FindField<UFloatProperty>(UWheeledVehicleMovementComponent::StaticClass(), TEXT("SteeringInput"));
+	static const UFloatProperty* HandbrakeProperty = FindField<UFloatProperty>(UWheeledVehicleMovementComponent::StaticClass(), TEXT("HandbrakeInput"));
+	OutSample.ThrottleInput = ThrottleProperty ? ThrottleProperty->GetPropertyValue_InContainer(VehicleMovement) : 0.0f;
+	OutSample.SteeringInput = SteeringProperty ? SteeringProperty->GetPropertyValue_InContainer(VehicleMovement) : 0.0f;
+	OutSample.bHandbrake = HandbrakeProperty ? HandbrakeProperty->GetPropertyValue_InContainer(VehicleMovement) > 0.5f : false;
+}
@@ -0,0 +1,341 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Ghost/VehicleGhostStream.h"
+
+namespace VehicleGhost
+{
+	/** file signature, "VGHT" */
+	const uint32 Magic = 0x54484756;
+
+	/** format version */
+	const uint16 Version = 1;
+
+	/** size of file header: magic, version, sample rate */
+	const int32 HeaderSize = 8;
+
+	/** sample flags */
+	const uint8 Flag_Keyframe = 0x01;
+	const uint8 Flag_Handbrake = 0x02;
+
+	/** worst case size of encoded sample: flags + 5 bytes per channel */
+	const int32 MaxSampleSize = 1 + EVehicleGhostChannel::Num * 5;
+
+	/** quantization steps */
+	const float LocationScale = 1.0f;		// 1 cm
+	const float SteerAngleScale = 4.0f;		// 0.25 deg
+	const float SuspensionScale = 4.0f;		// 0.25 cm
+	const float EngineRPMScale = 0.125f;	// 8 RPM
+	const float InputScale = 127.0f;
+
+	/** rotation channels are stored as 16 bit angles and wrap around */
+	FORCEINLINE bool IsAngleChannel(int32 Channel)
+	{
+		return Channel >= EVehicleGhostChannel::Pitch && Channel <= EVehicleGhostChannel::Roll;
+	}
+
+	void Quantize(const FVehicleGhostSample& Sample, int32* OutChannels)
+	{
+		OutChannels[EVehicleGhostChannel::LocationX] = FMath::RoundToInt(Sample.Location.X * LocationScale);
+		OutChannels[EVehicleGhostChannel::LocationY] = FMath::RoundToInt(Sample.Location.Y * LocationScale);
+		OutChannels[EVehicleGhostChannel::LocationZ] = FMath::RoundToInt(Sample.Location.Z * LocationScale);
+		OutChannels[EVehicleGhostChannel::Pitch] = FRotator::CompressAxisToShort(Sample.Rotation.Pitch);
+		OutChannels[EVehicleGhostChannel::Yaw] = FRotator::CompressAxisToShort(Sample.Rotation.Yaw);
+		OutChannels[EVehicleGhostChannel::Roll] = FRotator::CompressAxisToShort(Sample.Rotation.Roll);
+		OutChannels[EVehicleGhostChannel::SteerAngle] = FMath::RoundToInt(Sample.SteerAngle * SteerAngleScale);
+		for (int32 i = 0; i < 4; i++)
+		{
+			OutChannels[EVehicleGhostChannel::Suspension0 + i] = FMath::RoundToInt(Sample.SuspensionOffset[i] * SuspensionScale);
+		}
+		OutChannels[EVehicleGhostChannel::EngineRPM] = FMath::RoundToInt(Sample.EngineRPM * EngineRPMScale);
+		OutChannels[EVehicleGhostChannel::ThrottleInput] = FMath::RoundToInt(FMath::Clamp(Sample.ThrottleInput, -1.0f, 1.0f) * InputScale);
+		OutChannels[EVehicleGhostChannel::SteeringInput] = FMath::RoundToInt(FMath::Clamp(Sample.SteeringInput, -1.0f, 1.0f) * InputScale);
+	}
+
+	void Dequantize(const int32* Channels, FVehicleGhostSample& OutSample)
+	{
+		OutSample.Location.X = Channels[EVehicleGhostChannel::LocationX] / LocationScale;
+		OutSample.Location.Y = Channels[EVehicleGhostChannel::LocationY] / LocationScale;
+		OutSample.Location.Z = Channels[EVehicleGhostChannel::LocationZ] / LocationScale;
+		OutSample.Rotation.Pitch = FRotator::DecompressAxisFromShort(Channels[EVehicleGhostChannel::Pitch]);
+		OutSample.Rotation.Yaw = FRotator::DecompressAxisFromShort(Channels[EVehicleGhostChannel::Yaw]);
+		OutSample.Rotation.Roll = FRotator::DecompressAxisFromShort(Channels[EVehicleGhostChannel::Roll]);
+		OutSample.SteerAngle = Channels[EVehicleGhostChannel::SteerAngle] / SteerAngleScale;
+		for (int32 i = 0; i < 4; i++)
+		{
+			OutSample.SuspensionOffset[i] = Channels[EVehicleGhostChannel::Suspension0 + i] / SuspensionScale;
+		}
+		OutSample.EngineRPM = Channels[EVehicleGhostChannel::EngineRPM] / EngineRPMScale;
+		OutSample.ThrottleInput = Channels[EVehicleGhostChannel::ThrottleInput] / InputScale;
+		OutSample.SteeringInput = Channels[EVehicleGhostChannel::SteeringInput] / InputScale;
+	}
+}
+
+FVehicleGhostSample::FVehicleGhostSample()
+	: Location(FVector::ZeroVector)
+	, Rotation(FRotator::ZeroRotator)
+	, SteerAngle(0.0f)
+	, EngineRPM(0.0f)
+	, ThrottleInput(0.0f)
+	, SteeringInput(0.0f)
+	, bHandbrake(false)
+{
+	FMemory::Memzero(SuspensionOffset);
+}
+
+FVehicleGhostSample FVehicleGhostSample::MakeSynthetic(float Time)
+{
+	// ~1km circle at ~100 km/h
+	const float Angle = Time * 0.17f;
+	FVehicleGhostSample Sample;
+	Sample.Location = FVector(FMath::Cos(Angle) * 16000.0f, FMath::Sin(Angle) * 16000.0f, 50.0f + FMath::Sin(Time * 3.0f) * 30.0f);
+	Sample.Rotation = FRotator(FMath::Sin(Time * 3.0f) * 4.0f, FMath::RadiansToDegrees(Angle) + 90.0f, FMath::Sin(Time * 1.3f) * 2.0f);
+	Sample.SteerAngle = 8.0f + FMath::Sin(Time * 0.7f) * 3.0f;
+	for (int32 Wheel = 0; Wheel < 4; Wheel++)
+	{
+		Sample.SuspensionOffset[Wheel] = FMath::Sin(Time * 5.0f + Wheel) * 6.0f;
+	}
+	Sample.EngineRPM = 4500.0f + FMath::Sin(Time * 0.5f) * 1500.0f;
+	Sample.ThrottleInput = 1.0f;
+	Sample.SteeringInput = 0.3f + FMath::Sin(Time * 0.7f) * 0.1f;
+	Sample.bHandbrake = FMath::Fmod(Time, 20.0f) < 0.5f;
+	return Sample;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FVehicleGhostWriter
+
+FVehicleGhostWriter::FVehicleGhostWriter(FArchive* InArchive, int32 InSampleRate, int32 BufferSize)
+	: Archive(InArchive)
+	, SampleRate(FMath::Clamp(InSampleRate, 1, (int32)MAX_uint16))
+	, NumSamples(0)
+	, TotalBytes(0)
+{
+	Buffer.Reserve(FMath::Max(BufferSize, VehicleGhost::HeaderSize + VehicleGhost::MaxSampleSize));
+	FMemory::Memzero(LastChannels);
+
+	const uint32 Magic = VehicleGhost::Magic;
+	const uint16 Version = VehicleGhost::Version;
+	const uint16 Rate = (uint16)SampleRate;
+	Buffer.Add(Magic & 0xff);
+	Buffer.Add((Magic >> 8) & 0xff);
+	Buffer.Add((Magic >> 16) & 0xff);
+	Buffer.Add((Magic >> 24) & 0xff);
+	Buffer.Add(Version & 0xff);
+	Buffer.Add((Version >> 8) & 0xff);
+	Buffer.Add(Rate & 0xff);
+	Buffer.Add((Rate >> 8) & 0xff);
+}
+
+FVehicleGhostWriter::~FVehicleGhostWriter()
+{
+	Flush();
+}
+
+void FVehicleGhostWriter::AddSample(const FVehicleGhostSample& Sample)
+{
+	if (Buffer.Num() + VehicleGhost::MaxSampleSize > Buffer.Max())
+	{
+		Flush();
+	}
+
+	int32 Channels[EVehicleGhostChannel::Num];
+	VehicleGhost::Quantize(Sample, Channels);
+
+	const bool bKeyframe = (NumSamples % SampleRate) == 0;
+	if (bKeyframe)
+	{
+		FMemory::Memzero(LastChannels);
+	}
+
+	Buffer.Add((bKeyframe ? VehicleGhost::Flag_Keyframe : 0) | (Sample.bHandbrake ? VehicleGhost::Flag_Handbrake : 0));
+	for (int32 i = 0; i < EVehicleGhostChannel::Num; i++)
+	{
+		const int32 Delta = Channels[i] - LastChannels[i];
+		WriteVarInt(VehicleGhost::IsAngleChannel(i) ? (int16)Delta : Delta);
+		LastChannels[i] = Channels[i];
+	}
+
+	NumSamples++;
+}
+
+void FVehicleGhostWriter::Flush()
+{
+	if (Buffer.Num() > 0)
+	{
+		if (Archive)
+		{
+			Archive->Serialize(Buffer.GetData(), Buffer.Num());
+		}
+		TotalBytes += Buffer.Num();
+		Buffer.Reset();
+	}
+}
+
+int32 FVehicleGhostWriter::GetNumSamples() const
+{
+	return NumSamples;
+}
+
+int64 FVehicleGhostWriter::GetTotalBytes() const
+{
+	return TotalBytes + Buffer.Num();
+}
+
+void FVehicleGhostWriter::WriteVarInt(int32 Value)
+{
+	uint32 ZigZag = ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	while (ZigZag >= 0x80)
+	{
+		Buffer.Add((uint8)(ZigZag | 0x80));
+		ZigZag >>= 7;
+	}
+	Buffer.Add((uint8)ZigZag);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FVehicleGhostReader
+
+FVehicleGhostReader::FVehicleGhostReader(const uint8* InData, int32 InSize)
+	: Data(InData)
+	, Size(InSize)
+	, SampleRate(0)
+{
+	if (Data && Size >= VehicleGhost::HeaderSize)
+	{
+		const uint32 Magic = Data[0] | (Data[1] << 8) | (Data[2] << 16) | ((uint32)Data[3] << 24);
+		const uint16 Version = Data[4] | (Data[5] << 8);
+		if (Magic == VehicleGhost::Magic && Version == VehicleGhost::Version)
+		{
+			SampleRate = Data[6] | (Data[7] << 8);
+		}
+	}
+
+	Rewind();
+}
+
+bool FVehicleGhostReader::IsValid() const
+{
+	return SampleRate > 0;
+}
+
+int32 FVehicleGhostReader::GetSampleRate() const
+{
+	return SampleRate;
+}
+
+int32 FVehicleGhostReader::GetSampleIndex() const
+{
+	return SampleIndex;
+}
+
+void FVehicleGhostReader::Rewind()
+{
+	Offset = VehicleGhost::HeaderSize;
+	SampleIndex = 0;
+	FMemory::Memzero(LastChannels);
+}
+
+bool FVehicleGhostReader::ReadSample(FVehicleGhostSample& OutSample)
+{
+	if (!IsValid() || Offset >= Size)
+	{
+		return false;
+	}
+
+	const uint8 Flags = Data[Offset++];
+	if (Flags & VehicleGhost::Flag_Keyframe)
+	{
+		FMemory::Memzero(LastChannels);
+	}
+
+	for (int32 i = 0; i < EVehicleGhostChannel::Num; i++)
+	{
+		int32 Delta = 0;
+		if (!ReadVarInt(Delta))
+		{
+			return false;
+		}
+		LastChannels[i] = VehicleGhost::IsAngleChannel(i) ? ((LastChannels[i] + Delta) & 0xffff) : LastChannels[i] + Delta;
+	}
+
+	VehicleGhost::Dequantize(LastChannels, OutSample);
+	OutSample.bHandbrake = (Flags & VehicleGhost::Flag_Handbrake) != 0;
+	SampleIndex++;
+	return true;
+}
+
+bool FVehicleGhostReader::ReadVarInt(int32& OutValue)
+{
+	uint32 ZigZag = 0;
+	for (int32 Shift = 0; Shift < 35; Shift += 7)
+	{
+		if (Offset >= Size)
+		{
+			return false;
+		}
+
+		const uint8 Byte = Data[Offset++];
+		ZigZag |= (uint32)(Byte & 0x7f) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			OutValue = (int32)(ZigZag >> 1) ^ -(int32)(ZigZag & 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+static void GhostEncodeBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumSamples = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200000, 1);
+	const int32 SampleRate = 20;
+
+	TArray<FVehicleGhostSample> Samples;
+	Samples.SetNum(NumSamples);
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		Samples[i] = FVehicleGhostSample::MakeSynthetic((float)i / SampleRate);
+	}
+
+	TArray<uint8> Encoded;
+	Encoded.Reserve(NumSamples * VehicleGhost::MaxSampleSize + VehicleGhost::HeaderSize);
+	FMemoryWriter MemoryWriter(Encoded);
+
+	const double EncodeStart = FPlatformTime::Seconds();
+	{
+		FVehicleGhostWriter Writer(&MemoryWriter, SampleRate);
+		for (const FVehicleGhostSample& Sample : Samples)
+		{
+			Writer.AddSample(Sample);
+		}
+	}
+	const double EncodeTime = FPlatformTime::Seconds() - EncodeStart;
+
+	float MaxLocationError = 0.0f;
+	const double DecodeStart = FPlatformTime::Seconds();
+	FVehicleGhostReader Reader(Encoded.GetData(), Encoded.Num());
+	FVehicleGhostSample Decoded;
+	while (Reader.ReadSample(Decoded))
+	{
+		MaxLocationError = FMath::Max(MaxLocationError, (Decoded.Location - Samples[Reader.GetSampleIndex() - 1].Location).GetAbsMax());
+	}
+	const double DecodeTime = FPlatformTime::Seconds() - DecodeStart;
+
+	const float BytesPerSample = (float)Encoded.Num() / NumSamples;
+	UE_LOG(LogVehicle, Display, TEXT("Ghost encode: %d samples in %.2f ms (%.2f M samples/s, %.1f MB/s)"),
+		NumSamples, EncodeTime * 1000.0, NumSamples / FMath::Max(EncodeTime, 1e-9) / 1e6, Encoded.Num() / FMath::Max(EncodeTime, 1e-9) / (1024.0 * 1024.0));
+	UE_LOG(LogVehicle, Display, TEXT("Ghost decode: %d samples in %.2f ms, max location error %.2f cm"),
+		Reader.GetSampleIndex(), DecodeTime * 1000.0, MaxLocationError);
+	UE_LOG(LogVehicle, Display, TEXT("Ghost size: %.2f bytes/sample, %.0f bytes/s per vehicle at %d Hz"),
+		BytesPerSample, BytesPerSample * SampleRate, SampleRate);
+}
+
+static FAutoConsoleCommand GhostEncodeBenchmarkCmd(
+	TEXT("vehicle.GhostBenchmark"),
+	TEXT("Measures ghost stream encode/decode throughput. Usage: vehicle.GhostBenchmark [NumSamples]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GhostEncodeBenchmark));
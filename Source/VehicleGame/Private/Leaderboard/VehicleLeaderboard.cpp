@@ -0,0 +1,356 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Leaderboard/VehicleLeaderboard.h"
+#include "Async/Async.h"
+
+DECLARE_CYCLE_STAT(TEXT("Leaderboard load"), STAT_LeaderboardLoad, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("Leaderboard write"), STAT_LeaderboardWrite, STATGROUP_VehicleGame);
+
+namespace VehicleLeaderboard
+{
+	/** file signature, "VLBD" */
+	const uint32 Magic = 0x44424C56;
+
+	/** format version */
+	const uint32 Version = 1;
+
+	/** size of file header: magic, version */
+	const int64 HeaderSize = 8;
+
+	/** size of single record: time, timestamp, name */
+	const int64 RecordSize = 4 + 8 + FVehicleLeaderboardEntry::MaxNameLen;
+
+	/** log is merged into index when it holds this many records */
+	const int64 CompactRecords = 64;
+
+	void WriteHeader(FArchive& Ar)
+	{
+		uint32 FileMagic = Magic;
+		uint32 FileVersion = Version;
+		Ar << FileMagic << FileVersion;
+	}
+}
+
+FVehicleLeaderboardEntry::FVehicleLeaderboardEntry()
+	: TimeMs(0)
+	, Timestamp(0)
+{
+	FMemory::Memzero(Name);
+}
+
+FVehicleLeaderboardEntry::FVehicleLeaderboardEntry(const FString& InName, float Time)
+	: TimeMs((uint32)FMath::Clamp(FMath::RoundToInt(Time * 1000.0f), 0, MAX_int32))
+	, Timestamp(FDateTime::UtcNow().GetTicks())
+{
+	FMemory::Memzero(Name);
+	FCStringAnsi::Strncpy(Name, TCHAR_TO_ANSI(*InName), MaxNameLen);
+}
+
+float FVehicleLeaderboardEntry::GetTime() const
+{
+	return TimeMs / 1000.0f;
+}
+
+FString FVehicleLeaderboardEntry::GetName() const
+{
+	ANSICHAR Terminated[MaxNameLen + 1];
+	FMemory::Memcpy(Terminated, Name, MaxNameLen);
+	Terminated[MaxNameLen] = 0;
+	return ANSI_TO_TCHAR(Terminated);
+}
+
+FArchive& operator<<(FArchive& Ar, FVehicleLeaderboardEntry& Entry)
+{
+	Ar << Entry.TimeMs << Entry.Timestamp;
+	Ar.Serialize(Entry.Name, FVehicleLeaderboardEntry::MaxNameLen);
+	return Ar;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FVehicleLeaderboardStore
+
+FVehicleLeaderboardStore& FVehicleLeaderboardStore::Get()
+{
+	static FVehicleLeaderboardStore Store;
+	return Store;
+}
+
+FVehicleLeaderboardStore::FVehicleLeaderboardStore()
+{
+	FCoreDelegates::OnPreExit.AddRaw(this, &FVehicleLeaderboardStore::Flush);
+}
+
+FString FVehicleLeaderboardStore::GetBoardName(const FString& MapName, const FString& ModeName, EVehicleLeaderboard::Type Kind)
+{
+	return FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s_%s"), *MapName, *ModeName, Kind == EVehicleLeaderboard::Lap ? TEXT("Lap") : TEXT("Race")));
+}
+
+FString FVehicleLeaderboardStore::GetBoardFilename(const FString& BoardName, const TCHAR* Extension)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Leaderboards") / BoardName + Extension;
+}
+
+void FVehicleLeaderboardStore::SubmitTime(const FString& BoardName, const FString& RacerName, float Time)
+{
+	check(IsInGameThread());
+
+	FPendingWrite Write;
+	Write.BoardName = BoardName;
+	Write.Entry = FVehicleLeaderboardEntry(RacerName, Time);
+
+	// board is loaded before queueing, so a load never misses times still waiting in the queue
+	FindOrLoadBoard(BoardName).Add(Write.Entry);
+	WriteQueue.Enqueue(Write);
+
+	// tasks drain the queue one at a time, later ones may find it empty
+	Async<void>(EAsyncExecution::ThreadPool, [this]()
+	{
+		FScopeLock Lock(&WriteLock);
+		ProcessWriteQueue();
+	});
+}
+
+void FVehicleLeaderboardStore::Flush()
+{
+	FScopeLock Lock(&WriteLock);
+	ProcessWriteQueue();
+}
+
+void FVehicleLeaderboardStore::ProcessWriteQueue()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LeaderboardWrite);
+
+	TSet<FString> WrittenBoards;
+	FPendingWrite Write;
+	while (WriteQueue.Dequeue(Write))
+	{
+		const FString LogFilename = GetBoardFilename(Write.BoardName, TEXT(".log"));
+		const bool bNewLog = IFileManager::Get().FileSize(*LogFilename) < VehicleLeaderboard::HeaderSize;
+		TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*LogFilename, bNewLog ? 0 : FILEWRITE_Append));
+		if (!Ar)
+		{
+			UE_LOG(LogVehicle, Warning, TEXT("Failed to write leaderboard log %s"), *LogFilename);
+			continue;
+		}
+
+		if (bNewLog)
+		{
+			VehicleLeaderboard::WriteHeader(*Ar);
+		}
+		*Ar << Write.Entry;
+		Ar.Reset();
+
+		WrittenBoards.Add(Write.BoardName);
+	}
+
+	for (const FString& BoardName : WrittenBoards)
+	{
+		const int64 LogSize = IFileManager::Get().FileSize(*GetBoardFilename(BoardName, TEXT(".log")));
+		if ((LogSize - VehicleLeaderboard::HeaderSize) / VehicleLeaderboard::RecordSize >= VehicleLeaderboard::CompactRecords)
+		{
+			CompactBoard(BoardName);
+		}
+	}
+}
+
+void FVehicleLeaderboardStore::CompactBoard(const FString& BoardName)
+{
+	const FString IndexFilename = GetBoardFilename(BoardName, TEXT(".idx"));
+	const FString LogFilename = GetBoardFilename(BoardName, TEXT(".log"));
+
+	TArray<FVehicleLeaderboardEntry> Entries;
+	TArray<FVehicleLeaderboardEntry> LogEntries;
+	ReadRecords(IndexFilename, Entries);
+	if (!ReadRecords(LogFilename, LogEntries))
+	{
+		return;
+	}
+	Entries.Append(LogEntries);
+	Entries.Sort();
+
+	// write next to index and swap, so a crash leaves either the old or the new index
+	const FString TempFilename = IndexFilename + TEXT(".tmp");
+	{
+		TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*TempFilename));
+		if (!Ar)
+		{
+			UE_LOG(LogVehicle, Warning, TEXT("Failed to write leaderboard index %s"), *TempFilename);
+			return;
+		}
+
+		VehicleLeaderboard::WriteHeader(*Ar);
+		for (FVehicleLeaderboardEntry& Entry : Entries)
+		{
+			*Ar << Entry;
+		}
+	}
+
+	if (IFileManager::Get().Move(*IndexFilename, *TempFilename))
+	{
+		IFileManager::Get().Delete(*LogFilename);
+	}
+}
+
+bool FVehicleLeaderboardStore::ReadRecords(const FString& Filename, TArray<FVehicleLeaderboardEntry>& OutEntries)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent) || Data.Num() < VehicleLeaderboard::HeaderSize)
+	{
+		return false;
+	}
+
+	FMemoryReader Ar(Data);
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	Ar << FileMagic << FileVersion;
+	if (FileMagic != VehicleLeaderboard::Magic || FileVersion != VehicleLeaderboard::Version)
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("Ignoring invalid leaderboard file %s"), *Filename);
+		return false;
+	}
+
+	// partial record at the end is a write cut short, drop it
+	const int32 NumRecords = (Data.Num() - VehicleLeaderboard::HeaderSize) / VehicleLeaderboard::RecordSize;
+	const int32 FirstNew = OutEntries.Num();
+	OutEntries.AddDefaulted(NumRecords);
+	for (int32 i = 0; i < NumRecords; i++)
+	{
+		Ar << OutEntries[FirstNew + i];
+	}
+
+	return true;
+}
+
+FVehicleLeaderboardStore::FBoard& FVehicleLeaderboardStore::FindOrLoadBoard(const FString& BoardName)
+{
+	check(IsInGameThread());
+
+	FBoard* Board = Boards.Find(BoardName);
+	if (Board)
+	{
+		return *Board;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_LeaderboardLoad);
+
+	Board = &Boards.Add(BoardName);
+	TArray<FVehicleLeaderboardEntry> LogEntries;
+	{
+		FScopeLock Lock(&WriteLock);
+		ReadRecords(GetBoardFilename(BoardName, TEXT(".idx")), Board->Entries);
+		ReadRecords(GetBoardFilename(BoardName, TEXT(".log")), LogEntries);
+	}
+
+	// index is already sorted, so first time of each racer is their best and only the short log needs inserting
+	for (const FVehicleLeaderboardEntry& Entry : Board->Entries)
+	{
+		const FString RacerName = Entry.GetName();
+		if (!Board->PersonalBests.Contains(RacerName))
+		{
+			Board->PersonalBests.Add(RacerName, Entry);
+		}
+	}
+	for (const FVehicleLeaderboardEntry& Entry : LogEntries)
+	{
+		Board->Add(Entry);
+	}
+
+	return *Board;
+}
+
+void FVehicleLeaderboardStore::FBoard::Add(const FVehicleLeaderboardEntry& Entry)
+{
+	Entries.Insert(Entry, FindPosition(Entries, Entry.TimeMs, true));
+
+	FVehicleLeaderboardEntry* Best = PersonalBests.Find(Entry.GetName());
+	if (!Best)
+	{
+		PersonalBests.Add(Entry.GetName(), Entry);
+	}
+	else if (Entry < *Best)
+	{
+		*Best = Entry;
+	}
+}
+
+int32 FVehicleLeaderboardStore::FindPosition(const TArray<FVehicleLeaderboardEntry>& Entries, uint32 TimeMs, bool bIncludeEqual)
+{
+	int32 First = 0;
+	int32 Count = Entries.Num();
+	while (Count > 0)
+	{
+		const int32 Step = Count / 2;
+		const uint32 MidTimeMs = Entries[First + Step].TimeMs;
+		if (MidTimeMs < TimeMs || (bIncludeEqual && MidTimeMs == TimeMs))
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+	return First;
+}
+
+void FVehicleLeaderboardStore::GetTopEntries(const FString& BoardName, int32 Count, TArray<FVehicleLeaderboardEntry>& OutEntries)
+{
+	const FBoard& Board = FindOrLoadBoard(BoardName);
+	OutEntries.Append(Board.Entries.GetData(), FMath::Clamp(Count, 0, Board.Entries.Num()));
+}
+
+bool FVehicleLeaderboardStore::GetPersonalBest(const FString& BoardName, const FString& RacerName, FVehicleLeaderboardEntry& OutEntry)
+{
+	// names are stored truncated
+	const FVehicleLeaderboardEntry* Best = FindOrLoadBoard(BoardName).PersonalBests.Find(FVehicleLeaderboardEntry(RacerName, 0.0f).GetName());
+	if (Best)
+	{
+		OutEntry = *Best;
+	}
+	return Best != nullptr;
+}
+
+int32 FVehicleLeaderboardStore::GetRank(const FString& BoardName, float Time)
+{
+	return FindPosition(FindOrLoadBoard(BoardName).Entries, FVehicleLeaderboardEntry(FString(), Time).TimeMs, false) + 1;
+}
+
+int32 FVehicleLeaderboardStore::GetNumEntries(const FString& BoardName)
+{
+	return FindOrLoadBoard(BoardName).Entries.Num();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console
+
+static void LeaderboardTop(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr || World->GetGameState() == nullptr || World->GetGameState()->GameModeClass == nullptr)
+	{
+		return;
+	}
+
+	const int32 Count = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10, 1);
+	const FString MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+	const FString ModeName = World->GetGameState()->GameModeClass->GetName();
+
+	for (int32 Kind = EVehicleLeaderboard::Lap; Kind <= EVehicleLeaderboard::Race; Kind++)
+	{
+		const FString BoardName = FVehicleLeaderboardStore::GetBoardName(MapName, ModeName, (EVehicleLeaderboard::Type)Kind);
+		TArray<FVehicleLeaderboardEntry> Entries;
+		FVehicleLeaderboardStore::Get().GetTopEntries(BoardName, Count, Entries);
+
+		UE_LOG(LogVehicle, Display, TEXT("%s: %d times"), *BoardName, FVehicleLeaderboardStore::Get().GetNumEntries(BoardName));
+		for (int32 i = 0; i < Entries.Num(); i++)
+		{
+			UE_LOG(LogVehicle, Display, TEXT("  %2d. %-16s %.3f"), i + 1, *Entries[i].GetName(), Entries[i].GetTime());
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LeaderboardTopCmd(
+	TEXT("vehicle.LeaderboardTop"),
+	TEXT("Lists fastest lap and race times of current map. Usage: vehicle.LeaderboardTop [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LeaderboardTop));
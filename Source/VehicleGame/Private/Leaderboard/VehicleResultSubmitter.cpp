@@ -0,0 +1,490 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Leaderboard/VehicleResultSubmitter.h"
+#include "Async/Async.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+DECLARE_CYCLE_STAT(TEXT("Result submitter tick"), STAT_ResultSubmitterTick, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Results sent"), STAT_NumResultsSent, STATGROUP_VehicleGame);
+
+static TAutoConsoleVariable<FString> CVarResultServiceURL(
+	TEXT("vehicle.ResultServiceURL"),
+	TEXT(""),
+	TEXT("Leaderboard service race results are posted to, empty disables submitting, mock:// uses in-process mock service"));
+
+static TAutoConsoleVariable<int32> CVarResultBatchSize(
+	TEXT("vehicle.ResultBatchSize"),
+	100,
+	TEXT("Maximum number of race results posted in one request"));
+
+static TAutoConsoleVariable<float> CVarResultBatchDelay(
+	TEXT("vehicle.ResultBatchDelay"),
+	2.0f,
+	TEXT("Seconds a race result waits for more to fill its batch"));
+
+static TAutoConsoleVariable<float> CVarMockResultServiceLatency(
+	TEXT("vehicle.MockResultServiceLatency"),
+	0.05f,
+	TEXT("Seconds the mock leaderboard service takes to answer"));
+
+static TAutoConsoleVariable<float> CVarMockResultServiceFailRate(
+	TEXT("vehicle.MockResultServiceFailRate"),
+	0.0f,
+	TEXT("Fraction of requests the mock leaderboard service fails, 0..1"));
+
+namespace VehicleResultSubmitter
+{
+	/** URL of in-process mock service */
+	const TCHAR* MockURL = TEXT("mock://");
+
+	/** first retry delay, doubled with every failure */
+	const double RetryDelay = 1.0;
+
+	/** longest retry delay */
+	const double MaxRetryDelay = 60.0;
+
+	/** seconds between ticks */
+	const float TickInterval = 0.1f;
+
+	/** number of results accepted by mock service */
+	FThreadSafeCounter MockNumReceived;
+
+	void WriteResults(const TArray<FVehicleRaceResult>& Results, int32 NumResults, FString& OutString)
+	{
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutString);
+		Writer->WriteObjectStart();
+		Writer->WriteArrayStart(TEXT("results"));
+		for (int32 i = 0; i < NumResults; i++)
+		{
+			Results[i].WriteJson(*Writer);
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+	}
+
+	bool ReadResults(const FString& String, TArray<FVehicleRaceResult>& OutResults)
+	{
+		TSharedPtr<FJsonObject> Root;
+		const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(String), Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("results"), Values))
+		{
+			return false;
+		}
+
+		for (const TSharedPtr<FJsonValue>& Value : *Values)
+		{
+			const TSharedPtr<FJsonObject>* Object = nullptr;
+			FVehicleRaceResult Result;
+			if (Value->TryGetObject(Object) && Result.ReadJson(**Object))
+			{
+				OutResults.Add(Result);
+			}
+		}
+		return true;
+	}
+
+	/** write results to spool file, deleting it when there are none */
+	void SaveSpool(const TArray<FVehicleRaceResult>& Results, const FString& Filename)
+	{
+		if (Results.Num() == 0)
+		{
+			IFileManager::Get().Delete(*Filename, false, false, true);
+			return;
+		}
+
+		FString Contents;
+		WriteResults(Results, Results.Num(), Contents);
+		if (!FFileHelper::SaveStringToFile(Contents, *Filename))
+		{
+			UE_LOG(LogVehicle, Warning, TEXT("Failed to write race result spool %s"), *Filename);
+		}
+	}
+
+	/** stands in for leaderboard service: parses batch on worker thread, answers after latency, fails at random */
+	void MockPost(const FString& Payload, int32 NumResults, TFunction<void(bool)> OnComplete)
+	{
+		const float Latency = CVarMockResultServiceLatency.GetValueOnGameThread();
+		const float FailRate = CVarMockResultServiceFailRate.GetValueOnGameThread();
+		const int32 Seed = FMath::Rand();
+		Async<void>(EAsyncExecution::ThreadPool, [Payload, NumResults, OnComplete, Latency, FailRate, Seed]()
+		{
+			FPlatformProcess::Sleep(Latency);
+
+			TArray<FVehicleRaceResult> Received;
+			const bool bSuccess = ReadResults(Payload, Received) && Received.Num() == NumResults && FRandomStream(Seed).FRand() >= FailRate;
+			if (bSuccess)
+			{
+				MockNumReceived.Add(Received.Num());
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [OnComplete, bSuccess]()
+			{
+				OnComplete(bSuccess);
+			});
+		});
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FVehicleRaceResult
+
+FVehicleRaceResult::FVehicleRaceResult()
+	: Id(FGuid::NewGuid())
+	, Place(0)
+	, FinishTime(0.0f)
+	, Timestamp(FDateTime::UtcNow())
+{
+}
+
+void FVehicleRaceResult::WriteJson(TJsonWriter<>& Writer) const
+{
+	Writer.WriteObjectStart();
+	Writer.WriteValue(TEXT("id"), Id.ToString());
+	Writer.WriteValue(TEXT("map"), MapName);
+	Writer.WriteValue(TEXT("mode"), ModeName);
+	Writer.WriteValue(TEXT("player"), PlayerName);
+	Writer.WriteValue(TEXT("place"), Place);
+	Writer.WriteValue(TEXT("time"), FinishTime);
+	Writer.WriteValue(TEXT("timestamp"), Timestamp.ToIso8601());
+	Writer.WriteObjectEnd();
+}
+
+bool FVehicleRaceResult::ReadJson(const FJsonObject& Object)
+{
+	FString IdString, TimestampString;
+	double Time = 0.0;
+	if (!Object.TryGetStringField(TEXT("id"), IdString) || !FGuid::Parse(IdString, Id) ||
+		!Object.TryGetStringField(TEXT("map"), MapName) ||
+		!Object.TryGetStringField(TEXT("mode"), ModeName) ||
+		!Object.TryGetStringField(TEXT("player"), PlayerName) ||
+		!Object.TryGetNumberField(TEXT("place"), Place) ||
+		!Object.TryGetNumberField(TEXT("time"), Time) ||
+		!Object.TryGetStringField(TEXT("timestamp"), TimestampString) || !FDateTime::ParseIso8601(*TimestampString, Timestamp))
+	{
+		return false;
+	}
+
+	FinishTime = (float)Time;
+	return true;
+}
+
+FVehicleRaceResult FVehicleRaceResult::MakeSynthetic(int32 Index)
+{
+	FVehicleRaceResult Result;
+	Result.MapName = TEXT("StressTest");
+	Result.ModeName = TEXT("VehicleGameMode");
+	Result.PlayerName = FString::Printf(TEXT("Racer %d"), Index);
+	Result.Place = Index % 8 + 1;
+	Result.FinishTime = 90.0f + (Index % 1000) * 0.037f;
+	return Result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FVehicleResultSubmitter
+
+TSharedPtr<FVehicleResultSubmitter> FVehicleResultSubmitter::Instance;
+
+FVehicleResultSubmitter::FVehicleResultSubmitter(const FString& InServiceURL, const FString& InSpoolFilename)
+	: ServiceURL(InServiceURL)
+	, SpoolFilename(InSpoolFilename)
+	, NumInFlight(0)
+	, NumFailures(0)
+	, NextSendTime(0.0)
+	, OldestQueuedTime(0.0)
+	, NumSent(0)
+	, NumBatches(0)
+	, bSpoolDirty(false)
+{
+	ReadSpool();
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVehicleResultSubmitter::Tick), VehicleResultSubmitter::TickInterval);
+	FCoreDelegates::OnPreExit.AddRaw(this, &FVehicleResultSubmitter::OnPreExit);
+}
+
+FVehicleResultSubmitter::~FVehicleResultSubmitter()
+{
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	FCoreDelegates::OnPreExit.RemoveAll(this);
+	if (SpoolWrite.IsValid())
+	{
+		SpoolWrite.Wait();
+	}
+	if (SpoolRead.IsValid())
+	{
+		SpoolRead.Wait();
+	}
+}
+
+void FVehicleResultSubmitter::Initialize()
+{
+	// created before the first race, so results left by a previous run are read and resent right away
+	if (!Instance.IsValid() && !IsRunningCommandlet())
+	{
+		Instance = MakeShareable(new FVehicleResultSubmitter(FString(), FPaths::ProjectSavedDir() / TEXT("Leaderboards") / TEXT("PendingResults.json")));
+	}
+}
+
+void FVehicleResultSubmitter::Shutdown()
+{
+	Instance.Reset();
+}
+
+FVehicleResultSubmitter* FVehicleResultSubmitter::Get()
+{
+	return Instance.Get();
+}
+
+FString FVehicleResultSubmitter::GetServiceURL() const
+{
+	return ServiceURL.IsEmpty() ? CVarResultServiceURL.GetValueOnGameThread() : ServiceURL;
+}
+
+void FVehicleResultSubmitter::Submit(const FVehicleRaceResult& Result)
+{
+	check(IsInGameThread());
+
+	if (GetServiceURL().IsEmpty())
+	{
+		return;
+	}
+
+	if (Pending.Num() == NumInFlight)
+	{
+		OldestQueuedTime = FPlatformTime::Seconds();
+	}
+	Pending.Add(Result);
+	bSpoolDirty = true;
+}
+
+int32 FVehicleResultSubmitter::GetNumPending() const
+{
+	return Pending.Num();
+}
+
+int32 FVehicleResultSubmitter::GetNumSent() const
+{
+	return NumSent;
+}
+
+int32 FVehicleResultSubmitter::GetNumBatches() const
+{
+	return NumBatches;
+}
+
+bool FVehicleResultSubmitter::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ResultSubmitterTick);
+
+	if (SpoolRead.IsValid() && SpoolRead.IsReady())
+	{
+		FinishReadSpool();
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const int32 NumQueued = Pending.Num() - NumInFlight;
+	if (NumInFlight == 0 && NumQueued > 0 && Now >= NextSendTime && !GetServiceURL().IsEmpty() &&
+		(NumQueued >= CVarResultBatchSize.GetValueOnGameThread() || Now - OldestQueuedTime >= CVarResultBatchDelay.GetValueOnGameThread()))
+	{
+		SendBatch();
+	}
+
+	// writing before the read finished would drop results of the previous run
+	if (bSpoolDirty && !SpoolRead.IsValid() && (!SpoolWrite.IsValid() || SpoolWrite.IsReady()))
+	{
+		WriteSpool();
+	}
+
+	return true;
+}
+
+void FVehicleResultSubmitter::SendBatch()
+{
+	NumInFlight = FMath::Min(Pending.Num(), FMath::Max(CVarResultBatchSize.GetValueOnGameThread(), 1));
+	NumBatches++;
+
+	FString Payload;
+	VehicleResultSubmitter::WriteResults(Pending, NumInFlight, Payload);
+
+	TWeakPtr<FVehicleResultSubmitter> WeakThis = AsShared();
+	PostBatch(Payload, NumInFlight, [WeakThis](bool bSuccess)
+	{
+		TSharedPtr<FVehicleResultSubmitter> Submitter = WeakThis.Pin();
+		if (Submitter.IsValid())
+		{
+			Submitter->OnBatchSent(bSuccess);
+		}
+	});
+}
+
+void FVehicleResultSubmitter::PostBatch(const FString& Payload, int32 NumResults, TFunction<void(bool)> OnComplete)
+{
+	const FString URL = GetServiceURL();
+	if (URL.StartsWith(VehicleResultSubmitter::MockURL))
+	{
+		VehicleResultSubmitter::MockPost(Payload, NumResults, OnComplete);
+		return;
+	}
+
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(URL);
+	Request->SetVerb(TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContentAsString(Payload);
+	Request->OnProcessRequestComplete().BindLambda([OnComplete](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		OnComplete(bConnected && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode()));
+	});
+	Request->ProcessRequest();
+}
+
+void FVehicleResultSubmitter::OnBatchSent(bool bSuccess)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (bSuccess)
+	{
+		Pending.RemoveAt(0, NumInFlight, false);
+		NumSent += NumInFlight;
+		INC_DWORD_STAT_BY(STAT_NumResultsSent, NumInFlight);
+		NumFailures = 0;
+		NextSendTime = 0.0;
+		bSpoolDirty = true;
+	}
+	else
+	{
+		// jitter keeps restarted servers from retrying in lockstep
+		NumFailures++;
+		const double Delay = FMath::Min(VehicleResultSubmitter::RetryDelay * FMath::Pow(2.0f, FMath::Min(NumFailures - 1, 16)), VehicleResultSubmitter::MaxRetryDelay);
+		NextSendTime = Now + Delay * FMath::FRandRange(0.5f, 1.0f);
+		UE_LOG(LogVehicle, Warning, TEXT("Posting %d race results failed, retry in %.1fs"), NumInFlight, NextSendTime - Now);
+	}
+
+	NumInFlight = 0;
+}
+
+void FVehicleResultSubmitter::WriteSpool()
+{
+	bSpoolDirty = false;
+	if (SpoolFilename.IsEmpty())
+	{
+		return;
+	}
+
+	// results are copied, serializing and writing happens off game thread
+	SpoolWrite = Async<void>(EAsyncExecution::ThreadPool, [Results = Pending, Filename = SpoolFilename]()
+	{
+		VehicleResultSubmitter::SaveSpool(Results, Filename);
+	});
+}
+
+void FVehicleResultSubmitter::ReadSpool()
+{
+	if (SpoolFilename.IsEmpty())
+	{
+		return;
+	}
+
+	SpoolRead = Async<TArray<FVehicleRaceResult>>(EAsyncExecution::ThreadPool, [Filename = SpoolFilename]()
+	{
+		TArray<FVehicleRaceResult> Results;
+		FString Contents;
+		if (FFileHelper::LoadFileToString(Contents, *Filename))
+		{
+			VehicleResultSubmitter::ReadResults(Contents, Results);
+		}
+		return Results;
+	});
+}
+
+void FVehicleResultSubmitter::FinishReadSpool()
+{
+	TArray<FVehicleRaceResult> Restored = SpoolRead.Get();
+	SpoolRead = TFuture<TArray<FVehicleRaceResult>>();
+	if (Restored.Num() == 0)
+	{
+		return;
+	}
+
+	// older than anything submitted since, but the batch in flight keeps its place at the front
+	if (Pending.Num() == NumInFlight)
+	{
+		OldestQueuedTime = FPlatformTime::Seconds();
+	}
+	Pending.Insert(Restored, NumInFlight);
+	bSpoolDirty = true;
+	UE_LOG(LogVehicle, Log, TEXT("%d unsent race results restored from %s"), Restored.Num(), *SpoolFilename);
+}
+
+void FVehicleResultSubmitter::OnPreExit()
+{
+	if (SpoolRead.IsValid())
+	{
+		SpoolRead.Wait();
+		FinishReadSpool();
+	}
+	if (SpoolWrite.IsValid())
+	{
+		SpoolWrite.Wait();
+	}
+
+	// ticker won't run again, so results queued since its last tick are written here
+	if (bSpoolDirty && !SpoolFilename.IsEmpty())
+	{
+		bSpoolDirty = false;
+		VehicleResultSubmitter::SaveSpool(Pending, SpoolFilename);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Stress test
+
+/** submitter used by running stress test */
+static TSharedPtr<FVehicleResultSubmitter> StressSubmitter;
+
+static void ResultSubmitStress(const TArray<FString>& Args)
+{
+	if (StressSubmitter.IsValid())
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("Result submit stress test is already running"));
+		return;
+	}
+
+	const int32 NumResults = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000, 1);
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 StartReceived = VehicleResultSubmitter::MockNumReceived.GetValue();
+
+	// spool is kept in memory so the test never touches the real one
+	StressSubmitter = MakeShareable(new FVehicleResultSubmitter(VehicleResultSubmitter::MockURL, FString()));
+	double SubmitTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumResults; i++)
+	{
+		StressSubmitter->Submit(FVehicleRaceResult::MakeSynthetic(i));
+	}
+	SubmitTime = FPlatformTime::Seconds() - SubmitTime;
+
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([NumResults, StartTime, StartReceived, SubmitTime](float)
+	{
+		if (StressSubmitter->GetNumPending() > 0)
+		{
+			return true;
+		}
+
+		const double TotalTime = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogVehicle, Display, TEXT("Result submit: %d results queued in %.3f ms (%.2f us each)"),
+			NumResults, SubmitTime * 1000.0, SubmitTime * 1e6 / NumResults);
+		UE_LOG(LogVehicle, Display, TEXT("Result submit: %d results in %d batches delivered in %.2f s (%.0f results/s), mock service received %d"),
+			StressSubmitter->GetNumSent(), StressSubmitter->GetNumBatches(), TotalTime, StressSubmitter->GetNumSent() / FMath::Max(TotalTime, 1e-9),
+			VehicleResultSubmitter::MockNumReceived.GetValue() - StartReceived);
+
+		StressSubmitter.Reset();
+		return false;
+	}), VehicleResultSubmitter::TickInterval);
+}
+
+static FAutoConsoleCommand ResultSubmitStressCmd(
+	TEXT("vehicle.ResultSubmitStress"),
+	TEXT("Posts synthetic race results to mock leaderboard service and measures throughput. Usage: vehicle.ResultSubmitStress [NumResults]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ResultSubmitStress));
@@ -6,12 +6,20 @@
 
 #include "Particles/ParticleSystemComponent.h"
 #include "Player/VehiclePlayerController.h"
+#include "Player/VehicleAIController.h"
 #include "WheeledVehicleMovementComponent.h"
 #include "Track/VehicleTrackPoint.h"
 #include "Effects/VehicleImpactEffect.h"
 #include "Effects/VehicleDustType.h"
+#include "VehicleGameMode.h"
+#include "Ghost/VehicleGhostRecorderComponent.h"
+#include "VehicleGameState.h"
 
 #include "AudioThread.h"
+#include "Engine/AssetManager.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Vehicle NetUpdateFrequency (total)"), STAT_VehicleNetUpdateFrequency, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("Buggy tick"), STAT_BuggyTick, STATGROUP_VehicleGame);
 
 TMap<uint32, ABuggyPawn::FVehicleDesiredRPM> ABuggyPawn::BuggyDesiredRPMs;
 
@@ -47,6 +55,8 @@ ABuggyPawn::ABuggyPawn(const FObjectInitializer& ObjectInitializer) :
 	SkidAC = CreateDefaultSubobject<UAudioComponent>(TEXT("SkidAudio"));
 	SkidAC->bAutoActivate = false;	//we don't want to start skid right away
 	SkidAC->SetupAttachment(GetMesh());
+
+	GhostRecorder = CreateDefaultSubobject<UVehicleGhostRecorderComponent>(TEXT("GhostRecorder"));
 	SkidThresholdVelocity = 30;
 	SkidFadeoutTime = 0.1f;
 	LongSlipSkidThreshold = 0.3f;
@@ -57,22 +67,69 @@ ABuggyPawn::ABuggyPawn(const FObjectInitializer& ObjectInitializer) :
 	bTiresTouchingGround = false;
 
 	ImpactEffectNormalForceThreshold = 100000.f;
+
+	MaxAdaptiveNetUpdateFrequency = 60.0f;
+	MinAdaptiveNetUpdateFrequency = 5.0f;
+	LockedNetUpdateFrequency = 1.0f;
+	NetFullRateSpeed = 2500.0f;
+	NetFullRateAngularSpeed = 180.0f;
+	NetFullRateAcceleration = 2000.0f;
+	NetRelevanceNearDistance = 5000.0f;
+	NetRelevanceFarDistance = 40000.0f;
+	OwnerNetRelevance = 0.5f;
+	AdaptiveNetUpdateInterval = 0.25f;
+	LastAdaptiveNetUpdateTime = 0.0f;
+	LastAdaptiveNetVelocity = FVector::ZeroVector;
+	MaxTrackPointSweepDistance = 5000.0f;
+
+	NetUpdateFrequency = MaxAdaptiveNetUpdateFrequency;
+	MinNetUpdateFrequency = LockedNetUpdateFrequency;
 }
 
 void ABuggyPawn::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 
-	if (EngineAC)
+	if (SkidAC)
+	{
+		SkidAC->Stop();
+	}
+
+	LoadEffects();
+}
+
+void ABuggyPawn::LoadEffects()
+{
+	if (GetNetMode() == NM_DedicatedServer || IsTemplate())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> EffectPaths;
+	for (const FSoftObjectPath& Path : { DustType.ToSoftObjectPath(), DeathFX.ToSoftObjectPath(), DeathSound.ToSoftObjectPath(),
+		EngineSound.ToSoftObjectPath(), LandingSound.ToSoftObjectPath(), SkidSound.ToSoftObjectPath(), SkidSoundStop.ToSoftObjectPath() })
+	{
+		if (!Path.IsNull())
+		{
+			EffectPaths.Add(Path);
+		}
+	}
+
+	// every pawn holds a handle, assets shared by all of them are loaded once
+	EffectsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(EffectPaths, FStreamableDelegate::CreateUObject(this, &ABuggyPawn::OnEffectsLoaded));
+}
+
+void ABuggyPawn::OnEffectsLoaded()
+{
+	if (EngineAC && !bIsDying)
 	{
-		EngineAC->SetSound(EngineSound);
+		EngineAC->SetSound(EngineSound.Get());
 		EngineAC->Play();
 	}
 
 	if (SkidAC)
 	{
-		SkidAC->SetSound(SkidSound);
-		SkidAC->Stop();
+		SkidAC->SetSound(SkidSound.Get());
 	}
 }
 
@@ -89,29 +146,30 @@ void ABuggyPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent
 
 void ABuggyPawn::MoveForward(float Val)
 {
-	AVehiclePlayerController* MyPC = Cast<AVehiclePlayerController>(GetController());
 	UWheeledVehicleMovementComponent* VehicleMovementComp = GetVehicleMovementComponent();
-	if (VehicleMovementComp == nullptr || (MyPC && MyPC->IsHandbrakeForced()))
+	if (VehicleMovementComp == nullptr || IsHandbrakeForced())
 	{
 		return;
 	}
 
+	ThrottleInput = Val;
 	VehicleMovementComp->SetThrottleInput(Val);
 }
 
 void ABuggyPawn::MoveRight(float Val)
 {
-	AVehiclePlayerController* MyPC = Cast<AVehiclePlayerController>(GetController());
 	UWheeledVehicleMovementComponent* VehicleMovementComp = GetVehicleMovementComponent();
-	if (VehicleMovementComp == nullptr || (MyPC && MyPC->IsHandbrakeForced()))
+	if (VehicleMovementComp == nullptr || IsHandbrakeForced())
 	{
 		return;
 	}
+	TurnInput = Val;
 	VehicleMovementComp->SetSteeringInput(Val);
 }
 
 void ABuggyPawn::OnHandbrakePressed()
 {
+	bHandbrakeActive = true;
 	AVehiclePlayerController *VehicleController = Cast<AVehiclePlayerController>(GetController());
 	UWheeledVehicleMovementComponent* VehicleMovementComp = GetVehicleMovementComponent();
 	if (VehicleMovementComp != nullptr)
@@ -132,10 +190,26 @@ void ABuggyPawn::OnHandbrakeReleased()
 
 void ABuggyPawn::Tick(float DeltaSeconds)
 {
+	SCOPE_CYCLE_COUNTER(STAT_BuggyTick);
+
 	Super::Tick(DeltaSeconds);
 
 	UpdateWheelEffects(DeltaSeconds);
 
+	if (Role == ROLE_Authority)
+	{
+		UpdateTrackPointCrossings();
+	}
+
+	if (Role == ROLE_Authority && GetNetMode() != NM_Standalone)
+	{
+		if (GetWorld()->GetTimeSeconds() >= LastAdaptiveNetUpdateTime + AdaptiveNetUpdateInterval)
+		{
+			UpdateAdaptiveNetUpdateFrequency();
+		}
+		INC_FLOAT_STAT_BY(STAT_VehicleNetUpdateFrequency, NetUpdateFrequency);
+	}
+
 	if (AVehiclePlayerController* VehiclePC = Cast<AVehiclePlayerController>(GetController()))
 	{
 		const uint32 VehiclePCID = VehiclePC->GetUniqueID();
@@ -186,18 +260,20 @@ void ABuggyPawn::SpawnNewWheelEffect(int WheelIndex)
 
 void ABuggyPawn::UpdateWheelEffects(float DeltaTime)
 {
-	if (GetVehicleMovement() && bTiresTouchingGround == false && LandingSound)	//we don't update bTiresTouchingGround until later in this function, so we can use it here to determine whether we're landing
+	if (GetVehicleMovement() && bTiresTouchingGround == false && LandingSound.Get())	//we don't update bTiresTouchingGround until later in this function, so we can use it here to determine whether we're landing
 	{
 		float MaxSpringForce = GetVehicleMovement()->GetMaxSpringForce();
 		if (MaxSpringForce > SpringCompressionLandingThreshold)
 		{
-			UGameplayStatics::PlaySoundAtLocation(this, LandingSound, GetActorLocation());
+			UGameplayStatics::PlaySoundAtLocation(this, LandingSound.Get(), GetActorLocation());
 		}
 	}
 
 	bTiresTouchingGround = false;
 
-	if (DustType && !bIsDying &&
+	// effects are soft references, nothing plays until they are loaded
+	UVehicleDustType* LoadedDustType = DustType.Get();
+	if (LoadedDustType && !bIsDying &&
 		GetVehicleMovement() && GetVehicleMovement()->Wheels.Num() > 0)
 	{
 		const float CurrentSpeed = GetVehicleSpeed();
@@ -208,7 +284,7 @@ void ABuggyPawn::UpdateWheelEffects(float DeltaTime)
 			{
 				bTiresTouchingGround = true;
 			}
-			UParticleSystem* WheelFX = DustType->GetDustFX(ContactMat, CurrentSpeed);
+			UParticleSystem* WheelFX = LoadedDustType->GetDustFX(ContactMat, CurrentSpeed);
 
 			const bool bIsActive = DustPSC[i] != nullptr && !DustPSC[i]->bWasDeactivated && !DustPSC[i]->bWasCompleted;
 			UParticleSystem* CurrentFX = DustPSC[i] != nullptr ? DustPSC[i]->Template : nullptr;
@@ -253,19 +329,63 @@ void ABuggyPawn::UpdateWheelEffects(float DeltaTime)
 			SkidAC->FadeOut(SkidFadeoutTime, 0);
 			if (CurrTime - SkidStartTime > SkidDurationRequiredForStopSound)
 			{
-				UGameplayStatics::PlaySoundAtLocation(this, SkidSoundStop, GetActorLocation());
+				UGameplayStatics::PlaySoundAtLocation(this, SkidSoundStop.Get(), GetActorLocation());
 			}
 		}
 	}
 }
 
-void ABuggyPawn::OnTrackPointReached(AVehicleTrackPoint* NewCheckpoint)
+void ABuggyPawn::OnTrackPointReached(AVehicleTrackPoint* NewCheckpoint, float CrossingTime)
 {
 	AVehiclePlayerController* MyPC = Cast<AVehiclePlayerController>(GetController());
 	if (MyPC)
 	{
 		MyPC->OnTrackPointReached(NewCheckpoint);
 	}
+
+	AVehicleAIController* MyAI = Cast<AVehicleAIController>(GetController());
+	if (MyAI)
+	{
+		MyAI->OnTrackPointReached(NewCheckpoint);
+	}
+
+	AVehicleGameMode* GameMode = GetWorld()->GetAuthGameMode<AVehicleGameMode>();
+	if (GameMode && GetController())
+	{
+		GameMode->OnTrackPointCrossed(GetController(), NewCheckpoint, CrossingTime);
+	}
+}
+
+void ABuggyPawn::UpdateTrackPointCrossings()
+{
+	TransformHistory.Add(GetWorld()->GetTimeSeconds(), GetActorLocation());
+	if (TransformHistory.Num() < 2 || bIsDying)
+	{
+		return;
+	}
+
+	const FVehicleTransformHistory::FSample& PrevSample = TransformHistory.GetSample(1);
+	const FVehicleTransformHistory::FSample& CurrentSample = TransformHistory.GetSample(0);
+	if (FVector::DistSquared(PrevSample.Location, CurrentSample.Location) > FMath::Square(MaxTrackPointSweepDistance))
+	{
+		return;
+	}
+
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState == nullptr)
+	{
+		return;
+	}
+
+	// sweep the path driven since last frame, fast vehicles can skip a gate entirely between two overlap checks
+	for (AVehicleTrackPoint* TrackPoint : VehicleGameState->GetTrackPoints())
+	{
+		float CrossingAlpha = 0.0f;
+		if (TrackPoint && TrackPoint->GetSegmentCrossing(PrevSample.Location, CurrentSample.Location, CrossingAlpha))
+		{
+			OnTrackPointReached(TrackPoint, FMath::Lerp(PrevSample.Time, CurrentSample.Time, CrossingAlpha));
+		}
+	}
 }
 
 bool ABuggyPawn::IsHandbrakeActive() const
@@ -273,6 +393,18 @@ bool ABuggyPawn::IsHandbrakeActive() const
 	return bHandbrakeActive;
 }
 
+bool ABuggyPawn::IsHandbrakeForced() const
+{
+	AVehiclePlayerController* MyPC = Cast<AVehiclePlayerController>(GetController());
+	if (MyPC)
+	{
+		return MyPC->IsHandbrakeForced();
+	}
+
+	AVehicleAIController* MyAI = Cast<AVehicleAIController>(GetController());
+	return MyAI && MyAI->IsHandbrakeForced();
+}
+
 float ABuggyPawn::GetVehicleSpeed() const
 {
 	return (GetVehicleMovement()) ? FMath::Abs(GetVehicleMovement()->GetForwardSpeed()) : 0.0f;
@@ -288,11 +420,118 @@ float ABuggyPawn::GetEngineMaxRotationSpeed() const
 	return (GetVehicleMovement()) ? FMath::Abs(GetVehicleMovement()->MaxEngineRPM) : 1.f;
 }
 
+void ABuggyPawn::UpdateAdaptiveNetUpdateFrequency()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || Role != ROLE_Authority || GetNetMode() == NM_Standalone || bIsDying)
+	{
+		return;
+	}
+
+	const float CurrentTime = World->GetTimeSeconds();
+	const float ElapsedTime = CurrentTime - LastAdaptiveNetUpdateTime;
+	const FVector Velocity = GetVelocity();
+	const float Acceleration = ElapsedTime > KINDA_SMALL_NUMBER ? (Velocity - LastAdaptiveNetVelocity).Size() / ElapsedTime : 0.0f;
+	LastAdaptiveNetUpdateTime = CurrentTime;
+	LastAdaptiveNetVelocity = Velocity;
+
+	float NewFrequency = MinAdaptiveNetUpdateFrequency;
+	if (IsHandbrakeForced() && Velocity.SizeSquared() < FMath::Square(SkidThresholdVelocity))
+	{
+		// parked on the grid, nothing to tell anyone until the race starts
+		NewFrequency = LockedNetUpdateFrequency;
+	}
+	else
+	{
+		const float AngularSpeed = GetMesh() ? GetMesh()->GetPhysicsAngularVelocity().Size() : 0.0f;
+		const float MotionAlpha = FMath::Clamp(FMath::Max3(Velocity.Size() / NetFullRateSpeed, AngularSpeed / NetFullRateAngularSpeed, Acceleration / NetFullRateAcceleration), 0.0f, 1.0f);
+
+		// relevance comes from the closest viewer
+		float RelevanceAlpha = 0.0f;
+		const FVector MyLocation = GetActorLocation();
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			APlayerController* ViewerPC = It->Get();
+			if (ViewerPC == nullptr)
+			{
+				continue;
+			}
+
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			ViewerPC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			const float Distance = FVector::Dist(ViewLocation, MyLocation);
+			float ViewerRelevance = 1.0f - FMath::Clamp((Distance - NetRelevanceNearDistance) / FMath::Max(NetRelevanceFarDistance - NetRelevanceNearDistance, 1.0f), 0.0f, 1.0f);
+			if (ViewerPC == GetController())
+			{
+				ViewerRelevance *= OwnerNetRelevance;
+			}
+			RelevanceAlpha = FMath::Max(RelevanceAlpha, ViewerRelevance);
+		}
+
+		NewFrequency = FMath::Lerp(MinAdaptiveNetUpdateFrequency, MaxAdaptiveNetUpdateFrequency, MotionAlpha * RelevanceAlpha);
+	}
+
+	// next update was scheduled with the old rate, don't wait for it when we speed up considerably
+	if (NewFrequency > NetUpdateFrequency * 2.0f)
+	{
+		ForceNetUpdate();
+	}
+	NetUpdateFrequency = NewFrequency;
+}
+
+void ABuggyPawn::ResetToTransform(const FTransform& NewTransform)
+{
+	// inputs and wheel state would carry the old speed over the teleport
+	ThrottleInput = 0.0f;
+	TurnInput = 0.0f;
+	UWheeledVehicleMovementComponent* VehicleMovementComp = GetVehicleMovementComponent();
+	if (VehicleMovementComp != nullptr)
+	{
+		VehicleMovementComp->SetThrottleInput(0.0f);
+		VehicleMovementComp->SetSteeringInput(0.0f);
+		VehicleMovementComp->StopMovementImmediately();
+	}
+
+	SetActorTransform(NewTransform, false, nullptr, ETeleportType::TeleportPhysics);
+	if (GetMesh())
+	{
+		GetMesh()->SetPhysicsLinearVelocity(FVector::ZeroVector);
+		GetMesh()->SetPhysicsAngularVelocity(FVector::ZeroVector);
+	}
+
+	// movement between old and new location is not driven, never sweep it for track points
+	TransformHistory.Reset();
+
+	if (bSkidding && SkidAC)
+	{
+		bSkidding = false;
+		SkidAC->Stop();
+	}
+
+	if (GhostRecorder && GhostRecorder->IsRecording())
+	{
+		GhostRecorder->StartRecording();
+	}
+
+	if (Role == ROLE_Authority && Controller && !IsLocallyControlled())
+	{
+		ClientResetToTransform(NewTransform);
+	}
+}
+
+void ABuggyPawn::ClientResetToTransform_Implementation(const FTransform& NewTransform)
+{
+	ResetToTransform(NewTransform);
+}
+
 void ABuggyPawn::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalForce, const FHitResult& Hit)
 {
 	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalForce, Hit);
 
-	if (ImpactTemplate && NormalForce.SizeSquared() > FMath::Square(ImpactEffectNormalForceThreshold))
+	// nobody sees or hears impacts on dedicated server, and they are not recorded into replays
+	if (ImpactTemplate && GetNetMode() != NM_DedicatedServer && NormalForce.SizeSquared() > FMath::Square(ImpactEffectNormalForceThreshold))
 	{
 		FTransform const SpawnTransform(HitNormal.Rotation(), HitLocation);
 		AVehicleImpactEffect* EffectActor = GetWorld()->SpawnActorDeferred<AVehicleImpactEffect>(ImpactTemplate, SpawnTransform);
@@ -358,6 +597,12 @@ void ABuggyPawn::OnRep_Dying()
 	{
 		OnDeath();
 	}
+	else
+	{
+		// revived from server's pool, movement arrived in the same update
+		ReactivateVehicle();
+		ResetToTransform(FTransform(ReplicatedMovement.Rotation, ReplicatedMovement.Location));
+	}
 }
 
 void ABuggyPawn::TornOff()
@@ -369,16 +614,47 @@ void ABuggyPawn::TornOff()
 
 void ABuggyPawn::OnDeath()
 {
-	AVehiclePlayerController* MyPC = Cast<AVehiclePlayerController>(GetController());
-	bReplicateMovement = false;
-	bTearOff = true;
 	bIsDying = true;
 
 	DetachFromControllerPendingDestroy();
 
 	// hide and disable
-	TurnOff();
+	DeactivateVehicle();
+	PlayDestructionFX();
+
+	// game mode keeps vehicle for next respawn if its pool has room, clients follow bIsDying
+	AVehicleGameMode* const MyGame = GetWorld()->GetAuthGameMode<AVehicleGameMode>();
+	if (Role == ROLE_Authority && (MyGame == nullptr || !MyGame->ReleasePawn(this)))
+	{
+		bReplicateMovement = false;
+		bTearOff = true;
+		TurnOff();
+		// Give use a finite lifespan
+		SetLifeSpan( 0.2f );
+	}
+}
+
+void ABuggyPawn::Revive(const FTransform& NewTransform)
+{
+	bIsDying = false;
+	ReactivateVehicle();
+	ResetToTransform(NewTransform);
+	ForceNetUpdate();
+}
+
+void ABuggyPawn::DeactivateVehicle()
+{
 	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	UPawnMovementComponent* MovementComp = GetMovementComponent();
+	if (MovementComp)
+	{
+		MovementComp->StopMovementImmediately();
+		MovementComp->SetComponentTickEnabled(false);
+	}
+	DisableComponentsSimulatePhysics();
 
 	if (EngineAC)
 	{
@@ -389,22 +665,62 @@ void ABuggyPawn::OnDeath()
 	{
 		SkidAC->Stop();
 	}
-	
-	PlayDestructionFX();
-	// Give use a finite lifespan
-	SetLifeSpan( 0.2f );	
+	bSkidding = false;
+
+	for (int32 i = 0; i < ARRAY_COUNT(DustPSC); i++)
+	{
+		if (DustPSC[i] != nullptr)
+		{
+			DustPSC[i]->SetActive(false);
+		}
+	}
+
+	if (GhostRecorder)
+	{
+		GhostRecorder->StopRecording();
+	}
+}
+
+void ABuggyPawn::ReactivateVehicle()
+{
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	if (GetMesh())
+	{
+		GetMesh()->SetSimulatePhysics(true);
+	}
+
+	UPawnMovementComponent* MovementComp = GetMovementComponent();
+	if (MovementComp)
+	{
+		MovementComp->SetComponentTickEnabled(true);
+	}
+
+	if (EngineAC && EngineSound.Get())
+	{
+		EngineAC->SetSound(EngineSound.Get());
+		EngineAC->Play();
+	}
+
+	// recording was stopped on deactivation, revived vehicle starts a new ghost
+	if (GhostRecorder)
+	{
+		GhostRecorder->EnableAutoRecording();
+	}
 }
 
 void ABuggyPawn::PlayDestructionFX()
 {
-	if (DeathFX)
+	if (DeathFX.Get())
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(this, DeathFX, GetActorLocation(), GetActorRotation());
+		UGameplayStatics::SpawnEmitterAtLocation(this, DeathFX.Get(), GetActorLocation(), GetActorRotation());
 	}
 
-	if (DeathSound)
+	if (DeathSound.Get())
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
+		UGameplayStatics::PlaySoundAtLocation(this, DeathSound.Get(), GetActorLocation());
 	}
 }
 
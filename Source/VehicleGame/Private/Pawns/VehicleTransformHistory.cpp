@@ -0,0 +1,36 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Pawns/VehicleTransformHistory.h"
+
+FVehicleTransformHistory::FVehicleTransformHistory()
+{
+	Reset();
+}
+
+void FVehicleTransformHistory::Add(float Time, const FVector& Location)
+{
+	Head = (Head + 1) % MaxSamples;
+	Count = FMath::Min(Count + 1, MaxSamples);
+
+	FSample& Sample = Samples[Head];
+	Sample.Time = Time;
+	Sample.Location = Location;
+}
+
+void FVehicleTransformHistory::Reset()
+{
+	Head = MaxSamples - 1;
+	Count = 0;
+}
+
+int32 FVehicleTransformHistory::Num() const
+{
+	return Count;
+}
+
+const FVehicleTransformHistory::FSample& FVehicleTransformHistory::GetSample(int32 Age) const
+{
+	check(Age >= 0 && Age < Count);
+	return Samples[(Head - Age + MaxSamples) % MaxSamples];
+}
@@ -0,0 +1,152 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Player/VehicleAIController.h"
+#include "Pawns/BuggyPawn.h"
+#include "Track/VehicleTrackPoint.h"
+#include "VehicleGameState.h"
+
+AVehicleAIController::AVehicleAIController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	bWantsPlayerState = true;
+	StuckSpeed = 100.0f;
+	MaxStuckTime = 3.0f;
+	RespawnDelay = 1.0f;
+
+	NextTrackPointIndex = 0;
+	StuckTime = 0.0f;
+	bReversing = false;
+	RacingLineDistance = -1.0f;
+	bHandbrakeOverride = false;
+}
+
+void AVehicleAIController::Possess(APawn* InPawn)
+{
+	Super::Possess(InPawn);
+
+	StuckTime = 0.0f;
+	bReversing = false;
+	RacingLineDistance = -1.0f;
+}
+
+void AVehicleAIController::PawnPendingDestroy(APawn* InPawn)
+{
+	Super::PawnPendingDestroy(InPawn);
+
+	GetWorldTimerManager().SetTimer(TimerHandle_Respawn, this, &AVehicleAIController::Respawn, RespawnDelay, false);
+}
+
+void AVehicleAIController::Respawn()
+{
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (GameMode && GetPawn() == nullptr)
+	{
+		GameMode->RestartPlayer(this);
+	}
+}
+
+void AVehicleAIController::ApplyDriving(float Throttle, float Steering, bool bHandbrake, bool bNewReversing, float NewRacingLineDistance, float DeltaSeconds)
+{
+	ABuggyPawn* MyPawn = Cast<ABuggyPawn>(GetPawn());
+	if (MyPawn == nullptr || MyPawn->IsPendingKill())
+	{
+		return;
+	}
+
+	bReversing = bNewReversing;
+	RacingLineDistance = NewRacingLineDistance;
+	MyPawn->MoveForward(Throttle);
+	MyPawn->MoveRight(Steering);
+	if (bHandbrake != MyPawn->IsHandbrakeActive())
+	{
+		if (bHandbrake)
+		{
+			MyPawn->OnHandbrakePressed();
+		}
+		else
+		{
+			MyPawn->OnHandbrakeReleased();
+		}
+	}
+
+	UpdateStuck(MyPawn, DeltaSeconds);
+}
+
+void AVehicleAIController::UpdateStuck(ABuggyPawn* MyPawn, float DeltaSeconds)
+{
+	if (IsHandbrakeForced())
+	{
+		StuckTime = 0.0f;
+		return;
+	}
+
+	const bool bUpsideDown = MyPawn->GetActorUpVector().Z < 0.2f;
+	if (bUpsideDown || MyPawn->GetVelocity().SizeSquared() < FMath::Square(StuckSpeed))
+	{
+		StuckTime += DeltaSeconds;
+	}
+	else
+	{
+		StuckTime = 0.0f;
+	}
+
+	if (StuckTime > MaxStuckTime)
+	{
+		StuckTime = 0.0f;
+		Suicide();
+	}
+}
+
+void AVehicleAIController::Suicide()
+{
+	AVehicleGameState* GameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (((GameState != nullptr) && (GameState->IsRaceActive())) || (GetNetMode() == NM_Standalone))
+	{
+		ABuggyPawn* MyPawn = Cast<ABuggyPawn>(GetPawn());
+		if (MyPawn)
+		{
+			MyPawn->Die();
+		}
+	}
+}
+
+void AVehicleAIController::ResetRaceProgress()
+{
+	LastTrackPoint = nullptr;
+	StartSpot = nullptr;
+	NextTrackPointIndex = 0;
+	StuckTime = 0.0f;
+	bReversing = false;
+	RacingLineDistance = -1.0f;
+	GetWorldTimerManager().ClearTimer(TimerHandle_Respawn);
+}
+
+void AVehicleAIController::OnTrackPointReached(AVehicleTrackPoint* TrackPoint)
+{
+	LastTrackPoint = TrackPoint;
+	StartSpot = TrackPoint;
+
+	AVehicleGameState* GameState = GetWorld()->GetGameState<AVehicleGameState>();
+	const int32 TrackPointIndex = GameState ? GameState->GetTrackPoints().IndexOfByKey(TrackPoint) : INDEX_NONE;
+	if (TrackPointIndex != INDEX_NONE)
+	{
+		NextTrackPointIndex = (TrackPointIndex + 1) % GameState->GetTrackPoints().Num();
+	}
+}
+
+bool AVehicleAIController::IsHandbrakeForced() const
+{
+	return bHandbrakeOverride;
+}
+
+void AVehicleAIController::SetHandbrakeForced(bool bNewForced)
+{
+	const bool bChanged = (bHandbrakeOverride != bNewForced);
+	bHandbrakeOverride = bNewForced;
+
+	ABuggyPawn* MyPawn = Cast<ABuggyPawn>(GetPawn());
+	if (bChanged && MyPawn)
+	{
+		MyPawn->UpdateAdaptiveNetUpdateFrequency();
+	}
+}
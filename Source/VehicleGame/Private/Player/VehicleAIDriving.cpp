@@ -0,0 +1,343 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Player/VehicleAIDriving.h"
+#include "Player/VehicleAIController.h"
+#include "Pawns/BuggyPawn.h"
+#include "Track/VehicleTrackPoint.h"
+#include "Track/VehicleRacingLine.h"
+#include "VehicleGameState.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI driving gather"), STAT_AIDrivingGather, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("AI driving compute"), STAT_AIDrivingCompute, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("AI driving apply"), STAT_AIDrivingApply, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI drivers"), STAT_NumAIDrivers, STATGROUP_VehicleGame);
+
+static TAutoConsoleVariable<int32> CVarAIDrivingParallel(
+	TEXT("vehicle.AIDrivingParallel"),
+	1,
+	TEXT("Compute bot driving on worker threads.\n")
+	TEXT("0: game thread only, 1: worker threads"));
+
+/** below this many drivers the task overhead outweighs the work */
+static const int32 MinParallelDrivers = 8;
+
+FVehicleAIDriverSettings::FVehicleAIDriverSettings()
+{
+	LookAheadDistance = 1000.0f;
+	LookAheadTime = 0.5f;
+	MaxSteeringAngle = 35.0f;
+	MaxSpeed = 3000.0f;
+	MinSpeed = 600.0f;
+	MaxLateralAcceleration = 800.0f;
+	BrakingDeceleration = 1200.0f;
+	SpeedLeadTime = 0.25f;
+	SpeedControlRange = 300.0f;
+	NumPlannedTrackPoints = 4;
+	HandbrakeAngle = 50.0f;
+	HandbrakeMinSpeed = 1000.0f;
+	ReverseMaxSpeed = 300.0f;
+	AvoidanceDistance = 1500.0f;
+	AvoidanceWidth = 250.0f;
+	AvoidanceSteering = 0.5f;
+}
+
+FVehicleAIDrivingBatch::FVehicleAIDrivingBatch()
+	: RacingLine(nullptr)
+{
+}
+
+void FVehicleAIDrivingBatch::Update(UWorld* World, float DeltaSeconds)
+{
+	AVehicleGameState* GameState = World ? World->GetGameState<AVehicleGameState>() : nullptr;
+	if (GameState == nullptr)
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AIDrivingGather);
+
+		RacingLine = GameState->GetRacingLine();
+		TrackPoints.Reset();
+		for (AVehicleTrackPoint* TrackPoint : GameState->GetTrackPoints())
+		{
+			TrackPoints.Add(TrackPoint->GetActorLocation());
+		}
+
+		Controllers.Reset();
+		for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+		{
+			AVehicleAIController* Bot = Cast<AVehicleAIController>(*It);
+			ABuggyPawn* BotPawn = Bot ? Cast<ABuggyPawn>(Bot->GetPawn()) : nullptr;
+			if (BotPawn && !BotPawn->IsPendingKill())
+			{
+				Controllers.Add(Bot);
+			}
+		}
+
+		SetNumDrivers(Controllers.Num());
+		for (int32 DriverIdx = 0; DriverIdx < Controllers.Num(); DriverIdx++)
+		{
+			AVehicleAIController* Bot = Controllers[DriverIdx];
+			ABuggyPawn* BotPawn = CastChecked<ABuggyPawn>(Bot->GetPawn());
+			const FTransform& BotTransform = BotPawn->GetActorTransform();
+
+			Locations[DriverIdx] = BotTransform.GetLocation();
+			Forwards[DriverIdx] = BotTransform.GetUnitAxis(EAxis::X);
+			Rights[DriverIdx] = BotTransform.GetUnitAxis(EAxis::Y);
+			Speeds[DriverIdx] = BotPawn->GetVehicleSpeed();
+			NextTrackPoints[DriverIdx] = Bot->GetNextTrackPointIndex();
+			Settings[DriverIdx] = &Bot->GetDriverSettings();
+			Reversing[DriverIdx] = Bot->IsReversing();
+			RacingLineDistances[DriverIdx] = Bot->GetRacingLineDistance();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_NumAIDrivers, Controllers.Num());
+	if (Controllers.Num() == 0)
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AIDrivingCompute);
+		Compute(CVarAIDrivingParallel.GetValueOnGameThread() != 0);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AIDrivingApply);
+		for (int32 DriverIdx = 0; DriverIdx < Controllers.Num(); DriverIdx++)
+		{
+			Controllers[DriverIdx]->ApplyDriving(Throttles[DriverIdx], Steerings[DriverIdx], Handbrakes[DriverIdx], Reversing[DriverIdx], RacingLineDistances[DriverIdx], DeltaSeconds);
+		}
+	}
+}
+
+void FVehicleAIDrivingBatch::SetNumDrivers(int32 NumDrivers)
+{
+	Locations.SetNumUninitialized(NumDrivers, false);
+	Forwards.SetNumUninitialized(NumDrivers, false);
+	Rights.SetNumUninitialized(NumDrivers, false);
+	Speeds.SetNumUninitialized(NumDrivers, false);
+	NextTrackPoints.SetNumUninitialized(NumDrivers, false);
+	Settings.SetNumUninitialized(NumDrivers, false);
+	Throttles.SetNumUninitialized(NumDrivers, false);
+	Steerings.SetNumUninitialized(NumDrivers, false);
+	Handbrakes.SetNumUninitialized(NumDrivers, false);
+	Reversing.SetNumUninitialized(NumDrivers, false);
+	RacingLineDistances.SetNumUninitialized(NumDrivers, false);
+}
+
+void FVehicleAIDrivingBatch::Compute(bool bParallel)
+{
+	const int32 NumDrivers = Locations.Num();
+	if (TrackPoints.Num() == 0 && RacingLine == nullptr)
+	{
+		for (int32 DriverIdx = 0; DriverIdx < NumDrivers; DriverIdx++)
+		{
+			Throttles[DriverIdx] = 0.0f;
+			Steerings[DriverIdx] = 0.0f;
+			Handbrakes[DriverIdx] = false;
+			Reversing[DriverIdx] = false;
+		}
+		return;
+	}
+
+	// every driver reads shared state only and writes its own output slots
+	ParallelFor(NumDrivers, [this](int32 DriverIdx)
+	{
+		ComputeDriver(DriverIdx);
+	}, !bParallel || NumDrivers < MinParallelDrivers);
+}
+
+void FVehicleAIDrivingBatch::ComputeDriver(int32 DriverIdx)
+{
+	const FVehicleAIDriverSettings& DriverSettings = *Settings[DriverIdx];
+	const FVector& Location = Locations[DriverIdx];
+	const FVector& Forward = Forwards[DriverIdx];
+	const FVector& Right = Rights[DriverIdx];
+	const float Speed = Speeds[DriverIdx];
+	const int32 NextTrackPoint = NextTrackPoints[DriverIdx];
+
+	// aim further ahead the faster we go, cuts corners smoothly instead of zig-zagging between track points
+	const float LookAhead = DriverSettings.LookAheadDistance + Speed * DriverSettings.LookAheadTime;
+	FVector Target;
+	float TargetSpeed;
+	if (RacingLine)
+	{
+		// baked speeds already include braking for upcoming corners
+		const float RacingLineDistance = RacingLine->FindDistance(Location, RacingLineDistances[DriverIdx]);
+		RacingLineDistances[DriverIdx] = RacingLineDistance;
+		Target = RacingLine->GetLocationAtDistance(RacingLineDistance + LookAhead);
+		TargetSpeed = FMath::Min(RacingLine->GetTargetSpeedAtDistance(RacingLineDistance + Speed * DriverSettings.SpeedLeadTime), DriverSettings.MaxSpeed);
+	}
+	else
+	{
+		Target = GetLookAheadPoint(NextTrackPoint, Location, LookAhead);
+		TargetSpeed = GetPlannedSpeed(NextTrackPoint, Location, DriverSettings);
+	}
+
+	const FVector ToTarget = Target - Location;
+	const float TargetAngle = FMath::RadiansToDegrees(FMath::Atan2(ToTarget | Right, ToTarget | Forward));
+	float Steering = TargetAngle / DriverSettings.MaxSteeringAngle;
+
+	// brute force is fine here, 256 drivers are ~65k dot products spread over worker threads
+	for (int32 OtherIdx = 0; OtherIdx < Locations.Num(); OtherIdx++)
+	{
+		const FVector ToOther = Locations[OtherIdx] - Location;
+		const float Ahead = ToOther | Forward;
+		const float Side = ToOther | Right;
+		if (OtherIdx == DriverIdx || Ahead <= 0.0f || Ahead > DriverSettings.AvoidanceDistance || FMath::Abs(Side) > DriverSettings.AvoidanceWidth)
+		{
+			continue;
+		}
+
+		// pass on the side with more room, and don't ram it while doing so
+		const float Proximity = 1.0f - Ahead / DriverSettings.AvoidanceDistance;
+		Steering += (Side > 0.0f ? -1.0f : 1.0f) * DriverSettings.AvoidanceSteering * Proximity;
+		TargetSpeed = FMath::Min(TargetSpeed, FMath::Lerp(TargetSpeed, Speeds[OtherIdx], Proximity));
+	}
+
+	Steering = FMath::Clamp(Steering, -1.0f, 1.0f);
+	float Throttle = FMath::Clamp((TargetSpeed - Speed) / DriverSettings.SpeedControlRange, -1.0f, 1.0f);
+
+	// facing the wrong way after a spin, back up with opposite lock until the track is in front
+	bool bReversing = Reversing[DriverIdx];
+	if (!bReversing && FMath::Abs(TargetAngle) > 120.0f && Speed < DriverSettings.ReverseMaxSpeed)
+	{
+		bReversing = true;
+	}
+	else if (bReversing && FMath::Abs(TargetAngle) < 60.0f)
+	{
+		bReversing = false;
+	}
+
+	if (bReversing)
+	{
+		Throttle = -1.0f;
+		Steering = -FMath::Sign(TargetAngle);
+	}
+
+	Throttles[DriverIdx] = Throttle;
+	Steerings[DriverIdx] = Steering;
+	Handbrakes[DriverIdx] = !bReversing && FMath::Abs(TargetAngle) > DriverSettings.HandbrakeAngle && Speed > DriverSettings.HandbrakeMinSpeed;
+	Reversing[DriverIdx] = bReversing;
+}
+
+FVector FVehicleAIDrivingBatch::GetLookAheadPoint(int32 NextTrackPoint, const FVector& From, float Distance) const
+{
+	FVector SegmentStart = From;
+	float RemainingDistance = Distance;
+
+	for (int32 Offset = 0; Offset < TrackPoints.Num(); Offset++)
+	{
+		const FVector& SegmentEnd = GetPathPoint(NextTrackPoint, Offset);
+		const float SegmentLength = FVector::Dist(SegmentStart, SegmentEnd);
+		if (SegmentLength >= RemainingDistance)
+		{
+			return SegmentStart + (SegmentEnd - SegmentStart) * (RemainingDistance / SegmentLength);
+		}
+
+		RemainingDistance -= SegmentLength;
+		SegmentStart = SegmentEnd;
+	}
+
+	return SegmentStart;
+}
+
+float FVehicleAIDrivingBatch::GetPlannedSpeed(int32 NextTrackPoint, const FVector& From, const FVehicleAIDriverSettings& DriverSettings) const
+{
+	float PlannedSpeed = DriverSettings.MaxSpeed;
+
+	FVector PrevPoint = GetPathPoint(NextTrackPoint, -1);
+	FVector CornerPoint = GetPathPoint(NextTrackPoint, 0);
+	float DistanceToCorner = FVector::Dist(From, CornerPoint);
+
+	const int32 NumCorners = FMath::Min(DriverSettings.NumPlannedTrackPoints, TrackPoints.Num());
+	for (int32 Offset = 0; Offset < NumCorners; Offset++)
+	{
+		const FVector& NextPoint = GetPathPoint(NextTrackPoint, Offset + 1);
+		const float InLength = FVector::Dist(PrevPoint, CornerPoint);
+		const float OutLength = FVector::Dist(CornerPoint, NextPoint);
+		const float TurnAngle = FMath::Acos(FMath::Clamp((CornerPoint - PrevPoint).GetSafeNormal2D() | (NextPoint - CornerPoint).GetSafeNormal2D(), -1.0f, 1.0f));
+
+		// heading change spread over the shorter leg approximates the corner radius
+		const float Curvature = TurnAngle / FMath::Max(FMath::Min(InLength, OutLength), 100.0f);
+		const float CornerSpeed = Curvature > KINDA_SMALL_NUMBER ? FMath::Sqrt(DriverSettings.MaxLateralAcceleration / Curvature) : DriverSettings.MaxSpeed;
+		const float ApproachSpeed = FMath::Sqrt(FMath::Square(CornerSpeed) + 2.0f * DriverSettings.BrakingDeceleration * DistanceToCorner);
+		PlannedSpeed = FMath::Min(PlannedSpeed, ApproachSpeed);
+
+		DistanceToCorner += OutLength;
+		PrevPoint = CornerPoint;
+		CornerPoint = NextPoint;
+	}
+
+	return FMath::Max(PlannedSpeed, DriverSettings.MinSpeed);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+static void AIDrivingBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumFrames = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200, 1);
+	const int32 NumTrackPoints = 32;
+	const int32 DriverCounts[] = { 16, 64, 256 };
+
+	FVehicleAIDriverSettings DriverSettings;
+	FRandomStream Random(0x5eed);
+
+	for (int32 NumDrivers : DriverCounts)
+	{
+		FVehicleAIDrivingBatch Batch;
+
+		// oval track, drivers spread around it in packs
+		for (int32 TrackPointIdx = 0; TrackPointIdx < NumTrackPoints; TrackPointIdx++)
+		{
+			const float Angle = 2.0f * PI * TrackPointIdx / NumTrackPoints;
+			Batch.TrackPoints.Add(FVector(FMath::Cos(Angle) * 30000.0f, FMath::Sin(Angle) * 18000.0f, 0.0f));
+		}
+
+		Batch.SetNumDrivers(NumDrivers);
+		for (int32 DriverIdx = 0; DriverIdx < NumDrivers; DriverIdx++)
+		{
+			const int32 TrackPointIdx = DriverIdx * NumTrackPoints / NumDrivers;
+			const FVector& SegmentStart = Batch.TrackPoints[TrackPointIdx];
+			const FVector& SegmentEnd = Batch.TrackPoints[(TrackPointIdx + 1) % NumTrackPoints];
+			const FVector Forward = (SegmentEnd - SegmentStart).GetSafeNormal();
+
+			Batch.Locations[DriverIdx] = FMath::Lerp(SegmentStart, SegmentEnd, Random.FRand()) + FVector(Random.FRandRange(-300.0f, 300.0f), Random.FRandRange(-300.0f, 300.0f), 0.0f);
+			Batch.Forwards[DriverIdx] = Forward;
+			Batch.Rights[DriverIdx] = FVector(-Forward.Y, Forward.X, 0.0f);
+			Batch.Speeds[DriverIdx] = Random.FRandRange(1000.0f, 2500.0f);
+			Batch.NextTrackPoints[DriverIdx] = (TrackPointIdx + 1) % NumTrackPoints;
+			Batch.Settings[DriverIdx] = &DriverSettings;
+			Batch.Reversing[DriverIdx] = false;
+			Batch.RacingLineDistances[DriverIdx] = -1.0f;
+		}
+
+		const double SingleStart = FPlatformTime::Seconds();
+		for (int32 FrameIdx = 0; FrameIdx < NumFrames; FrameIdx++)
+		{
+			Batch.Compute(false);
+		}
+		const double SingleTime = FPlatformTime::Seconds() - SingleStart;
+
+		const double ParallelStart = FPlatformTime::Seconds();
+		for (int32 FrameIdx = 0; FrameIdx < NumFrames; FrameIdx++)
+		{
+			Batch.Compute(true);
+		}
+		const double ParallelTime = FPlatformTime::Seconds() - ParallelStart;
+
+		UE_LOG(LogVehicle, Display, TEXT("AI driving, %3d drivers: %.3f ms/frame game thread, %.3f ms/frame parallel (%.1fx)"),
+			NumDrivers, SingleTime * 1000.0 / NumFrames, ParallelTime * 1000.0 / NumFrames, SingleTime / FMath::Max(ParallelTime, 1e-9));
+	}
+}
+
+static FAutoConsoleCommand AIDrivingBenchmarkCmd(
+	TEXT("vehicle.AIDrivingBenchmark"),
+	TEXT("Measures batched bot driving at 16, 64 and 256 drivers. Usage: vehicle.AIDrivingBenchmark [NumFrames]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&AIDrivingBenchmark));
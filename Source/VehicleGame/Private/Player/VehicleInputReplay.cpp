@@ -0,0 +1,260 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Player/VehicleInputReplay.h"
+#include "Player/VehiclePlayerState.h"
+#include "Pawns/BuggyPawn.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+/** bump when input log or golden file layout changes, old files have to be recorded again */
+static const int32 InputReplayVersion = 1;
+
+/** longest recorded run, in seconds */
+static const int32 InputReplayMaxTime = 20 * 60;
+
+TUniquePtr<FVehicleInputReplay> FVehicleInputReplay::CreateFromCommandLine(UWorld* World)
+{
+	const bool bRecord = FParse::Param(FCommandLine::Get(), TEXT("VehicleInputRecord"));
+	const bool bReplay = FParse::Param(FCommandLine::Get(), TEXT("VehicleInputReplay"));
+	if (World == nullptr || (!bRecord && !bReplay))
+	{
+		return nullptr;
+	}
+
+	if (!FApp::UseFixedTimeStep())
+	{
+		UE_LOG(LogVehicle, Error, TEXT("Input replay needs fixed time step, run with -benchmark -fps=60"));
+		return nullptr;
+	}
+
+	const FString MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+	TUniquePtr<FVehicleInputReplay> InputReplay = MakeUnique<FVehicleInputReplay>(bReplay ? EMode::Replay : EMode::Record, MapName);
+	if (bReplay && !InputReplay->Load())
+	{
+		InputReplay->Finish(nullptr, TEXT("missing or incompatible input log"));
+	}
+
+	return InputReplay;
+}
+
+FVehicleInputReplay::FVehicleInputReplay(EMode InMode, const FString& InMapName)
+	: Mode(InMode)
+	, MapName(InMapName)
+	, TickIndex(0)
+	, FirstMismatchTick(INDEX_NONE)
+	, bFinished(false)
+{
+	TickRate = FMath::Max(1, FMath::RoundToInt(1.0 / FApp::GetFixedDeltaTime()));
+	MaxTicks = TickRate * InputReplayMaxTime;
+
+	UE_LOG(LogVehicle, Log, TEXT("Input %s for %s started at %d ticks per second"), Mode == EMode::Record ? TEXT("recording") : TEXT("replay"), *MapName, TickRate);
+}
+
+void FVehicleInputReplay::Tick(ABuggyPawn* Pawn, AVehiclePlayerState* PlayerState)
+{
+	if (bFinished || Pawn == nullptr)
+	{
+		return;
+	}
+
+	const uint32 StateHash = HashVehicleState(Pawn);
+	if (Mode == EMode::Record)
+	{
+		StateHashes.Add(StateHash);
+	}
+	else if (FirstMismatchTick == INDEX_NONE && (!StateHashes.IsValidIndex(TickIndex) || StateHashes[TickIndex] != StateHash))
+	{
+		FirstMismatchTick = TickIndex;
+		UE_LOG(LogVehicle, Error, TEXT("Input replay of %s diverged at tick %d (%.2fs): state hash %08x, golden %08x"),
+			*MapName, TickIndex, (float)TickIndex / TickRate, StateHash, StateHashes.IsValidIndex(TickIndex) ? StateHashes[TickIndex] : 0);
+	}
+
+	if (PlayerState && PlayerState->bHasFinished)
+	{
+		Finish(PlayerState, TEXT("race finished"));
+		return;
+	}
+	if (Mode == EMode::Replay && TickIndex >= Inputs.Num())
+	{
+		Finish(PlayerState, TEXT("input log ended"));
+		return;
+	}
+	if (TickIndex >= MaxTicks)
+	{
+		Finish(PlayerState, TEXT("time limit reached"));
+		return;
+	}
+
+	if (Mode == EMode::Record)
+	{
+		FInput RecordedInput;
+		RecordedInput.Throttle = (int8)FMath::RoundToInt(FMath::Clamp(Pawn->GetThrottleInput(), -1.0f, 1.0f) * 127.0f);
+		RecordedInput.Steering = (int8)FMath::RoundToInt(FMath::Clamp(Pawn->GetTurnInput(), -1.0f, 1.0f) * 127.0f);
+		RecordedInput.bHandbrake = Pawn->IsHandbrakeActive() ? 1 : 0;
+		Inputs.Add(RecordedInput);
+	}
+
+	// recorded run is driven by the quantized input too, so replay sees exactly the same values
+	const FInput& Input = Inputs[TickIndex];
+	Pawn->MoveForward(Input.Throttle / 127.0f);
+	Pawn->MoveRight(Input.Steering / 127.0f);
+	if ((Input.bHandbrake != 0) != Pawn->IsHandbrakeActive())
+	{
+		if (Input.bHandbrake != 0)
+		{
+			Pawn->OnHandbrakePressed();
+		}
+		else
+		{
+			Pawn->OnHandbrakeReleased();
+		}
+	}
+
+	TickIndex++;
+}
+
+void FVehicleInputReplay::Finish(AVehiclePlayerState* PlayerState, const FString& Reason)
+{
+	if (bFinished)
+	{
+		return;
+	}
+	bFinished = true;
+
+	TArray<float> RunLapTimes;
+	if (PlayerState)
+	{
+		RunLapTimes = PlayerState->LapTimes;
+	}
+
+	if (Mode == EMode::Record)
+	{
+		LapTimes = RunLapTimes;
+		const bool bSaved = Save();
+		UE_LOG(LogVehicle, Log, TEXT("Input recording of %s stopped (%s) after %d ticks, %d laps: %s"),
+			*MapName, *Reason, Inputs.Num(), LapTimes.Num(), bSaved ? TEXT("saved") : TEXT("failed to save"));
+	}
+	else
+	{
+		// run that stops early or goes on longer than golden one diverged on the first tick golden file doesn't share
+		const int32 NumRunTicks = TickIndex + 1;
+		if (FirstMismatchTick == INDEX_NONE && NumRunTicks != StateHashes.Num())
+		{
+			FirstMismatchTick = FMath::Min(NumRunTicks, StateHashes.Num());
+		}
+
+		bool bLapTimesMatch = RunLapTimes.Num() == LapTimes.Num();
+		for (int32 LapIdx = 0; bLapTimesMatch && LapIdx < LapTimes.Num(); LapIdx++)
+		{
+			bLapTimesMatch = FMath::IsNearlyEqual(RunLapTimes[LapIdx], LapTimes[LapIdx], 0.001f);
+		}
+
+		const bool bPassed = FirstMismatchTick == INDEX_NONE && bLapTimesMatch && Inputs.Num() > 0;
+
+		FString LapTimesString, GoldenLapTimesString;
+		for (float LapTime : RunLapTimes)
+		{
+			LapTimesString += FString::Printf(TEXT("%.3f "), LapTime);
+		}
+		for (float LapTime : LapTimes)
+		{
+			GoldenLapTimesString += FString::Printf(TEXT("%.3f "), LapTime);
+		}
+
+		FString Result;
+		Result += FString::Printf(TEXT("Map=%s\n"), *MapName);
+		Result += FString::Printf(TEXT("Result=%s\n"), bPassed ? TEXT("Passed") : TEXT("Failed"));
+		Result += FString::Printf(TEXT("Reason=\"%s\"\n"), *Reason);
+		Result += FString::Printf(TEXT("Ticks=%d\n"), NumRunTicks);
+		Result += FString::Printf(TEXT("FirstMismatchTick=%d\n"), FirstMismatchTick);
+		Result += FString::Printf(TEXT("LapTimes=\"%s\"\n"), *LapTimesString.TrimEnd());
+		Result += FString::Printf(TEXT("GoldenLapTimes=\"%s\"\n"), *GoldenLapTimesString.TrimEnd());
+		FFileHelper::SaveStringToFile(Result, *GetResultFilename(MapName));
+
+		UE_LOG(LogVehicle, Log, TEXT("Input replay of %s %s (%s) after %d ticks, first mismatching tick %d, lap times [%s] golden [%s]"),
+			*MapName, bPassed ? TEXT("passed") : TEXT("failed"), *Reason, NumRunTicks, FirstMismatchTick, *LapTimesString.TrimEnd(), *GoldenLapTimesString.TrimEnd());
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
+
+uint32 FVehicleInputReplay::HashVehicleState(ABuggyPawn* Pawn)
+{
+	const FVector Location = Pawn->GetActorLocation();
+	const FRotator Rotation = Pawn->GetActorRotation();
+	const FVector Velocity = Pawn->GetVelocity();
+
+	// cm, 0.01 degree and cm/s resolution, tuning changes show up well above that
+	const int32 State[9] =
+	{
+		FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z),
+		FMath::RoundToInt(Rotation.Pitch * 100.0f), FMath::RoundToInt(Rotation.Yaw * 100.0f), FMath::RoundToInt(Rotation.Roll * 100.0f),
+		FMath::RoundToInt(Velocity.X), FMath::RoundToInt(Velocity.Y), FMath::RoundToInt(Velocity.Z),
+	};
+
+	return FCrc::MemCrc32(State, sizeof(State));
+}
+
+bool FVehicleInputReplay::Load()
+{
+	TArray<uint8> InputLogData, GoldenData;
+	if (!FFileHelper::LoadFileToArray(InputLogData, *GetInputLogFilename(MapName)) ||
+		!FFileHelper::LoadFileToArray(GoldenData, *GetGoldenFilename(MapName)))
+	{
+		return false;
+	}
+
+	int32 InputLogVersion = 0, InputLogTickRate = 0;
+	FMemoryReader InputLogReader(InputLogData);
+	InputLogReader << InputLogVersion << InputLogTickRate << Inputs;
+
+	int32 GoldenVersion = 0, GoldenTickRate = 0;
+	FMemoryReader GoldenReader(GoldenData);
+	GoldenReader << GoldenVersion << GoldenTickRate << StateHashes << LapTimes;
+
+	if (InputLogReader.IsError() || GoldenReader.IsError() ||
+		InputLogVersion != InputReplayVersion || GoldenVersion != InputReplayVersion)
+	{
+		return false;
+	}
+
+	if (InputLogTickRate != TickRate || GoldenTickRate != TickRate)
+	{
+		UE_LOG(LogVehicle, Error, TEXT("Input log of %s was recorded at %d ticks per second, running at %d"), *MapName, InputLogTickRate, TickRate);
+		return false;
+	}
+
+	return true;
+}
+
+bool FVehicleInputReplay::Save()
+{
+	int32 Version = InputReplayVersion;
+
+	TArray<uint8> InputLogData;
+	FMemoryWriter InputLogWriter(InputLogData);
+	InputLogWriter << Version << TickRate << Inputs;
+
+	TArray<uint8> GoldenData;
+	FMemoryWriter GoldenWriter(GoldenData);
+	GoldenWriter << Version << TickRate << StateHashes << LapTimes;
+
+	return FFileHelper::SaveArrayToFile(InputLogData, *GetInputLogFilename(MapName)) &&
+		FFileHelper::SaveArrayToFile(GoldenData, *GetGoldenFilename(MapName));
+}
+
+FString FVehicleInputReplay::GetInputLogFilename(const FString& MapName)
+{
+	return FPaths::ProjectDir() / TEXT("Test/InputReplay") / MapName + TEXT(".vinput");
+}
+
+FString FVehicleInputReplay::GetGoldenFilename(const FString& MapName)
+{
+	return FPaths::ProjectDir() / TEXT("Test/InputReplay") / MapName + TEXT(".vgolden");
+}
+
+FString FVehicleInputReplay::GetResultFilename(const FString& MapName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputReplay") / MapName + TEXT(".result");
+}
@@ -7,12 +7,57 @@
 #include "UI/VehicleHUD.h"
 #include "VehicleGameState.h"
 #include "Pawns/BuggyPawn.h"
+#include "Player/VehiclePlayerState.h"
 
 AVehiclePlayerController::AVehiclePlayerController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	PlayerCameraManagerClass = AVehiclePlayerCameraManager::StaticClass();
 	bEnableClickEvents = true;
 	bEnableTouchEvents = true;
+
+	NumClockSyncSamplesTaken = 0;
+	ClockOffset = 0.0f;
+	ClockJitter = 0.0f;
+	ClockSyncInterval = 2.0f;
+}
+
+void AVehiclePlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (IsLocalController() && Role < ROLE_Authority)
+	{
+		// sample quickly until the buffer is full, then settle to ClockSyncInterval
+		GetWorldTimerManager().SetTimer(TimerHandle_ClockSync, this, &AVehiclePlayerController::SendClockSyncRequest, 0.25f, true, 0.0f);
+	}
+
+	if (IsLocalController() && Role == ROLE_Authority)
+	{
+		InputReplay = FVehicleInputReplay::CreateFromCommandLine(GetWorld());
+	}
+}
+
+void AVehiclePlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// keep what was recorded when the game is closed before finishing the race
+	if (InputReplay.IsValid())
+	{
+		InputReplay->Finish(Cast<AVehiclePlayerState>(PlayerState), TEXT("game ended"));
+		InputReplay.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVehiclePlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	// after input processing, so replayed input overrides whatever the devices reported this frame
+	if (InputReplay.IsValid())
+	{
+		InputReplay->Tick(Cast<ABuggyPawn>(GetPawn()), Cast<AVehiclePlayerState>(PlayerState));
+	}
 }
 
 void AVehiclePlayerController::SetupInputComponent()
@@ -62,12 +107,30 @@ void AVehiclePlayerController::GetLifetimeReplicatedProps( TArray< FLifetimeProp
 
 bool AVehiclePlayerController::IsHandbrakeForced() const
 {
+	// release at the announced start time on our clock instead of whenever the unlock replicates
+	if (bHandbrakeOverride && Role < ROLE_Authority && HasClockSync())
+	{
+		AVehicleGameState* const VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+		if (VehicleGameState && VehicleGameState->RaceStartServerTime > 0.0f && GetServerTime() >= VehicleGameState->RaceStartServerTime)
+		{
+			return false;
+		}
+	}
+
 	return bHandbrakeOverride;
 }
 
 void AVehiclePlayerController::SetHandbrakeForced(bool bNewForced)
 {
+	const bool bChanged = (bHandbrakeOverride != bNewForced);
 	bHandbrakeOverride = bNewForced;
+
+	// lock/unlock changes replication needs right away, don't wait for next recalculation
+	ABuggyPawn* MyPawn = Cast<ABuggyPawn>(GetPawn());
+	if (bChanged && MyPawn)
+	{
+		MyPawn->UpdateAdaptiveNetUpdateFrequency();
+	}
 }
 
 void AVehiclePlayerController::Suicide()
@@ -96,3 +159,71 @@ void AVehiclePlayerController::ServerSuicide_Implementation()
 	}
 }
 
+
+float AVehiclePlayerController::GetServerTime() const
+{
+	const float LocalTime = GetWorld()->GetTimeSeconds();
+	return (Role == ROLE_Authority) ? LocalTime : LocalTime + ClockOffset;
+}
+
+bool AVehiclePlayerController::HasClockSync() const
+{
+	return NumClockSyncSamplesTaken > 0;
+}
+
+void AVehiclePlayerController::SendClockSyncRequest()
+{
+	ServerRequestClockSync(GetWorld()->GetTimeSeconds());
+}
+
+bool AVehiclePlayerController::ServerRequestClockSync_Validate(float ClientSendTime)
+{
+	return true;
+}
+
+void AVehiclePlayerController::ServerRequestClockSync_Implementation(float ClientSendTime)
+{
+	ClientReceiveClockSync(ClientSendTime, GetWorld()->GetTimeSeconds());
+}
+
+void AVehiclePlayerController::ClientReceiveClockSync_Implementation(float ClientSendTime, float ServerTime)
+{
+	const float LocalTime = GetWorld()->GetTimeSeconds();
+	FClockSyncSample& NewSample = ClockSyncSamples[NumClockSyncSamplesTaken % NumClockSyncSamples];
+	NewSample.RoundTripTime = FMath::Max(LocalTime - ClientSendTime, 0.0f);
+	NewSample.Offset = ServerTime + NewSample.RoundTripTime * 0.5f - LocalTime;
+	NumClockSyncSamplesTaken++;
+
+	// NTP style: the shortest round trip had the least queuing delay, so its offset is the most trustworthy
+	const int32 NumSamples = FMath::Min(NumClockSyncSamplesTaken, NumClockSyncSamples);
+	int32 BestIndex = 0;
+	float MeanRoundTripTime = 0.0f;
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		MeanRoundTripTime += ClockSyncSamples[i].RoundTripTime / NumSamples;
+		if (ClockSyncSamples[i].RoundTripTime < ClockSyncSamples[BestIndex].RoundTripTime)
+		{
+			BestIndex = i;
+		}
+	}
+
+	float Variance = 0.0f;
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		Variance += FMath::Square(ClockSyncSamples[i].RoundTripTime - MeanRoundTripTime) / NumSamples;
+	}
+
+	ClockOffset = ClockSyncSamples[BestIndex].Offset;
+	ClockJitter = FMath::Sqrt(Variance);
+
+	if (NumClockSyncSamplesTaken % NumClockSyncSamples == 0)
+	{
+		UE_LOG(LogVehicle, Log, TEXT("Clock sync: offset %.2f ms, best rtt %.2f ms, mean rtt %.2f ms, jitter %.2f ms"),
+			ClockOffset * 1000.0f, ClockSyncSamples[BestIndex].RoundTripTime * 1000.0f, MeanRoundTripTime * 1000.0f, ClockJitter * 1000.0f);
+
+		if (NumClockSyncSamplesTaken == NumClockSyncSamples)
+		{
+			GetWorldTimerManager().SetTimer(TimerHandle_ClockSync, this, &AVehiclePlayerController::SendClockSyncRequest, ClockSyncInterval, true);
+		}
+	}
+}
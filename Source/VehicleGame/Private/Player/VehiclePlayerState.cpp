@@ -0,0 +1,41 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Player/VehiclePlayerState.h"
+
+AVehiclePlayerState::AVehiclePlayerState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NumTrackPointsPassed = 0;
+	LastTrackPointIndex = INDEX_NONE;
+	NumLapsCompleted = 0;
+	LastTrackPointTime = 0.0f;
+	bHasFinished = false;
+	FinishTime = 0.0f;
+	RacePlace = 0;
+}
+
+void AVehiclePlayerState::ResetRaceProgress()
+{
+	NumTrackPointsPassed = 0;
+	LastTrackPointIndex = INDEX_NONE;
+	NumLapsCompleted = 0;
+	LastTrackPointTime = 0.0f;
+	bHasFinished = false;
+	FinishTime = 0.0f;
+	LapTimes.Reset();
+	RacePlace = 0;
+	ForceNetUpdate();
+}
+
+void AVehiclePlayerState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AVehiclePlayerState, NumTrackPointsPassed);
+	DOREPLIFETIME(AVehiclePlayerState, LastTrackPointIndex);
+	DOREPLIFETIME(AVehiclePlayerState, NumLapsCompleted);
+	DOREPLIFETIME(AVehiclePlayerState, bHasFinished);
+	DOREPLIFETIME(AVehiclePlayerState, FinishTime);
+	DOREPLIFETIME(AVehiclePlayerState, LapTimes);
+	DOREPLIFETIME(AVehiclePlayerState, RacePlace);
+}
@@ -0,0 +1,237 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Streaming/VehicleGridStreamer.h"
+#include "Streaming/VehicleStreamingGrid.h"
+#include "Track/VehicleRacingLine.h"
+#include "VehicleGameState.h"
+#include "Engine/LevelStreaming.h"
+#include "GameFramework/PlayerStart.h"
+
+static TAutoConsoleVariable<int32> CVarGridStreaming(
+	TEXT("vehicle.GridStreaming"),
+	1,
+	TEXT("Stream cells of split maps around racers.\n")
+	TEXT("0: load every cell, 1: stream"));
+
+static TAutoConsoleVariable<float> CVarGridStreamingRadius(
+	TEXT("vehicle.GridStreamingRadius"),
+	40000.0f,
+	TEXT("Cells closer than this to a focus point are loaded, cm"));
+
+static TAutoConsoleVariable<float> CVarGridStreamingLookAhead(
+	TEXT("vehicle.GridStreamingLookAhead"),
+	4.0f,
+	TEXT("Vehicle positions are predicted this many seconds ahead along the racing line"));
+
+static TAutoConsoleVariable<float> CVarGridStreamingInterval(
+	TEXT("vehicle.GridStreamingInterval"),
+	0.25f,
+	TEXT("Seconds between streaming updates"));
+
+static TAutoConsoleVariable<int32> CVarGridStreamingServerCollisionOnly(
+	TEXT("vehicle.GridStreamingServerCollisionOnly"),
+	1,
+	TEXT("Dedicated servers stream only colliding cells, read when the map starts.\n")
+	TEXT("0: all cells, 1: colliding cells"));
+
+static FAutoConsoleCommandWithWorld GridStreamingStatsCmd(
+	TEXT("vehicle.GridStreamingStats"),
+	TEXT("Log cell load times and memory of grid streaming"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		AVehicleGameState* GameState = World ? World->GetGameState<AVehicleGameState>() : nullptr;
+		if (GameState && GameState->GetGridStreamer())
+		{
+			GameState->GetGridStreamer()->LogStats();
+		}
+		else
+		{
+			UE_LOG(LogVehicle, Log, TEXT("Map is not grid streamed"));
+		}
+	}));
+
+FVehicleGridStreamer::FVehicleGridStreamer(UWorld* InWorld, const UVehicleStreamingGrid* InGrid, const UVehicleRacingLine* InRacingLine)
+	: World(InWorld)
+	, Grid(InGrid)
+	, RacingLine(InRacingLine && InRacingLine->HasSamples() ? InRacingLine : nullptr)
+	, LastUpdateTime(0.0)
+	, NumLoadRequests(0)
+	, NumLoadsCompleted(0)
+	, TotalLoadTime(0.0)
+	, MaxLoadTime(0.0)
+	, PeakLoadedCells(0)
+	, PeakUsedPhysical(0)
+{
+	// visual only cells have nothing a server simulates
+	const bool bCollisionOnly = World->GetNetMode() == NM_DedicatedServer && CVarGridStreamingServerCollisionOnly.GetValueOnGameThread();
+
+	TMap<FName, ULevelStreaming*> StreamingLevels;
+	for (ULevelStreaming* StreamingLevel : World->StreamingLevels)
+	{
+		if (StreamingLevel)
+		{
+			StreamingLevels.Add(FName(*UWorld::RemovePIEPrefix(StreamingLevel->GetWorldAssetPackageName())), StreamingLevel);
+		}
+	}
+
+	int32 NumStreamedCells = 0;
+	CellLevels.Reserve(Grid->Cells.Num());
+	for (const FVehicleStreamingCell& Cell : Grid->Cells)
+	{
+		ULevelStreaming* const* StreamingLevel = StreamingLevels.Find(Cell.PackageName);
+		const bool bStreamed = StreamingLevel && (Cell.bCollision || !bCollisionOnly);
+		CellLevels.Add(bStreamed ? *StreamingLevel : nullptr);
+		NumStreamedCells += bStreamed ? 1 : 0;
+	}
+	LoadRequestTimes.AddZeroed(CellLevels.Num());
+
+	UE_LOG(LogVehicle, Log, TEXT("Grid streaming %d of %d cells of %s%s"), NumStreamedCells, Grid->Cells.Num(),
+		*UWorld::RemovePIEPrefix(World->GetMapName()), bCollisionOnly ? TEXT(", colliding only") : TEXT(""));
+}
+
+void FVehicleGridStreamer::Update(bool bBlockOnLoad)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (!bBlockOnLoad && Now - LastUpdateTime < CVarGridStreamingInterval.GetValueOnGameThread())
+	{
+		return;
+	}
+	LastUpdateTime = Now;
+
+	TArray<FVector> FocusPoints;
+	GatherFocusPoints(FocusPoints);
+
+	// loaded cells are kept a bit further out, so a vehicle driving along the radius does not toggle them
+	const bool bStreaming = CVarGridStreaming.GetValueOnGameThread() != 0;
+	const float LoadRadius = CVarGridStreamingRadius.GetValueOnGameThread();
+	const float LoadRadiusSquared = FMath::Square(LoadRadius);
+	const float UnloadRadiusSquared = FMath::Square(LoadRadius + Grid->CellSize * 0.5f);
+
+	int32 NumLoadedCells = 0;
+	for (int32 CellIdx = 0; CellIdx < CellLevels.Num(); CellIdx++)
+	{
+		ULevelStreaming* StreamingLevel = CellLevels[CellIdx];
+		if (StreamingLevel == nullptr)
+		{
+			continue;
+		}
+
+		bool bWanted = !bStreaming;
+		if (bStreaming)
+		{
+			const FBox& Bounds = Grid->Cells[CellIdx].Bounds;
+			const float RadiusSquared = StreamingLevel->bShouldBeLoaded ? UnloadRadiusSquared : LoadRadiusSquared;
+			for (const FVector& FocusPoint : FocusPoints)
+			{
+				// cells cover the whole height of the map, only horizontal distance counts
+				const FVector2D Closest(FMath::Clamp(FocusPoint.X, Bounds.Min.X, Bounds.Max.X), FMath::Clamp(FocusPoint.Y, Bounds.Min.Y, Bounds.Max.Y));
+				if (FVector2D::DistSquared(Closest, FVector2D(FocusPoint)) <= RadiusSquared)
+				{
+					bWanted = true;
+					break;
+				}
+			}
+		}
+
+		if (bWanted != (bool)StreamingLevel->bShouldBeLoaded)
+		{
+			StreamingLevel->bShouldBeLoaded = bWanted;
+			StreamingLevel->bShouldBeVisible = bWanted;
+			LoadRequestTimes[CellIdx] = bWanted ? Now : 0.0;
+			NumLoadRequests += bWanted ? 1 : 0;
+		}
+
+		if (LoadRequestTimes[CellIdx] > 0.0 && StreamingLevel->IsLevelVisible())
+		{
+			const double LoadTime = Now - LoadRequestTimes[CellIdx];
+			TotalLoadTime += LoadTime;
+			MaxLoadTime = FMath::Max(MaxLoadTime, LoadTime);
+			NumLoadsCompleted++;
+			LoadRequestTimes[CellIdx] = 0.0;
+		}
+
+		NumLoadedCells += StreamingLevel->GetLoadedLevel() ? 1 : 0;
+	}
+
+	PeakLoadedCells = FMath::Max(PeakLoadedCells, NumLoadedCells);
+	PeakUsedPhysical = FMath::Max(PeakUsedPhysical, (uint64)FPlatformMemory::GetStats().UsedPhysical);
+
+	if (bBlockOnLoad)
+	{
+		World->FlushLevelStreaming();
+	}
+}
+
+void FVehicleGridStreamer::GatherFocusPoints(TArray<FVector>& OutPoints)
+{
+	// vehicles are spawned and respawned at player starts, their ground must be there before them
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		OutPoints.Add(It->GetActorLocation());
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			OutPoints.Add(ViewLocation);
+		}
+	}
+
+	const float LookAhead = CVarGridStreamingLookAhead.GetValueOnGameThread();
+	const float Step = Grid->CellSize * 0.5f;
+	// rebuilt every update so destroyed pawns drop out
+	TMap<TWeakObjectPtr<APawn>, float> NewRacingLineDistances;
+	for (FConstPawnIterator It = World->GetPawnIterator(); It; ++It)
+	{
+		APawn* Pawn = It->Get();
+		if (Pawn == nullptr || Pawn->bHidden)
+		{
+			continue;
+		}
+
+		const FVector Location = Pawn->GetActorLocation();
+		const FVector Velocity = Pawn->GetVelocity();
+		OutPoints.Add(Location);
+
+		// vehicles follow the track, so predictions walk the racing line instead of extrapolating straight
+		const float LookAheadDistance = Velocity.Size() * LookAhead;
+		if (RacingLine)
+		{
+			const float* LastDistance = RacingLineDistances.Find(Pawn);
+			const float Distance = RacingLine->FindDistance(Location, LastDistance ? *LastDistance : -1.0f);
+			NewRacingLineDistances.Add(Pawn, Distance);
+			for (float Ahead = Step; Ahead < LookAheadDistance + Step; Ahead += Step)
+			{
+				OutPoints.Add(RacingLine->GetLocationAtDistance(Distance + FMath::Min(Ahead, LookAheadDistance)));
+			}
+		}
+		else if (LookAheadDistance > 0.0f)
+		{
+			OutPoints.Add(Location + Velocity * LookAhead);
+		}
+	}
+	RacingLineDistances = MoveTemp(NewRacingLineDistances);
+}
+
+void FVehicleGridStreamer::LogStats() const
+{
+	int32 NumStreamedCells = 0;
+	int32 NumLoadedCells = 0;
+	for (ULevelStreaming* StreamingLevel : CellLevels)
+	{
+		NumStreamedCells += StreamingLevel ? 1 : 0;
+		NumLoadedCells += (StreamingLevel && StreamingLevel->GetLoadedLevel()) ? 1 : 0;
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	UE_LOG(LogVehicle, Log, TEXT("Grid streaming %s: %d of %d cells loaded, peak %d, %d loads requested, %d done in %.1f ms avg %.1f ms max, used memory %.1f MB, peak seen %.1f MB, process peak %.1f MB"),
+		*UWorld::RemovePIEPrefix(World->GetMapName()), NumLoadedCells, NumStreamedCells, PeakLoadedCells, NumLoadRequests, NumLoadsCompleted,
+		NumLoadsCompleted > 0 ? TotalLoadTime * 1000.0 / NumLoadsCompleted : 0.0, MaxLoadTime * 1000.0,
+		MemoryStats.UsedPhysical / (1024.0 * 1024.0), PeakUsedPhysical / (1024.0 * 1024.0), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+}
@@ -0,0 +1,24 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Streaming/VehiclePreloadManifest.h"
+
+UVehiclePreloadManifest::UVehiclePreloadManifest(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+}
+
+UVehiclePreloadManifest* UVehiclePreloadManifest::LoadForMap(const FString& MapName)
+{
+	const FString PackageName = GetPackageName(MapName);
+	if (!FPackageName::DoesPackageExist(PackageName))
+	{
+		return nullptr;
+	}
+
+	return LoadObject<UVehiclePreloadManifest>(nullptr, *(PackageName + TEXT(".") + FPackageName::GetShortName(PackageName)), nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+FString UVehiclePreloadManifest::GetPackageName(const FString& MapName)
+{
+	return FString::Printf(TEXT("/Game/Preload/PL_%s"), *MapName);
+}
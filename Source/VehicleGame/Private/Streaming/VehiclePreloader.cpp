@@ -0,0 +1,263 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Streaming/VehiclePreloader.h"
+#include "Streaming/VehiclePreloadManifest.h"
+#include "Engine/AssetManager.h"
+
+static TAutoConsoleVariable<int32> CVarPreload(
+	TEXT("vehicle.Preload"),
+	1,
+	TEXT("Request assets of map preload manifest while the map loads.\n")
+	TEXT("0: off, 1: on"));
+
+static TAutoConsoleVariable<float> CVarPreloadEarlyTime(
+	TEXT("vehicle.PreloadEarlyTime"),
+	15.0f,
+	TEXT("Assets first used within this many seconds after map load are requested with high priority"));
+
+static TAutoConsoleVariable<float> CVarHitchThreshold(
+	TEXT("vehicle.HitchThreshold"),
+	50.0f,
+	TEXT("Frames longer than this many ms count as hitches"));
+
+static TAutoConsoleVariable<float> CVarHitchWindow(
+	TEXT("vehicle.HitchWindow"),
+	60.0f,
+	TEXT("Seconds after map load hitches are counted for"));
+
+/** seconds between looks for newly loaded packages while recording */
+static const double PreloadCollectInterval = 0.25;
+
+TUniquePtr<FVehiclePreloader> FVehiclePreloader::Instance;
+
+void FVehiclePreloader::Initialize()
+{
+	// manifests hold client assets (effects, sounds, materials) a dedicated server never loads
+	if (!Instance.IsValid() && !IsRunningCommandlet() && !IsRunningDedicatedServer())
+	{
+		Instance = MakeUnique<FVehiclePreloader>();
+	}
+}
+
+void FVehiclePreloader::Shutdown()
+{
+	Instance.Reset();
+}
+
+FString FVehiclePreloader::GetRecordingDir(const FString& MapName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Preload") / MapName;
+}
+
+FVehiclePreloader::FVehiclePreloader()
+	: bRecordingEnabled(FParse::Param(FCommandLine::Get(), TEXT("VehiclePreloadRecord")))
+	, LastCollectTime(0.0)
+	, MapLoadTime(0.0)
+	, NumPreloadAssets(0)
+	, NumHitches(0)
+	, WorstHitchTime(0.0f)
+	, bSkipNextFrame(false)
+{
+	FCoreUObjectDelegates::PreLoadMap.AddRaw(this, &FVehiclePreloader::OnPreLoadMap);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddRaw(this, &FVehiclePreloader::OnPostLoadMap);
+	FCoreDelegates::OnPreExit.AddRaw(this, &FVehiclePreloader::OnPreExit);
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVehiclePreloader::Tick));
+}
+
+FVehiclePreloader::~FVehiclePreloader()
+{
+	FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	FCoreDelegates::OnPreExit.RemoveAll(this);
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FVehiclePreloader::OnPreLoadMap(const FString& MapURL)
+{
+	StopRecording();
+	if (!HitchMapName.IsEmpty())
+	{
+		ReportHitches();
+	}
+
+	const FURL URL(nullptr, *MapURL, TRAVEL_Absolute);
+	RequestPreload(UWorld::RemovePIEPrefix(FPackageName::GetShortName(URL.Map)));
+}
+
+void FVehiclePreloader::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (LoadedWorld == nullptr || !LoadedWorld->IsGameWorld())
+	{
+		return;
+	}
+
+	const FString MapName = UWorld::RemovePIEPrefix(LoadedWorld->GetMapName());
+	MapLoadTime = FPlatformTime::Seconds();
+
+	HitchMapName = MapName;
+	NumHitches = 0;
+	WorstHitchTime = 0.0f;
+	bSkipNextFrame = true;
+
+	if (bRecordingEnabled)
+	{
+		// everything loaded with the map is already covered by the loading screen
+		KnownPackages.Reset();
+		for (TObjectIterator<UPackage> It; It; ++It)
+		{
+			KnownPackages.Add(It->GetFName());
+		}
+
+		RecordedAssets.Reset();
+		RecordingMapName = MapName;
+		LastCollectTime = MapLoadTime;
+		UE_LOG(LogVehicle, Log, TEXT("Recording assets loaded by %s, %d packages already loaded"), *RecordingMapName, KnownPackages.Num());
+	}
+}
+
+void FVehiclePreloader::OnPreExit()
+{
+	StopRecording();
+	PreloadHandles.Empty();
+}
+
+bool FVehiclePreloader::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (!HitchMapName.IsEmpty())
+	{
+		const float FrameTime = DeltaTime * 1000.0f;
+		if (bSkipNextFrame)
+		{
+			bSkipNextFrame = false;
+		}
+		else if (FrameTime > CVarHitchThreshold.GetValueOnGameThread())
+		{
+			NumHitches++;
+			WorstHitchTime = FMath::Max(WorstHitchTime, FrameTime);
+		}
+
+		if (Now - MapLoadTime >= CVarHitchWindow.GetValueOnGameThread())
+		{
+			ReportHitches();
+		}
+	}
+
+	if (!RecordingMapName.IsEmpty() && Now - LastCollectTime >= PreloadCollectInterval)
+	{
+		LastCollectTime = Now;
+		CollectNewPackages();
+	}
+
+	return true;
+}
+
+void FVehiclePreloader::RequestPreload(const FString& MapName)
+{
+	// previous map's assets are released only after the new request holds the ones both maps use
+	TArray<TSharedPtr<FStreamableHandle>> PreviousHandles = MoveTemp(PreloadHandles);
+	NumPreloadAssets = 0;
+
+	UVehiclePreloadManifest* Manifest = CVarPreload.GetValueOnGameThread() ? UVehiclePreloadManifest::LoadForMap(MapName) : nullptr;
+	if (Manifest == nullptr || Manifest->Assets.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> EarlyAssets;
+	TArray<FSoftObjectPath> LateAssets;
+	const float EarlyTime = CVarPreloadEarlyTime.GetValueOnGameThread();
+	for (int32 AssetIdx = 0; AssetIdx < Manifest->Assets.Num(); AssetIdx++)
+	{
+		const bool bEarly = Manifest->FirstUseTimes.IsValidIndex(AssetIdx) && Manifest->FirstUseTimes[AssetIdx] <= EarlyTime;
+		(bEarly ? EarlyAssets : LateAssets).Add(Manifest->Assets[AssetIdx]);
+	}
+
+	// both lists keep manifest order, the async loader serves them in request order within a priority
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	const double StartTime = FPlatformTime::Seconds();
+	const TAsyncLoadPriority Priorities[] = { FStreamableManager::AsyncLoadHighPriority, FStreamableManager::DefaultAsyncLoadPriority };
+	TArray<FSoftObjectPath>* Lists[] = { &EarlyAssets, &LateAssets };
+	for (int32 ListIdx = 0; ListIdx < ARRAY_COUNT(Lists); ListIdx++)
+	{
+		const int32 NumAssets = Lists[ListIdx]->Num();
+		if (NumAssets == 0)
+		{
+			continue;
+		}
+
+		const TCHAR* ListName = ListIdx == 0 ? TEXT("early") : TEXT("late");
+		TSharedPtr<FStreamableHandle> Handle = Streamable.RequestAsyncLoad(*Lists[ListIdx], FStreamableDelegate::CreateLambda([MapName, ListName, NumAssets, StartTime]()
+		{
+			UE_LOG(LogVehicle, Log, TEXT("Preloaded %d %s assets of %s in %.2f s"), NumAssets, ListName, *MapName, FPlatformTime::Seconds() - StartTime);
+		}), Priorities[ListIdx]);
+
+		if (Handle.IsValid())
+		{
+			PreloadHandles.Add(Handle);
+			NumPreloadAssets += NumAssets;
+		}
+	}
+}
+
+void FVehiclePreloader::CollectNewPackages()
+{
+	const float UseTime = FPlatformTime::Seconds() - MapLoadTime;
+	for (TObjectIterator<UPackage> It; It; ++It)
+	{
+		UPackage* Package = *It;
+		bool bAlreadyKnown = false;
+		KnownPackages.Add(Package->GetFName(), &bAlreadyKnown);
+		if (bAlreadyKnown || Package->ContainsMap())
+		{
+			continue;
+		}
+
+		// only content packages can be preloaded, their main asset is named after the package
+		const FString PackageName = Package->GetName();
+		UObject* Asset = PackageName.StartsWith(TEXT("/Game/")) ? FindObject<UObject>(Package, *FPackageName::GetShortName(PackageName)) : nullptr;
+		if (Asset)
+		{
+			FRecordedAsset& Recorded = RecordedAssets[RecordedAssets.AddDefaulted()];
+			Recorded.UseTime = UseTime;
+			Recorded.Path = FSoftObjectPath(Asset);
+		}
+	}
+}
+
+void FVehiclePreloader::StopRecording()
+{
+	if (RecordingMapName.IsEmpty())
+	{
+		return;
+	}
+
+	CollectNewPackages();
+
+	FString Contents;
+	for (const FRecordedAsset& Recorded : RecordedAssets)
+	{
+		Contents += FString::Printf(TEXT("%.3f,%s") LINE_TERMINATOR, Recorded.UseTime, *Recorded.Path.ToString());
+	}
+
+	const FString Filename = GetRecordingDir(RecordingMapName) / FDateTime::Now().ToString() + TEXT(".csv");
+	const bool bSaved = FFileHelper::SaveStringToFile(Contents, *Filename);
+	UE_LOG(LogVehicle, Log, TEXT("Recorded %d assets loaded by %s over %.0f s into %s%s"), RecordedAssets.Num(), *RecordingMapName,
+		FPlatformTime::Seconds() - MapLoadTime, *Filename, bSaved ? TEXT("") : TEXT(" (failed to save)"));
+
+	RecordingMapName.Empty();
+	RecordedAssets.Empty();
+	KnownPackages.Empty();
+}
+
+void FVehiclePreloader::ReportHitches()
+{
+	const FString PreloadState = NumPreloadAssets > 0 ? FString::Printf(TEXT("%d assets preloaded"), NumPreloadAssets)
+		: CVarPreload.GetValueOnGameThread() ? FString(TEXT("no preload manifest")) : FString(TEXT("preload off"));
+	UE_LOG(LogVehicle, Log, TEXT("%s: %d hitches over %.0f ms in first %.0f s, worst %.1f ms, %s"), *HitchMapName, NumHitches,
+		CVarHitchThreshold.GetValueOnGameThread(), FMath::Min(FPlatformTime::Seconds() - MapLoadTime, (double)CVarHitchWindow.GetValueOnGameThread()),
+		WorstHitchTime, *PreloadState);
+
+	HitchMapName.Empty();
+}
@@ -0,0 +1,25 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Streaming/VehicleStreamingGrid.h"
+
+UVehicleStreamingGrid::UVehicleStreamingGrid(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	CellSize = 0.0f;
+}
+
+UVehicleStreamingGrid* UVehicleStreamingGrid::LoadForMap(const FString& MapName)
+{
+	const FString PackageName = GetPackageName(MapName);
+	if (!FPackageName::DoesPackageExist(PackageName))
+	{
+		return nullptr;
+	}
+
+	return LoadObject<UVehicleStreamingGrid>(nullptr, *(PackageName + TEXT(".") + FPackageName::GetShortName(PackageName)), nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+FString UVehicleStreamingGrid::GetPackageName(const FString& MapName)
+{
+	return FString::Printf(TEXT("/Game/StreamingGrids/SG_%s"), *MapName);
+}
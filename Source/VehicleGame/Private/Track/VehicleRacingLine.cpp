@@ -0,0 +1,108 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "Track/VehicleRacingLine.h"
+
+/** samples searched on each side of the hint by FindDistance */
+static const int32 RacingLineSearchSamples = 16;
+
+UVehicleRacingLine::UVehicleRacingLine(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	SampleSpacing = 200.0f;
+}
+
+bool UVehicleRacingLine::HasSamples() const
+{
+	return Points.Num() >= 3 && Points.Num() == TargetSpeeds.Num() && SampleSpacing > 0.0f;
+}
+
+float UVehicleRacingLine::GetLength() const
+{
+	return Points.Num() * SampleSpacing;
+}
+
+void UVehicleRacingLine::GetSampleAtDistance(float Distance, int32& OutIndex, float& OutAlpha) const
+{
+	const float Length = GetLength();
+	float WrappedDistance = FMath::Fmod(Distance, Length);
+	if (WrappedDistance < 0.0f)
+	{
+		WrappedDistance += Length;
+	}
+
+	const float SamplePosition = WrappedDistance / SampleSpacing;
+	OutIndex = FMath::Clamp(FMath::FloorToInt(SamplePosition), 0, Points.Num() - 1);
+	OutAlpha = SamplePosition - OutIndex;
+}
+
+FVector UVehicleRacingLine::GetLocationAtDistance(float Distance) const
+{
+	int32 Index = 0;
+	float Alpha = 0.0f;
+	GetSampleAtDistance(Distance, Index, Alpha);
+	return FMath::Lerp(Points[Index], Points[(Index + 1) % Points.Num()], Alpha);
+}
+
+float UVehicleRacingLine::GetTargetSpeedAtDistance(float Distance) const
+{
+	int32 Index = 0;
+	float Alpha = 0.0f;
+	GetSampleAtDistance(Distance, Index, Alpha);
+	return FMath::Lerp((float)TargetSpeeds[Index], (float)TargetSpeeds[(Index + 1) % TargetSpeeds.Num()], Alpha);
+}
+
+float UVehicleRacingLine::FindDistance(const FVector& Location, float HintDistance) const
+{
+	const int32 NumPoints = Points.Num();
+	int32 FirstIndex = 0;
+	int32 NumSearched = NumPoints;
+	if (HintDistance >= 0.0f)
+	{
+		float Alpha = 0.0f;
+		GetSampleAtDistance(HintDistance, FirstIndex, Alpha);
+		FirstIndex -= RacingLineSearchSamples;
+		NumSearched = FMath::Min(RacingLineSearchSamples * 2 + 1, NumPoints);
+	}
+
+	float BestDistSquared = MAX_flt;
+	float BestDistance = 0.0f;
+	for (int32 SearchIdx = 0; SearchIdx < NumSearched; SearchIdx++)
+	{
+		const int32 Index = ((FirstIndex + SearchIdx) % NumPoints + NumPoints) % NumPoints;
+		const FVector& SegmentStart = Points[Index];
+		const FVector Segment = Points[(Index + 1) % NumPoints] - SegmentStart;
+		const float Alpha = FMath::Clamp(((Location - SegmentStart) | Segment) / FMath::Max(Segment.SizeSquared(), KINDA_SMALL_NUMBER), 0.0f, 1.0f);
+		const float DistSquared = FVector::DistSquared(Location, SegmentStart + Segment * Alpha);
+		if (DistSquared < BestDistSquared)
+		{
+			BestDistSquared = DistSquared;
+			BestDistance = (Index + Alpha) * SampleSpacing;
+		}
+	}
+
+	// far from every searched sample, location was teleported away from the hint
+	const float SearchRadius = RacingLineSearchSamples * SampleSpacing;
+	if (NumSearched < NumPoints && BestDistSquared > FMath::Square(SearchRadius))
+	{
+		return FindDistance(Location, -1.0f);
+	}
+
+	return BestDistance;
+}
+
+UVehicleRacingLine* UVehicleRacingLine::LoadForMap(const FString& MapName)
+{
+	const FString PackageName = GetPackageName(MapName);
+	if (!FPackageName::DoesPackageExist(PackageName))
+	{
+		return nullptr;
+	}
+
+	UVehicleRacingLine* RacingLine = LoadObject<UVehicleRacingLine>(nullptr, *(PackageName + TEXT(".") + FPackageName::GetShortName(PackageName)), nullptr, LOAD_NoWarn | LOAD_Quiet);
+	return (RacingLine && RacingLine->HasSamples()) ? RacingLine : nullptr;
+}
+
+FString UVehicleRacingLine::GetPackageName(const FString& MapName)
+{
+	return FString::Printf(TEXT("/Game/RacingLines/RL_%s"), *MapName);
+}
@@ -3,6 +3,7 @@
 #include "VehicleGame.h"
 #include "Track/VehicleTrackPoint.h"
 #include "Pawns/BuggyPawn.h"
+#include "VehicleGameState.h"
 
 AVehicleTrackPoint::AVehicleTrackPoint(const FObjectInitializer& ObjectInitializer) 
 	: Super(ObjectInitializer)
@@ -10,7 +11,7 @@ AVehicleTrackPoint::AVehicleTrackPoint(const FObjectInitializer& ObjectInitializ
 	USceneComponent* SceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneComp"));
 	RootComponent = SceneComponent;
 
-	UBoxComponent* TriggerComponent = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerComp"));
+	TriggerComponent = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerComp"));
 	TriggerComponent->InitBoxExtent(FVector(50.0f, 1000.0f, 200.0f));
 	TriggerComponent->RelativeLocation.Z = 200.0f;
 	TriggerComponent->SetCollisionObjectType(COLLISION_PICKUP);
@@ -19,6 +20,9 @@ AVehicleTrackPoint::AVehicleTrackPoint(const FObjectInitializer& ObjectInitializ
 	TriggerComponent->SetCollisionResponseToChannel(ECC_Vehicle, ECR_Overlap);
 	TriggerComponent->SetupAttachment(RootComponent);
 
+	TrackPointOrder = 0;
+	bIsFinishLine = false;
+
 #if WITH_EDITORONLY_DATA
 	SpriteComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Sprite"));
 	ArrowComponent = CreateEditorOnlyDefaultSubobject<UArrowComponent>(TEXT("Arrow"));
@@ -65,13 +69,75 @@ AVehicleTrackPoint::AVehicleTrackPoint(const FObjectInitializer& ObjectInitializ
 #endif // WITH_EDITORONLY_DATA
 }
 
+void AVehicleTrackPoint::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState)
+	{
+		VehicleGameState->RegisterTrackPoint(this);
+	}
+}
+
+void AVehicleTrackPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState)
+	{
+		VehicleGameState->UnregisterTrackPoint(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AVehicleTrackPoint::NotifyActorBeginOverlap(class AActor* Other)
 {
 	Super::NotifyActorBeginOverlap(Other);
 
+	// server credits crossings from swept pawn history instead, overlaps can be missed or late at high speed
+	if (Role == ROLE_Authority)
+	{
+		return;
+	}
+
 	ABuggyPawn* OtherVehicle = Cast<ABuggyPawn>(Other);
 	if (OtherVehicle)
 	{
-		OtherVehicle->OnTrackPointReached(this);
+		OtherVehicle->OnTrackPointReached(this, GetWorld()->GetTimeSeconds());
 	}
 }
+
+bool AVehicleTrackPoint::IsBefore(const AVehicleTrackPoint& A, const AVehicleTrackPoint& B)
+{
+	// level actors have the same names on server and clients, unlike their BeginPlay order
+	if (A.TrackPointOrder != B.TrackPointOrder)
+	{
+		return A.TrackPointOrder < B.TrackPointOrder;
+	}
+	return A.GetFName().Compare(B.GetFName()) < 0;
+}
+
+bool AVehicleTrackPoint::GetSegmentCrossing(const FVector& Start, const FVector& End, float& OutAlpha) const
+{
+	const FTransform GateTransform = TriggerComponent->GetComponentTransform();
+	const FVector GateExtent = TriggerComponent->GetUnscaledBoxExtent();
+	const FVector LocalStart = GateTransform.InverseTransformPosition(Start);
+	const FVector LocalEnd = GateTransform.InverseTransformPosition(End);
+
+	// only count crossings of the gate plane in the direction of the track
+	if (LocalStart.X >= 0.0f || LocalEnd.X < 0.0f)
+	{
+		return false;
+	}
+
+	const float Alpha = -LocalStart.X / (LocalEnd.X - LocalStart.X);
+	const FVector LocalCrossing = FMath::Lerp(LocalStart, LocalEnd, Alpha);
+	if (FMath::Abs(LocalCrossing.Y) > GateExtent.Y || FMath::Abs(LocalCrossing.Z) > GateExtent.Z)
+	{
+		return false;
+	}
+
+	OutAlpha = Alpha;
+	return true;
+}
@@ -11,6 +11,7 @@ void SVehicleMenuItem::Construct(const FArguments& InArgs)
 
 	OwnerHUD = InArgs._OwnerHUD;
 	Text = InArgs._Text;
+	HighlightPulse = InArgs._HighlightPulse;
 	OnClicked = InArgs._OnClicked;
 	bIsActiveMenuItem = false;
 	//if attribute is set, use its value, otherwise uses default
@@ -82,12 +83,9 @@ FSlateColor SVehicleMenuItem::GetButtonBgColor() const
 	float BgAlpha;
 	const float MinAlpha = 0.7f;
 	const float MaxAlpha = 1.0f;
-	const float AnimSpeedModifier = 1.5f;
-	float GameTime = OwnerHUD->GetWorld()->GetRealTimeSeconds();
-	float AnimPercent = FMath::Abs(FMath::Sin(GameTime*AnimSpeedModifier));
 	if (bIsActiveMenuItem)
 	{
-		BgAlpha = FMath::Lerp(MinAlpha, MaxAlpha, AnimPercent);
+		BgAlpha = FMath::Lerp(MinAlpha, MaxAlpha, HighlightPulse.Get(1.0f));
 	} 
 	else
 	{
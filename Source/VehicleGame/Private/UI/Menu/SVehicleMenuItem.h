@@ -24,6 +24,9 @@ public:
 	/** menu item text transparency when item is not active, optional argument */
 	SLATE_ARGUMENT(TOptional<float>, InactiveTextAlpha)
 
+	/** highlight pulse of active item in 0-1 range, shared by all items of a menu */
+	SLATE_ATTRIBUTE(float, HighlightPulse)
+
 	SLATE_END_ARGS()
 
 	/** Needed for every widget */
@@ -53,6 +56,9 @@ private:
 	/** menu item text attribute */
 	TAttribute< FText > Text;
 
+	/** highlight pulse attribute */
+	TAttribute< float > HighlightPulse;
+
 	/** getter for menu item background color */
 	FSlateColor GetButtonBgColor() const;
 
@@ -78,13 +78,13 @@ void SVehicleMenuWidget::Construct(const FArguments& InArgs)
 						.AutoWidth()
 						.Padding(TAttribute<FMargin>(this,&SVehicleMenuWidget::GetLeftMenuOffset))
 						[
-							SAssignNew(LeftBox, SVerticalBox)
+							SAssignNew(LeftBox, SBox)
 						]
 						+ SHorizontalBox::Slot()
 						.AutoWidth()
 						.Padding(TAttribute<FMargin>(this,&SVehicleMenuWidget::GetSubMenuOffset))
 						[
-							SAssignNew(RightBox, SVerticalBox)
+							SAssignNew(RightBox, SBox)
 						]
 					]
 				]
@@ -92,6 +92,10 @@ void SVehicleMenuWidget::Construct(const FArguments& InArgs)
 			
 		]
 	];
+
+	// |sin| pulse of all active items, one period is PI / 1.5 seconds
+	HighlightCurve = HighlightAnimation.AddCurve(0.0f, PI / 1.5f, ECurveEaseFunction::Linear);
+	HighlightAnimation.Play(this->AsShared(), true);
 }
 
 void SVehicleMenuWidget::BuildAndShowMenu()
@@ -178,7 +182,6 @@ void SVehicleMenuWidget::BuildLeftPanel(bool bInGoingBack)
 		//do not build anything if we do not have any active menu
 		return;
 	}
-	LeftBox->ClearChildren();
 	if (bLeftMenuChanging)
 	{
 		if (bInGoingBack && MenuHistory.Num() > 0)
@@ -197,25 +200,15 @@ void SVehicleMenuWidget::BuildLeftPanel(bool bInGoingBack)
 		}
 	}
 
-	//Setup the buttons
-	for(int32 i = 0; i < (*CurrentMenu).Num(); ++i)
+	LeftBox->SetContent(GetLeftPanel(CurrentMenu));
+
+	// reused item widgets keep selection from the last visit
+	for (FVehicleMenuItem& MenuItem : *CurrentMenu)
 	{
-		TSharedPtr<SWidget> TmpWidget;
-		if ((*CurrentMenu)[i].MenuItemType == EVehicleMenuItemType::Standard)
+		if (MenuItem.Widget.IsValid())
 		{
-			TmpWidget = SAssignNew((*CurrentMenu)[i].Widget, SVehicleMenuItem)
-				.OwnerHUD(MyMenuHUD)
-				.OnClicked(this, &SVehicleMenuWidget::ButtonClicked, i)
-				.Text(this, &SVehicleMenuWidget::GetMenuItemText, i );
-		} 
-		else if ((*CurrentMenu)[i].MenuItemType == EVehicleMenuItemType::CustomWidget)
-		{
-			TmpWidget = (*CurrentMenu)[i].CustomWidget;
+			MenuItem.Widget->SetMenuItemActive(false);
 		}
-		LeftBox->AddSlot()	.HAlign(HAlign_Left)	.AutoHeight()
-		[
-			TmpWidget.ToSharedRef()
-		];
 	}
 	
 	SelectedIndex = 0;
@@ -230,28 +223,84 @@ void SVehicleMenuWidget::BuildLeftPanel(bool bInGoingBack)
 
 void SVehicleMenuWidget::BuildRightPanel()
 {
-	RightBox->ClearChildren();
-	
-	if (!NextMenu.IsValid() || (*NextMenu).Num() == 0) return;
+	if (!NextMenu.IsValid() || (*NextMenu).Num() == 0)
+	{
+		RightBox->SetContent(SNullWidget::NullWidget);
+		return;
+	}
+
+	RightBox->SetContent(GetRightPanel(NextMenu));
+}
 
-	for(int32 i = 0; i < (*NextMenu).Num(); ++i)
+TSharedRef<SWidget> SVehicleMenuWidget::GetLeftPanel(const MenuPtr& Menu)
+{
+	const FCachedMenuPanel* CachedPanel = LeftPanelCache.Find(Menu.Get());
+	if (CachedPanel && CachedPanel->Menu.Pin() == Menu)
 	{
-		//Only standard menu items supported in right panel
-		if ((*NextMenu)[i].MenuItemType == EVehicleMenuItemType::Standard)
+		return CachedPanel->Panel.ToSharedRef();
+	}
+
+	TSharedRef<SVerticalBox> Panel = SNew(SVerticalBox);
+
+	//Setup the buttons
+	for(int32 i = 0; i < (*Menu).Num(); ++i)
+	{
+		TSharedPtr<SWidget> TmpWidget;
+		if ((*Menu)[i].MenuItemType == EVehicleMenuItemType::Standard)
 		{
-			TSharedPtr<SVehicleMenuItem> TmpButton;
-			TmpButton = SAssignNew((*NextMenu)[i].Widget, SVehicleMenuItem)
+			TmpWidget = SAssignNew((*Menu)[i].Widget, SVehicleMenuItem)
 				.OwnerHUD(MyMenuHUD)
-				.Text((*NextMenu)[i].Text)
-				.InactiveTextAlpha(0.3f);
-			RightBox->AddSlot()
+				.OnClicked(this, &SVehicleMenuWidget::ButtonClicked, i)
+				.Text(this, &SVehicleMenuWidget::GetMenuItemText, i )
+				.HighlightPulse(this, &SVehicleMenuWidget::GetHighlightPulse);
+		} 
+		else if ((*Menu)[i].MenuItemType == EVehicleMenuItemType::CustomWidget)
+		{
+			TmpWidget = (*Menu)[i].CustomWidget;
+		}
+		Panel->AddSlot()	.HAlign(HAlign_Left)	.AutoHeight()
+		[
+			TmpWidget.ToSharedRef()
+		];
+	}
+
+	FCachedMenuPanel& NewPanel = LeftPanelCache.Add(Menu.Get());
+	NewPanel.Menu = Menu;
+	NewPanel.Panel = Panel;
+	return Panel;
+}
+
+TSharedRef<SWidget> SVehicleMenuWidget::GetRightPanel(const MenuPtr& Menu)
+{
+	const FCachedMenuPanel* CachedPanel = RightPanelCache.Find(Menu.Get());
+	if (CachedPanel && CachedPanel->Menu.Pin() == Menu)
+	{
+		return CachedPanel->Panel.ToSharedRef();
+	}
+
+	TSharedRef<SVerticalBox> Panel = SNew(SVerticalBox);
+
+	for(int32 i = 0; i < (*Menu).Num(); ++i)
+	{
+		//Only standard menu items supported in right panel
+		if ((*Menu)[i].MenuItemType == EVehicleMenuItemType::Standard)
+		{
+			Panel->AddSlot()
 				.HAlign(HAlign_Center)
 				.AutoHeight()
 				[
-					TmpButton.ToSharedRef()
+					SNew(SVehicleMenuItem)
+					.OwnerHUD(MyMenuHUD)
+					.Text(this, &SVehicleMenuWidget::GetSubMenuItemText, (const TArray<FVehicleMenuItem>*)Menu.Get(), i)
+					.InactiveTextAlpha(0.3f)
 				];
 		}
 	}
+
+	FCachedMenuPanel& NewPanel = RightPanelCache.Add(Menu.Get());
+	NewPanel.Menu = Menu;
+	NewPanel.Panel = Panel;
+	return Panel;
 }
 
 FText SVehicleMenuWidget::GetMenuItemText(int32 Index) const
@@ -259,6 +308,16 @@ FText SVehicleMenuWidget::GetMenuItemText(int32 Index) const
 	return (*CurrentMenu)[Index].Text;
 }
 
+FText SVehicleMenuWidget::GetSubMenuItemText(const TArray<FVehicleMenuItem>* Menu, int32 Index) const
+{
+	return Menu->IsValidIndex(Index) ? (*Menu)[Index].Text : FText::GetEmpty();
+}
+
+float SVehicleMenuWidget::GetHighlightPulse() const
+{
+	return FMath::Abs(FMath::Sin(HighlightCurve.GetLerp() * PI));
+}
+
 void SVehicleMenuWidget::EnterSubMenu()
 {
 	bLeftMenuChanging = true;
@@ -121,6 +121,18 @@ private:
 	/** gets menu item text */
 	FText GetMenuItemText(int32 Index) const;
 
+	/** gets text of item in sub menu preview */
+	FText GetSubMenuItemText(const TArray<class FVehicleMenuItem>* Menu, int32 Index) const;
+
+	/** gets highlight pulse shared by all active menu items */
+	float GetHighlightPulse() const;
+
+	/** gets cached panel of menu as current one, built on first use */
+	TSharedRef<SWidget> GetLeftPanel(const MenuPtr& Menu);
+
+	/** gets cached panel of menu as sub menu preview, built on first use */
+	TSharedRef<SWidget> GetRightPanel(const MenuPtr& Menu);
+
 	/** this function starts the entire fade in process */
 	void FadeIn();
 
@@ -151,6 +163,12 @@ private:
 	/** current menu transition animation curve */
 	FCurveHandle LeftMenuScrollOutCurve;
 
+	/** active menu item highlight animation, looping */
+	FCurveSequence HighlightAnimation;
+
+	/** active menu item highlight curve */
+	FCurveHandle HighlightCurve;
+
 	/** weak pointer to our parent HUD */
 	TWeakObjectPtr<class AHUD> MyMenuHUD;
 
@@ -175,11 +193,27 @@ private:
 	/** menu that will override current one after transition animation */
 	TSharedPtr< TArray<class FVehicleMenuItem> > PendingLeftMenu;
 
-	/** left(current) menu layout box */
-	TSharedPtr<SVerticalBox> LeftBox;
+	/** left(current) menu layout box, shows cached panel of current menu */
+	TSharedPtr<SBox> LeftBox;
+
+	/** right(sub) menu layout box, shows cached panel of next menu */
+	TSharedPtr<SBox> RightBox;
+
+	/** menu panel kept between navigations */
+	struct FCachedMenuPanel
+	{
+		/** menu the panel was built for, detects menus freed and reallocated at same address */
+		TWeakPtr< TArray<class FVehicleMenuItem> > Menu;
+
+		/** panel with item widgets */
+		TSharedPtr<SWidget> Panel;
+	};
+
+	/** current menu panels by menu */
+	TMap<const TArray<class FVehicleMenuItem>*, FCachedMenuPanel> LeftPanelCache;
 
-	/** right(sub) menu layout box */
-	TSharedPtr<SVerticalBox> RightBox;
+	/** sub menu preview panels by menu */
+	TMap<const TArray<class FVehicleMenuItem>*, FCachedMenuPanel> RightPanelCache;
 
 	/** style for this menu */
 	const struct FVehicleMenuStyle *MenuStyle;
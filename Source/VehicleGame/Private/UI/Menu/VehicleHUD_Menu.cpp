@@ -32,14 +32,14 @@ void AVehicleHUD_Menu::PlaySolo()
 {
 	GEngine->SetClientTravel(GetWorld(), TEXT("/Game/Maps/VehicleEntry"), TRAVEL_Absolute);
 	FSlateApplication::Get().SetAllUserFocusToGameViewport();
-	ShowLoadingScreen();
+	ShowLoadingScreen(TEXT("/Game/Maps/VehicleEntry"));
 }
 
 void AVehicleHUD_Menu::HostLocal()
 {
 	GEngine->SetClientTravel(GetWorld(), TEXT("/Game/Maps/VehicleEntry?listen"), TRAVEL_Absolute);
 	FSlateApplication::Get().SetAllUserFocusToGameViewport();
-	ShowLoadingScreen();
+	ShowLoadingScreen(TEXT("/Game/Maps/VehicleEntry"));
 }
 
 void AVehicleHUD_Menu::Quit()
@@ -47,10 +47,10 @@ void AVehicleHUD_Menu::Quit()
 	GetOwningPlayerController()->ConsoleCommand("quit");
 }
 
-void AVehicleHUD_Menu::ShowLoadingScreen()
+void AVehicleHUD_Menu::ShowLoadingScreen(const FString& MapPackageName)
 {
 	IVehicleGameLoadingScreenModule* LoadingScreenModule = FModuleManager::LoadModulePtr<IVehicleGameLoadingScreenModule>("VehicleGameLoadingScreen");
-	LoadingScreenModule->StartInGameLoadingScreen();
+	LoadingScreenModule->StartInGameLoadingScreen(MapPackageName);
 }
 
 void AVehicleHUD_Menu::ExecuteMenuAction(EVehicleMenu::Type Action)
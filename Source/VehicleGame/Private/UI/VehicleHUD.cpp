@@ -10,58 +10,136 @@
 #include "VehicleMenuSoundsWidgetStyle.h"
 #include "VehicleGameUserSettings.h"
 #include "VehicleGameMode.h"
+#include "VehicleGameState.h"
+#include "Player/VehiclePlayerState.h"
+#include "Pawns/BuggyPawn.h"
+#include "Leaderboard/VehicleLeaderboard.h"
+#include "Engine/AssetManager.h"
 
 #define LOCTEXT_NAMESPACE "VehicleGame.HUD.Menu"
 
+DECLARE_CYCLE_STAT(TEXT("HUD draw"), STAT_HUDDraw, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("HUD build widgets"), STAT_HUDBuildWidgets, STATGROUP_VehicleGame);
+
 AVehicleHUD::AVehicleHUD(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
-	static ConstructorHelpers::FObjectFinder<UMaterialInstanceConstant> SpeedMeterObj(TEXT("/Game/UI/HUD/Materials/M_VH_HUD_SpeedMeter_UI"));
-
-	static ConstructorHelpers::FObjectFinder<UFont> HUDFontOb(TEXT("/Game/UI/HUD/UI_Vehicle_Font"));
-
-	static ConstructorHelpers::FObjectFinder<UTexture2D> TimerBgObj(TEXT("/Game/UI/HUD/Background/T_VH_Hud_Timer_Background"));
-	static ConstructorHelpers::FObjectFinder<UTexture2D> PlaceBgObj(TEXT("/Game/UI/HUD/Background/T_VH_Hud_Place_Background"));
+	// soft references, loaded in BeginPlay so servers and CDO creation never touch them
+	MinimapRacerIcon = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/UI/HUD/Materials/T_VH_Hud_Map_Point_01.T_VH_Hud_Map_Point_01")));
+	MinimapCheckpointIcon = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/UI/HUD/Materials/T_VH_Hud_Map_Point_02.T_VH_Hud_Map_Point_02")));
 
+	LowHighList.Add(LOCTEXT("LowQuality","LOW QUALITY"));
+	LowHighList.Add(LOCTEXT("HighQuality","HIGH QUALITY"));
 
-	static ConstructorHelpers::FObjectFinder<UTexture2D> UpButtonTextureOb(TEXT("/Game/UI/HUD/UpButton"));
-	static ConstructorHelpers::FObjectFinder<UTexture2D> DownButtonTextureOb(TEXT("/Game/UI/HUD/DownButton"));
+	UIScale = 1.0f;
 
-	UpButtonTexture = UpButtonTextureOb.Object;
-	DownButtonTexture = DownButtonTextureOb.Object;
+	bLeaderboardSubmitPending = false;
+	bDrawHUD = true;
+	bIsGameMenuUp = false;
+	QualityMenuItem = nullptr;
 
-	HUDFont = HUDFontOb.Object;
+	CountdownSound = nullptr;
+	RaceStartSound = nullptr;
+	CheckpointSound = nullptr;
+	LapSound = nullptr;
+	FinishSound = nullptr;
+}
 
-	TimerBackground = TimerBgObj.Object;
-	PlaceBackground = PlaceBgObj.Object;
-	
-	SpeedMeterMaterialConst = SpeedMeterObj.Object;
 
+void AVehicleHUD::BeginPlay()
+{
+	Super::BeginPlay();
 
-	LowHighList.Add(LOCTEXT("LowQuality","LOW QUALITY"));
-	LowHighList.Add(LOCTEXT("HighQuality","HIGH QUALITY"));
+	LoadHUDAssets();
+	BuildHUDWidget();
+	BindRaceEvents();
+}
 
-	UIScale = 1.0f;
+void AVehicleHUD::LoadHUDAssets()
+{
+	TArray<FSoftObjectPath> AssetPaths;
+	AssetPaths.Add(MinimapRacerIcon.ToSoftObjectPath());
+	AssetPaths.Add(MinimapCheckpointIcon.ToSoftObjectPath());
 
-	CurrentLetter = 0;
-	bEnterNamePromptActive = false;
-	bDrawHUD = true;
+	HUDAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetPaths, FStreamableDelegate::CreateUObject(this, &AVehicleHUD::OnHUDAssetsLoaded), FStreamableManager::AsyncLoadHighPriority);
 }
 
+void AVehicleHUD::OnHUDAssetsLoaded()
+{
+	Minimap.RacerIcon = MinimapRacerIcon.Get();
+	Minimap.CheckpointIcon = MinimapCheckpointIcon.Get();
+}
 
-void AVehicleHUD::BeginPlay()
+void AVehicleHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	SpeedMeterMaterial = UMaterialInstanceDynamic::Create(SpeedMeterMaterialConst, nullptr);
+	if (RaceEventSource.IsValid())
+	{
+		RaceEventSource->OnRaceEvent.Remove(RaceEventHandle);
+	}
+	RaceEventSource = nullptr;
+
+	UVehicleGameUserSettings* UserSettings = GEngine ? Cast<UVehicleGameUserSettings>(GEngine->GetGameUserSettings()) : nullptr;
+	if (UserSettings)
+	{
+		UserSettings->OnGraphicsQualityChanged.Remove(QualityChangedHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AVehicleHUD::DrawHUD()
 {
+	SCOPE_CYCLE_COUNTER(STAT_HUDDraw);
+
 	Super::DrawHUD();
-	BuildMenuWidgets();
-	if (GetNetMode() != NM_Standalone)
+	UpdateHUDWidget();
+
+	AVehicleGameState* VehicleGameState = RaceEventSource.Get();
+	if (VehicleGameState)
 	{
-		FString NetModeDesc = (GetNetMode() == NM_Client) ? TEXT("Client") : TEXT("Server");
-		DrawDebugInfoString(NetModeDesc, 256.0f,32.0f, true, true, FColor::White);
+		VehicleGameState->UpdateRacerProgress();
+		Minimap.Draw(Canvas, VehicleGameState, PlayerOwner ? PlayerOwner->PlayerState : nullptr);
 	}
+
+	// finish event can replicate before lap times and finish time of player state
+	const AVehiclePlayerState* MyPlayerState = PlayerOwner ? Cast<AVehiclePlayerState>(PlayerOwner->PlayerState) : nullptr;
+	if (bLeaderboardSubmitPending && MyPlayerState && MyPlayerState->bHasFinished)
+	{
+		bLeaderboardSubmitPending = false;
+		SubmitLeaderboardTimes(MyPlayerState->PlayerName);
+	}
+#if !UE_BUILD_SHIPPING
+	const ENetMode NetMode = GetNetMode();
+	if (NetMode != NM_Standalone)
+	{
+		DrawDebugInfoString(NetMode == NM_Client ? TEXT("Client") : TEXT("Server"), 256.0f,32.0f, true, true, FColor::White);
+	}
+#endif
+}
+
+void AVehicleHUD::UpdateHUDWidget()
+{
+	if (!VehicleHUDWidget.IsValid())
+	{
+		return;
+	}
+
+	const AVehicleGameState* VehicleGameState = RaceEventSource.Get();
+	const AVehiclePlayerState* MyPlayerState = PlayerOwner ? Cast<AVehiclePlayerState>(PlayerOwner->PlayerState) : nullptr;
+	const ABuggyPawn* MyPawn = PlayerOwner ? Cast<ABuggyPawn>(PlayerOwner->GetPawn()) : nullptr;
+
+	float RaceTime = -1.0f;
+	if (MyPlayerState && MyPlayerState->bHasFinished)
+	{
+		RaceTime = MyPlayerState->FinishTime;
+	}
+	else if (VehicleGameState && VehicleGameState->bIsRaceActive)
+	{
+		RaceTime = VehicleGameState->TotalTime;
+	}
+
+	VehicleHUDWidget->SetRaceTime(RaceTime);
+	VehicleHUDWidget->SetSpeed(MyPawn ? MyPawn->GetVehicleSpeed() : -1.0f);
+	VehicleHUDWidget->SetPlace(MyPlayerState ? MyPlayerState->RacePlace : 0, VehicleGameState ? VehicleGameState->NumRacers : 0);
 }
 
 void AVehicleHUD::DrawDebugInfoString(const FString& Text, float PosX, float PosY, bool bAlignLeft, bool bAlignTop, const FColor& TextColor)
@@ -86,70 +164,75 @@ void AVehicleHUD::DrawDebugInfoString(const FString& Text, float PosX, float Pos
 #endif
 }
 
-void AVehicleHUD::NotifyHitBoxClick(FName BoxName)
+void AVehicleHUD::SubmitLeaderboardTimes(const FString& RacerName)
 {
-	Super::NotifyHitBoxClick(BoxName);
-
-	if (BoxName.GetPlainNameString() == "Letter")
-	{
-		CurrentLetter = BoxName.GetNumber();
-	}
-	if (BoxName == "Up")
+	AVehiclePlayerState* PlayerState = PlayerOwner ? Cast<AVehiclePlayerState>(PlayerOwner->PlayerState) : nullptr;
+	AGameStateBase* const GameState = GetWorld()->GetGameState();
+	if (PlayerState == nullptr || !PlayerState->bHasFinished || GameState == nullptr || GameState->GameModeClass == nullptr)
 	{
-		if (HighScoreName[CurrentLetter] < 'Z')
-		{
-			HighScoreName[CurrentLetter]++;
-		}
+		return;
 	}
-	if (BoxName == "Down")
+
+	const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	const FString ModeName = GameState->GameModeClass->GetName();
+	FVehicleLeaderboardStore& Leaderboard = FVehicleLeaderboardStore::Get();
+
+	const FString LapBoard = FVehicleLeaderboardStore::GetBoardName(MapName, ModeName, EVehicleLeaderboard::Lap);
+	for (float LapTime : PlayerState->LapTimes)
 	{
-		if (HighScoreName[CurrentLetter] > 'A')
-		{
-			HighScoreName[CurrentLetter]--;
-		}
+		Leaderboard.SubmitTime(LapBoard, RacerName, LapTime);
 	}
-	if (BoxName == "OK")
-	{
-		bEnterNamePromptActive = false;
-		if (PlayerOwner)
-		{
-			PlayerOwner->bShowMouseCursor = bEnterNamePromptActive;
-		}
 
-		FString EnteredName = FString();
-		for (int32 i=0; i < HighScoreName.Num(); i++)
-		{
-			EnteredName.AppendChar(HighScoreName[i]);
-		}
-	}
+	Leaderboard.SubmitTime(FVehicleLeaderboardStore::GetBoardName(MapName, ModeName, EVehicleLeaderboard::Race), RacerName, PlayerState->FinishTime);
 }
 
 
-void AVehicleHUD::BuildMenuWidgets()
+void AVehicleHUD::BuildHUDWidget()
 {
-	if (!GEngine || !GEngine->GameViewport)
+	SCOPE_CYCLE_COUNTER(STAT_HUDBuildWidgets);
+
+	if (!GEngine || !GEngine->GameViewport || VehicleHUDWidget.IsValid())
 	{
 		return;
 	}
-	int32 CurrentQuality = 1;
-	UVehicleGameUserSettings* UserSettings = nullptr;
 
-	UserSettings = CastChecked<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
-	if (UserSettings)
+	UVehicleGameUserSettings* UserSettings = Cast<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
+	if (UserSettings && !QualityChangedHandle.IsValid())
 	{
-		CurrentQuality = UserSettings->GetGraphicsQuality();
+		QualityChangedHandle = UserSettings->OnGraphicsQualityChanged.AddUObject(this, &AVehicleHUD::OnGraphicsQualityChanged);
 	}
 
-	if (!VehicleHUDWidget.IsValid())
-	{
-		SAssignNew(VehicleHUDWidget, SVehicleHUDWidget)
-		.OwnerWorld(GetWorld());
+	SAssignNew(VehicleHUDWidget, SVehicleHUDWidget)
+	.OwnerWorld(GetWorld());
 
+	// in split-screen every player's widget covers only their own view
+	ULocalPlayer* LocalPlayer = PlayerOwner ? PlayerOwner->GetLocalPlayer() : nullptr;
+	if (LocalPlayer)
+	{
+		GEngine->GameViewport->AddViewportWidgetForPlayer(LocalPlayer, SNew(SWeakWidget).PossiblyNullContent(VehicleHUDWidget.ToSharedRef()), 0);
+	}
+	else
+	{
 		GEngine->GameViewport->AddViewportWidgetContent(
 			SNew(SWeakWidget)
 			.PossiblyNullContent(VehicleHUDWidget.ToSharedRef())
 			);
+	}
+}
 
+void AVehicleHUD::BuildMenuWidgets()
+{
+	SCOPE_CYCLE_COUNTER(STAT_HUDBuildWidgets);
+
+	if (!GEngine || !GEngine->GameViewport || MyHUDMenuWidget.IsValid())
+	{
+		return;
+	}
+	int32 CurrentQuality = 1;
+	UVehicleGameUserSettings* UserSettings = Cast<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
+	if (UserSettings)
+	{
+		CurrentQuality = UserSettings->GetGraphicsQuality();
 	}
 
 	if (!MyHUDMenuWidget.IsValid())
@@ -182,6 +265,78 @@ void AVehicleHUD::BuildMenuWidgets()
 	}
 }
 
+void AVehicleHUD::BindRaceEvents()
+{
+	if (RaceEventSource.IsValid() || !VehicleHUDWidget.IsValid())
+	{
+		return;
+	}
+
+	AVehicleGameState* VehicleGameState = GetWorld()->GetGameState<AVehicleGameState>();
+	if (VehicleGameState)
+	{
+		RaceEventSource = VehicleGameState;
+		RaceEventHandle = VehicleGameState->OnRaceEvent.AddUObject(this, &AVehicleHUD::OnRaceEvent);
+		VehicleHUDWidget->SetInfoText(VehicleGameState->GetGameInfoText());
+	}
+}
+
+void AVehicleHUD::OnGraphicsQualityChanged()
+{
+	UVehicleGameUserSettings* UserSettings = Cast<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
+	if (UserSettings && QualityMenuItem && LowHighList.IsValidIndex(UserSettings->GetGraphicsQuality()))
+	{
+		QualityMenuItem->Text = LowHighList[UserSettings->GetGraphicsQuality()];
+	}
+}
+
+void AVehicleHUD::OnRaceEvent(const FVehicleRaceEvent& Event)
+{
+	const bool bOwnEvent = PlayerOwner && Event.Racer && Event.Racer == PlayerOwner->PlayerState;
+	USoundBase* Sound = nullptr;
+
+	switch (Event.Type)
+	{
+	case EVehicleRaceEvent::InfoText:
+		// text of an old event may be gone already, show current one instead
+		if (VehicleHUDWidget.IsValid())
+		{
+			VehicleHUDWidget->SetInfoText(Event.bIsHistory && RaceEventSource.IsValid() ? RaceEventSource->GetGameInfoText() : Event.Text);
+		}
+		break;
+	case EVehicleRaceEvent::Countdown:
+		Sound = CountdownSound;
+		break;
+	case EVehicleRaceEvent::RaceStart:
+		Sound = RaceStartSound;
+		break;
+	case EVehicleRaceEvent::Checkpoint:
+		Sound = bOwnEvent ? CheckpointSound : nullptr;
+		break;
+	case EVehicleRaceEvent::Lap:
+		Sound = bOwnEvent ? LapSound : nullptr;
+		break;
+	case EVehicleRaceEvent::Finish:
+		Sound = bOwnEvent ? FinishSound : nullptr;
+		if (bOwnEvent && !Event.bIsHistory)
+		{
+			bLeaderboardSubmitPending = true;
+		}
+		break;
+	case EVehicleRaceEvent::RaceReset:
+		bLeaderboardSubmitPending = false;
+		break;
+	default:
+		break;
+	}
+
+	// old events are not heard, they happened before we joined
+	if (Sound && !Event.bIsHistory)
+	{
+		UGameplayStatics::PlaySound2D(this, Sound);
+	}
+}
+
 void AVehicleHUD::DetachGameMenu()
 {
 	if (GEngine && GEngine->GameViewport)
@@ -205,6 +360,8 @@ void AVehicleHUD::EnableHUD(bool bEnable)
 
 void AVehicleHUD::ToggleGameMenu()
 {
+	// most players never open the menu, with split-screen only one of them does
+	BuildMenuWidgets();
 	if (!MyHUDMenuWidget.IsValid())
 	{
 		return;
@@ -242,7 +399,17 @@ void AVehicleHUD::ToggleGameMenu()
 
 void AVehicleHUD::RestartTrack()
 {
-	GetOwningPlayerController()->RestartLevel();
+	// race is reset in place, reloading the map would throw away everything streamed in and warmed up
+	AVehicleGameMode* const MyGame = GetWorld()->GetAuthGameMode<AVehicleGameMode>();
+	if (MyGame)
+	{
+		MyGame->ResetRace();
+		MyGame->SetGamePaused(false);
+	}
+	else
+	{
+		GetOwningPlayerController()->RestartLevel();
+	}
 	FSlateApplication::Get().SetAllUserFocusToGameViewport();
 }
 
@@ -304,7 +471,6 @@ void AVehicleHUD::ExecuteMenuAction(EVehicleGameMenu::Type Action)
 		{
 			FSlateApplication::Get().PlaySound(MenuSounds.AcceptChangesSound);
 			UserSettings->SetGraphicsQuality(NewQuality);
-			QualityMenuItem->Text = LowHighList[NewQuality];
 			UserSettings->ApplySettings(false);
 		}
 		break;
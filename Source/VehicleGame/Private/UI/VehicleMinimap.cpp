@@ -0,0 +1,235 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "UI/VehicleMinimap.h"
+#include "VehicleGameState.h"
+#include "Player/VehiclePlayerState.h"
+#include "Track/VehicleTrackPoint.h"
+#include "Ghost/VehicleGhostManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("HUD minimap"), STAT_HUDMinimap, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Minimap icons"), STAT_NumMinimapIcons, STATGROUP_VehicleGame);
+
+static TAutoConsoleVariable<int32> CVarMinimapTestIcons(
+	TEXT("vehicle.MinimapTestIcons"),
+	0,
+	TEXT("Number of fake racer icons circling the minimap, for profiling icon batching."),
+	ECVF_Cheat);
+
+/** racers and ghosts leaving fallback bounds grow them by this much more, cm */
+static const float FallbackBoundsMargin = 5000.0f;
+
+FVehicleMinimap::FVehicleMinimap()
+	: RacerIcon(nullptr)
+	, CheckpointIcon(nullptr)
+	, MapSize(256.0f)
+	, IconSize(16.0f)
+	, ScreenMargin(32.0f)
+	, MapCenter(FVector2D::ZeroVector)
+	, WorldCenter(FVector2D::ZeroVector)
+	, WorldToCanvasScale(0.0f)
+	, CachedCanvasSize(FVector2D::ZeroVector)
+	, CachedNumTrackPoints(0)
+	, CachedNextTrackPoint(INDEX_NONE)
+	, FallbackBounds(ForceInit)
+	, bFallbackBoundsChanged(false)
+{
+}
+
+bool FVehicleMinimap::UpdateTransform(UCanvas* Canvas, const AVehicleGameState* GameState)
+{
+	const TArray<AVehicleTrackPoint*>& TrackPoints = GameState->GetTrackPoints();
+	const FVector2D CanvasSize(Canvas->ClipX, Canvas->ClipY);
+	const bool bUseFallbackBounds = TrackPoints.Num() == 0;
+	if (TrackPoints.Num() == CachedNumTrackPoints && CanvasSize == CachedCanvasSize && !(bUseFallbackBounds && bFallbackBoundsChanged))
+	{
+		return WorldToCanvasScale > 0.0f;
+	}
+
+	CachedNumTrackPoints = TrackPoints.Num();
+	CachedCanvasSize = CanvasSize;
+	CachedNextTrackPoint = INDEX_NONE;
+	CheckpointTriangles.Reset();
+	bFallbackBoundsChanged = false;
+
+	FBox2D WorldBounds = bUseFallbackBounds ? FallbackBounds : FBox2D(ForceInit);
+	for (const AVehicleTrackPoint* TrackPoint : TrackPoints)
+	{
+		WorldBounds += FVector2D(TrackPoint->GetActorLocation());
+	}
+	if (!WorldBounds.bIsValid)
+	{
+		WorldToCanvasScale = 0.0f;
+		return false;
+	}
+
+	const float ScreenScale = CanvasSize.Y / 1080.0f;
+	const float MapExtent = MapSize * 0.5f * ScreenScale;
+	const FVector2D WorldExtent = WorldBounds.GetExtent();
+
+	// keep icons inside the map frame
+	const float UsableExtent = FMath::Max(MapExtent - IconSize * ScreenScale, 1.0f);
+	MapCenter = FVector2D(CanvasSize.X - ScreenMargin * ScreenScale - MapExtent, CanvasSize.Y - ScreenMargin * ScreenScale - MapExtent);
+	WorldCenter = WorldBounds.GetCenter();
+	WorldToCanvasScale = UsableExtent / FMath::Max(FMath::Max(WorldExtent.X, WorldExtent.Y), 1.0f);
+	return true;
+}
+
+void FVehicleMinimap::GrowFallbackBounds(const FVector& Location)
+{
+	const FVector2D Location2D(Location);
+	if (!FallbackBounds.bIsValid || !FallbackBounds.IsInside(Location2D))
+	{
+		FallbackBounds += Location2D;
+		FallbackBounds = FallbackBounds.ExpandBy(FallbackBoundsMargin);
+		bFallbackBoundsChanged = true;
+	}
+}
+
+void FVehicleMinimap::AddIcon(TArray<FCanvasUVTri>& Triangles, const FVector2D& Center, float HalfSize, const FLinearColor& Color)
+{
+	const FVector2D TopLeft = Center - FVector2D(HalfSize, HalfSize);
+	const FVector2D BottomRight = Center + FVector2D(HalfSize, HalfSize);
+	const FVector2D TopRight(BottomRight.X, TopLeft.Y);
+	const FVector2D BottomLeft(TopLeft.X, BottomRight.Y);
+
+	FCanvasUVTri Tri;
+	Tri.V0_Color = Tri.V1_Color = Tri.V2_Color = Color;
+
+	Tri.V0_Pos = TopLeft;		Tri.V0_UV = FVector2D(0.0f, 0.0f);
+	Tri.V1_Pos = TopRight;		Tri.V1_UV = FVector2D(1.0f, 0.0f);
+	Tri.V2_Pos = BottomRight;	Tri.V2_UV = FVector2D(1.0f, 1.0f);
+	Triangles.Add(Tri);
+
+	Tri.V1_Pos = BottomRight;	Tri.V1_UV = FVector2D(1.0f, 1.0f);
+	Tri.V2_Pos = BottomLeft;	Tri.V2_UV = FVector2D(0.0f, 1.0f);
+	Triangles.Add(Tri);
+}
+
+void FVehicleMinimap::DrawIcons(UCanvas* Canvas, const TArray<FCanvasUVTri>& Triangles, UTexture2D* Texture)
+{
+	if (Triangles.Num() == 0 || Texture == nullptr || Texture->Resource == nullptr)
+	{
+		return;
+	}
+
+	FCanvasTriangleItem TriangleItem(Triangles, Texture->Resource);
+	TriangleItem.BlendMode = SE_BLEND_Translucent;
+	Canvas->DrawItem(TriangleItem);
+
+	INC_DWORD_STAT_BY(STAT_NumMinimapIcons, Triangles.Num() / 2);
+}
+
+void FVehicleMinimap::Draw(UCanvas* Canvas, AVehicleGameState* GameState, const APlayerState* OwnerState)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HUDMinimap);
+
+	if (Canvas == nullptr || GameState == nullptr)
+	{
+		return;
+	}
+
+	GhostLocations.Reset();
+	for (const AVehicleGhostManager* GhostManager : GameState->GetGhostManagers())
+	{
+		const int32 NumGhosts = GhostManager ? GhostManager->GetNumGhosts() : 0;
+		for (int32 GhostIdx = 0; GhostIdx < NumGhosts; GhostIdx++)
+		{
+			FTransform GhostTransform;
+			if (GhostManager->GetGhostTransform(GhostIdx, GhostTransform))
+			{
+				GhostLocations.Add(GhostTransform.GetLocation());
+			}
+		}
+	}
+
+	const TArray<AVehicleTrackPoint*>& TrackPoints = GameState->GetTrackPoints();
+	if (TrackPoints.Num() == 0)
+	{
+		// without track points the map fits everyone seen so far, it only grows so it doesn't shake
+		for (const FVehicleRacerProgress& Progress : GameState->GetRacerProgress())
+		{
+			if (Progress.bHasVehicle)
+			{
+				GrowFallbackBounds(Progress.Location);
+			}
+		}
+		for (const FVector& GhostLocation : GhostLocations)
+		{
+			GrowFallbackBounds(GhostLocation);
+		}
+	}
+
+	if (!UpdateTransform(Canvas, GameState))
+	{
+		return;
+	}
+
+	const float ScreenScale = Canvas->ClipY / 1080.0f;
+	const float HalfIconSize = IconSize * 0.5f * ScreenScale;
+
+	// checkpoints only change when owner's next one does
+	const AVehiclePlayerState* OwnerRacerState = Cast<AVehiclePlayerState>(OwnerState);
+	const int32 NextTrackPoint = (OwnerRacerState && TrackPoints.Num() > 0) ? (OwnerRacerState->LastTrackPointIndex + 1) % TrackPoints.Num() : INDEX_NONE;
+	if (TrackPoints.Num() > 0 && (CheckpointTriangles.Num() == 0 || NextTrackPoint != CachedNextTrackPoint))
+	{
+		CachedNextTrackPoint = NextTrackPoint;
+		CheckpointTriangles.Reset();
+		for (int32 TrackPointIdx = 0; TrackPointIdx < TrackPoints.Num(); TrackPointIdx++)
+		{
+			const FLinearColor Color = TrackPointIdx == NextTrackPoint ? FLinearColor(1.0f, 0.5f, 0.0f) : FLinearColor(0.2f, 0.8f, 0.2f, 0.8f);
+			AddIcon(CheckpointTriangles, WorldToCanvas(TrackPoints[TrackPointIdx]->GetActorLocation()), HalfIconSize * 0.75f, Color);
+		}
+	}
+
+	RacerTriangles.Reset();
+	FVector2D OwnerIconLocation = FVector2D::ZeroVector;
+	bool bHasOwnerIcon = false;
+	for (const FVehicleRacerProgress& Progress : GameState->GetRacerProgress())
+	{
+		if (!Progress.bHasVehicle)
+		{
+			continue;
+		}
+
+		if (Progress.RacerState == OwnerState)
+		{
+			OwnerIconLocation = WorldToCanvas(Progress.Location);
+			bHasOwnerIcon = true;
+			continue;
+		}
+		AddIcon(RacerTriangles, WorldToCanvas(Progress.Location), HalfIconSize, FLinearColor::White);
+	}
+
+	const int32 NumTestIcons = CVarMinimapTestIcons.GetValueOnGameThread();
+	if (NumTestIcons > 0)
+	{
+		const float Time = GameState->GetWorld()->GetTimeSeconds();
+		for (int32 IconIdx = 0; IconIdx < NumTestIcons; IconIdx++)
+		{
+			const float Angle = Time * 0.5f + IconIdx * 2.0f * PI / NumTestIcons;
+			AddIcon(RacerTriangles, MapCenter + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * MapSize * 0.4f * ScreenScale, HalfIconSize, FLinearColor::White);
+		}
+	}
+
+	// owner last, on top of everyone
+	if (bHasOwnerIcon)
+	{
+		AddIcon(RacerTriangles, OwnerIconLocation, HalfIconSize * 1.25f, FLinearColor::Yellow);
+	}
+
+	GhostTriangles.Reset();
+	for (const FVector& GhostLocation : GhostLocations)
+	{
+		AddIcon(GhostTriangles, WorldToCanvas(GhostLocation), HalfIconSize, FLinearColor(0.5f, 0.8f, 1.0f, 0.5f));
+	}
+
+	const float MapExtent = MapSize * 0.5f * ScreenScale;
+	FCanvasTileItem BackgroundItem(MapCenter - FVector2D(MapExtent, MapExtent), FVector2D(MapExtent, MapExtent) * 2.0f, FLinearColor(0.0f, 0.0f, 0.0f, 0.4f));
+	BackgroundItem.BlendMode = SE_BLEND_Translucent;
+	Canvas->DrawItem(BackgroundItem);
+
+	DrawIcons(Canvas, CheckpointTriangles, CheckpointIcon);
+	DrawIcons(Canvas, GhostTriangles, RacerIcon);
+	DrawIcons(Canvas, RacerTriangles, RacerIcon);
+}
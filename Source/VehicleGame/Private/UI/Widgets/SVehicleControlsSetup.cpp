@@ -65,66 +65,42 @@ void SVehicleControlsSetup::UpdateActionBindings(FName GroupName)
 	UWorld *World = OwnerHUD.Get()->GetWorld();
 
 	CurrentGroup = GroupName;
-	UE_LOG(LogTemp, Warning, TEXT("CurrentGroup is %s"), *GroupName.ToString());
 	int32 SelectedItemIndex = ActionBindings.IndexOfByKey(SelectedItem);
-	ActionBindings.Empty();
+	ActionBindings.Reset();
 	UVehicleGameUserSettings* UserSettings = CastChecked<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
 
+	// index mappings once so every ui config entry is a single lookup
 	const TArray<FInputActionKeyMapping>& Actions = GetDefault<UInputSettings>()->ActionMappings;
-	//order of items will depend on keybindings ui config, not on the ordering from player input
-	UE_LOG(LogTemp, Warning, TEXT("**********"));
+	TMap<FActionMappingId, int32> ActionIndex;
+	ActionIndex.Reserve(Actions.Num());
 	for (int32 i = 0; i < Actions.Num(); i++)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("(%s, %s, %s)"), *GroupName.ToString(), *Actions[i].ActionName.ToString(), *Actions[i].Key.ToString());
+		ActionIndex.Add(FActionMappingId(Actions[i].ActionName, Actions[i].Key), i);
 	}
-	UE_LOG(LogTemp, Warning, TEXT("**********"));
-	for (int32 i = 0; i < Actions.Num(); i++)
+
+	const TArray<FInputAxisKeyMapping>& AxisActions = GetDefault<UInputSettings>()->AxisMappings;
+	TMap<FAxisMappingId, int32> AxisIndex;
+	AxisIndex.Reserve(AxisActions.Num());
+	for (int32 i = 0; i < AxisActions.Num(); i++)
 	{
-		FInputActionKeyMapping AddAction;
-		for (int32 j = 0; j < UserSettings->KeybindingsUIConfig.Num(); j++)
-		{
-			if (UserSettings->KeybindingsUIConfig[j].ActionName == Actions[i].ActionName)
-			{
-			}
-		}
+		AxisIndex.Add(FAxisMappingId(AxisActions[i].AxisName, AxisActions[i].Key, AxisActions[i].Scale), i);
 	}
 
-//	return;
-	for (int32 j=0; j < UserSettings->KeybindingsUIConfig.Num(); j++)
+	//order of items will depend on keybindings ui config, not on the ordering from player input
+	for (FKeybindingUIConfig& BindConfig : UserSettings->KeybindingsUIConfig)
 	{
-		for (int32 i=0; i < Actions.Num();i++)
+		const int32* MappingIdx = BindConfig.GroupName == GroupName ? ActionIndex.Find(FActionMappingId(BindConfig.ActionName, BindConfig.Key)) : nullptr;
+		if (MappingIdx)
 		{
-			if (UserSettings->KeybindingsUIConfig[j].GroupName == GroupName && 
-				UserSettings->KeybindingsUIConfig[j].ActionName == Actions[i].ActionName &&
-				UserSettings->KeybindingsUIConfig[j].Key == Actions[i].Key)
-			{
-//				UE_LOG(LogTemp, Warning, TEXT("ACCEPT (%s, %s, %s)"), *UserSettings->KeybindingsUIConfig[j].GroupName.ToString(), *UserSettings->KeybindingsUIConfig[j].ActionName.ToString(), *UserSettings->KeybindingsUIConfig[j].Key.ToString());
-				ActionBindings.Add(MakeShareable(new FActionBinding(&UserSettings->KeybindingsUIConfig[j], &Actions[i])));
-			}
-			else
-			{
-//				UE_LOG(LogTemp, Warning, TEXT("Reject (%s, %s, %s) based on (%s, %s, %s)"), *UserSettings->KeybindingsUIConfig[j].GroupName.ToString(), *UserSettings->KeybindingsUIConfig[j].ActionName.ToString(), *UserSettings->KeybindingsUIConfig[j].Key.ToString(), *GroupName.ToString(), *Actions[i].ActionName.ToString(), *Actions[i].Key.ToString());
-			}
+			ActionBindings.Add(MakeShareable(new FActionBinding(&BindConfig, &Actions[*MappingIdx])));
 		}
 	}
-//	return;
-	const TArray<FInputAxisKeyMapping>& AxisActions = GetDefault<UInputSettings>()->AxisMappings;
-	for (int32 j=0; j < UserSettings->KeybindingsUIConfig.Num(); j++)
+	for (FKeybindingUIConfig& BindConfig : UserSettings->KeybindingsUIConfig)
 	{
-		for (int32 i=0; i < AxisActions.Num();i++)
+		const int32* MappingIdx = BindConfig.GroupName == GroupName ? AxisIndex.Find(FAxisMappingId(BindConfig.AxisName, BindConfig.Key, BindConfig.Scale)) : nullptr;
+		if (MappingIdx)
 		{
-			if (UserSettings->KeybindingsUIConfig[j].GroupName == GroupName && 
-				UserSettings->KeybindingsUIConfig[j].AxisName == AxisActions[i].AxisName &&
-				UserSettings->KeybindingsUIConfig[j].Scale == AxisActions[i].Scale &&
-				UserSettings->KeybindingsUIConfig[j].Key == AxisActions[i].Key)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("AXIS ACCEPT (%s, %s, %f, %s)"), *UserSettings->KeybindingsUIConfig[j].GroupName.ToString(), *UserSettings->KeybindingsUIConfig[j].AxisName.ToString(), UserSettings->KeybindingsUIConfig[j].Scale, *UserSettings->KeybindingsUIConfig[j].Key.ToString());
-				ActionBindings.Add(MakeShareable(new FActionBinding(&UserSettings->KeybindingsUIConfig[j], &AxisActions[i])));
-			}
-			else
-			{
-				UE_LOG(LogTemp, Warning, TEXT("AXIS Reject (%s, %s, %f, %s) based on (%s, %s, %f, %s)"), *UserSettings->KeybindingsUIConfig[j].GroupName.ToString(), *UserSettings->KeybindingsUIConfig[j].AxisName.ToString(), UserSettings->KeybindingsUIConfig[j].Scale, *UserSettings->KeybindingsUIConfig[j].Key.ToString(), *GroupName.ToString(), *AxisActions[i].AxisName.ToString(), AxisActions[i].Scale, *AxisActions[i].Key.ToString());
-			}
+			ActionBindings.Add(MakeShareable(new FActionBinding(&BindConfig, &AxisActions[*MappingIdx])));
 		}
 	}
 
@@ -238,11 +214,10 @@ void SVehicleControlsSetup::RemapKey(TSharedPtr<FActionBinding> Binding, const F
 			InputSettings->RemoveAxisMapping(*Binding->AxisMapping);
 			InputSettings->AddAxisMapping(NewMapping);
 		}
+		// rapid remaps are saved together, ini files are written on a worker thread
 		UVehicleGameUserSettings* UserSettings = CastChecked<UVehicleGameUserSettings>(GEngine->GetGameUserSettings());
-		UserSettings->SaveSettings();
+		UserSettings->RequestDeferredSave();
 
-		//save immediately
-		GetMutableDefault<UInputSettings>()->SaveKeyMappings();
 		FSlateApplication::Get().SetKeyboardFocus(ActionBindingsList.ToSharedRef());
 		UpdateActionBindings(CurrentGroup);
 		bAwaitingKeyPress = false;
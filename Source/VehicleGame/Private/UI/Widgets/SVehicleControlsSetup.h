@@ -28,6 +28,54 @@ struct FActionBinding
 	}
 };
 
+/** action mapping lookup key */
+struct FActionMappingId
+{
+	FName ActionName;
+	FKey Key;
+
+	FActionMappingId(FName InActionName, const FKey& InKey)
+		: ActionName(InActionName)
+		, Key(InKey)
+	{
+	}
+
+	bool operator==(const FActionMappingId& Other) const
+	{
+		return ActionName == Other.ActionName && Key == Other.Key;
+	}
+
+	friend uint32 GetTypeHash(const FActionMappingId& Id)
+	{
+		return HashCombine(GetTypeHash(Id.ActionName), GetTypeHash(Id.Key));
+	}
+};
+
+/** axis mapping lookup key, scale tells apart both directions of the same axis */
+struct FAxisMappingId
+{
+	FName AxisName;
+	FKey Key;
+	float Scale;
+
+	FAxisMappingId(FName InAxisName, const FKey& InKey, float InScale)
+		: AxisName(InAxisName)
+		, Key(InKey)
+		, Scale(InScale)
+	{
+	}
+
+	bool operator==(const FAxisMappingId& Other) const
+	{
+		return AxisName == Other.AxisName && Key == Other.Key && Scale == Other.Scale;
+	}
+
+	friend uint32 GetTypeHash(const FAxisMappingId& Id)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Id.AxisName), GetTypeHash(Id.Key)), GetTypeHash(Id.Scale));
+	}
+};
+
 // Key binding restriction helper
 struct BindingRestriction
 {
@@ -2,17 +2,30 @@
 
 #include "VehicleGame.h"
 #include "SVehicleHUDWidget.h"
+#include "Widgets/SInvalidationPanel.h"
 #include "VehicleStyle.h"
-#include "VehicleGameMode.h"
 
 #define LOCTEXT_NAMESPACE "VehicleGame.HUD"
 
+DECLARE_CYCLE_STAT(TEXT("HUD widget tick"), STAT_HUDWidgetTick, STATGROUP_VehicleGame);
+DECLARE_CYCLE_STAT(TEXT("HUD widget paint"), STAT_HUDWidgetPaint, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD widget invalidations"), STAT_HUDWidgetInvalidations, STATGROUP_VehicleGame);
+
+/** cm/s to km/h */
+static const float SpeedToKmh = 0.036f;
+
 void SVehicleHUDWidget::Construct(const FArguments& InArgs)
 {
 	FSlateFontInfo StartMessageFontStyle("UI_Vehicle_Font", 32);
+	FSlateFontInfo RaceInfoFontStyle("UI_Vehicle_Font", 24);
 
 	OwnerWorld = InArgs._OwnerWorld;
 
+	DisplayedRaceTime = -1;
+	DisplayedSpeed = -1;
+	DisplayedPlace = 0;
+	DisplayedNumRacers = 0;
+
 	ChildSlot
 	.VAlign(VAlign_Fill)
 	.HAlign(HAlign_Fill)
@@ -27,38 +40,138 @@ void SVehicleHUDWidget::Construct(const FArguments& InArgs)
 			.VAlign(VAlign_Center)
 			.HAlign(HAlign_Center)
 			[
-				SNew(SBorder)
-				.Visibility(this, &SVehicleHUDWidget::GetInfoTextVisibility)
-				.BorderImage(FCoreStyle::Get().GetBrush("NoBorder"))
-				[
-					SNew(STextBlock)
+				SAssignNew(InfoTextBlock, STextBlock)
+				.Visibility(EVisibility::Collapsed)
+				.TextStyle(FVehicleStyle::Get(), "VehicleGame.MenuTextStyle")
+				.ColorAndOpacity(this,&SVehicleHUDWidget::GetInfoTextColor)
+				.Font(StartMessageFontStyle)
+			]
+			+SOverlay::Slot()
+			.VAlign(VAlign_Top)
+			.HAlign(HAlign_Center)
+			.Padding(0.0f, 32.0f)
+			[
+				SAssignNew(TimerTextBlock, STextBlock)
+				.Visibility(EVisibility::Collapsed)
+				.TextStyle(FVehicleStyle::Get(), "VehicleGame.MenuTextStyle")
+				.Font(RaceInfoFontStyle)
+			]
+			+SOverlay::Slot()
+			.VAlign(VAlign_Top)
+			.HAlign(HAlign_Right)
+			.Padding(32.0f)
+			[
+				MakeCachedPanel(PlacePanel,
+					SAssignNew(PlaceTextBlock, STextBlock)
+					.Visibility(EVisibility::Collapsed)
 					.TextStyle(FVehicleStyle::Get(), "VehicleGame.MenuTextStyle")
-					.ColorAndOpacity(this,&SVehicleHUDWidget::GetInfoTextColor)
-					.Text(this,&SVehicleHUDWidget::GetInfoText)
-					.Font(StartMessageFontStyle)
-				]
+					.Font(RaceInfoFontStyle))
+			]
+			+SOverlay::Slot()
+			.VAlign(VAlign_Bottom)
+			.HAlign(HAlign_Right)
+			.Padding(32.0f)
+			[
+				SAssignNew(SpeedTextBlock, STextBlock)
+				.Visibility(EVisibility::Collapsed)
+				.TextStyle(FVehicleStyle::Get(), "VehicleGame.MenuTextStyle")
+				.Font(RaceInfoFontStyle)
 			]
 		]
 	];
 }
 
-FText SVehicleHUDWidget::GetInfoText() const
+TSharedRef<SWidget> SVehicleHUDWidget::MakeCachedPanel(TSharedPtr<SInvalidationPanel>& OutPanel, TSharedRef<SWidget> Content) const
+{
+	return SAssignNew(OutPanel, SInvalidationPanel)
+		.CacheRelativeTransforms(true)
+		[
+			Content
+		];
+}
+
+void SVehicleHUDWidget::UpdateText(const TSharedPtr<STextBlock>& TextBlock, const FText& Text)
+{
+	TextBlock->SetText(Text);
+	TextBlock->SetVisibility(Text.IsEmpty() ? EVisibility::Collapsed : EVisibility::HitTestInvisible);
+}
+
+void SVehicleHUDWidget::UpdateCachedText(const TSharedPtr<SInvalidationPanel>& Panel, const TSharedPtr<STextBlock>& TextBlock, const FText& Text)
+{
+	UpdateText(TextBlock, Text);
+	Panel->InvalidateCache();
+	INC_DWORD_STAT(STAT_HUDWidgetInvalidations);
+}
+
+void SVehicleHUDWidget::SetInfoText(const FText& InText)
+{
+	InfoTextBlock->SetText(InText);
+	InfoTextBlock->SetVisibility(InText.IsEmpty() ? EVisibility::Collapsed : EVisibility::HitTestInvisible);
+}
+
+void SVehicleHUDWidget::SetRaceTime(float InRaceTime)
+{
+	const int32 NewRaceTime = InRaceTime >= 0.0f ? FMath::FloorToInt(InRaceTime * 100.0f) : -1;
+	if (NewRaceTime == DisplayedRaceTime)
+	{
+		return;
+	}
+
+	DisplayedRaceTime = NewRaceTime;
+
+	FText TimeText;
+	if (DisplayedRaceTime >= 0)
+	{
+		FFormatOrderedArguments Args;
+		Args.Add(FText::AsNumber(DisplayedRaceTime / 6000));
+		Args.Add(FText::FromString(FString::Printf(TEXT("%02d.%02d"), (DisplayedRaceTime / 100) % 60, DisplayedRaceTime % 100)));
+		TimeText = FText::Format(LOCTEXT("RaceTime", "{0}:{1}"), Args);
+	}
+	UpdateText(TimerTextBlock, TimeText);
+}
+
+void SVehicleHUDWidget::SetSpeed(float InSpeed)
+{
+	const int32 NewSpeed = InSpeed >= 0.0f ? FMath::RoundToInt(InSpeed * SpeedToKmh) : -1;
+	if (NewSpeed == DisplayedSpeed)
+	{
+		return;
+	}
+
+	DisplayedSpeed = NewSpeed;
+	UpdateText(SpeedTextBlock, DisplayedSpeed >= 0 ? FText::Format(LOCTEXT("Speed", "{0} KM/H"), FText::AsNumber(DisplayedSpeed)) : FText::GetEmpty());
+}
+
+void SVehicleHUDWidget::SetPlace(int32 InPlace, int32 InNumRacers)
+{
+	if (InPlace == DisplayedPlace && InNumRacers == DisplayedNumRacers)
+	{
+		return;
+	}
+
+	DisplayedPlace = InPlace;
+	DisplayedNumRacers = InNumRacers;
+	UpdateCachedText(PlacePanel, PlaceTextBlock, DisplayedPlace > 0 ? FText::Format(LOCTEXT("Place", "{0}/{1}"), FText::AsNumber(DisplayedPlace), FText::AsNumber(DisplayedNumRacers)) : FText::GetEmpty());
+}
+
+void SVehicleHUDWidget::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
 {
-	AVehicleGameMode* const MyGame = OwnerWorld->GetAuthGameMode<AVehicleGameMode>();
-	return MyGame->GetGameInfoText();
+	SCOPE_CYCLE_COUNTER(STAT_HUDWidgetTick);
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
 }
 
-EVisibility SVehicleHUDWidget::GetInfoTextVisibility() const
+int32 SVehicleHUDWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
-	AVehicleGameMode* const MyGame = OwnerWorld->GetAuthGameMode<AVehicleGameMode>();
-	return (MyGame && !MyGame->GetGameInfoText().IsEmpty()) ? EVisibility::Visible : EVisibility::Collapsed;
+	SCOPE_CYCLE_COUNTER(STAT_HUDWidgetPaint);
+	return SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
 }
 
 FSlateColor SVehicleHUDWidget::GetInfoTextColor() const
 {
 	const float AnimSpeedModifier = 0.8f;
-	float Alpha = FMath::Abs(FMath::Sin(OwnerWorld->GetTimeSeconds())*AnimSpeedModifier);
+	const float TimeSeconds = OwnerWorld.IsValid() ? OwnerWorld->GetTimeSeconds() : 0.0f;
+	float Alpha = FMath::Abs(FMath::Sin(TimeSeconds)*AnimSpeedModifier);
 	return FLinearColor(1,1,1,Alpha);
 }
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
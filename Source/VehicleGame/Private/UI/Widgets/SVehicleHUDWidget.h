@@ -5,7 +5,7 @@
 #include "SlateBasics.h"
 #include "SlateExtras.h"
 
-class AVehiclePlayerController;
+class SInvalidationPanel;
 
 //HUD widget base class
 class SVehicleHUDWidget : public SCompoundWidget
@@ -21,12 +21,54 @@ public:
 	/** Needed for every widget */
 	void Construct(const FArguments& InArgs);
 
+	/** Set the information text at the bottom of the screen, empty hides it */
+	void SetInfoText(const FText& InText);
+
+	/** Set race time in seconds, negative hides the timer */
+	void SetRaceTime(float InRaceTime);
+
+	/** Set vehicle speed in cm/s, negative hides the speedometer */
+	void SetSpeed(float InSpeed);
+
+	/** Set race place, 0 hides it */
+	void SetPlace(int32 InPlace, int32 InNumRacers);
+
+	// Begin SWidget interface
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	// End SWidget interface
+
 protected:
-	EVisibility GetInfoTextVisibility() const;
 	FSlateColor GetInfoTextColor() const;
-	FText		GetInfoText() const;
 
-	AVehiclePlayerController* PCOwner;
+	/** Wrap content in panel caching its draw elements until invalidated */
+	TSharedRef<SWidget> MakeCachedPanel(TSharedPtr<SInvalidationPanel>& OutPanel, TSharedRef<SWidget> Content) const;
+
+	/** Update text and visibility of element */
+	void UpdateText(const TSharedPtr<STextBlock>& TextBlock, const FText& Text);
+
+	/** Update text and visibility of cached element, invalidating its panel */
+	void UpdateCachedText(const TSharedPtr<SInvalidationPanel>& Panel, const TSharedPtr<STextBlock>& TextBlock, const FText& Text);
+
+	/** Information text, pulsing so repainted every frame while visible */
+	TSharedPtr<STextBlock> InfoTextBlock;
+
+	/** Race time and speed change nearly every frame, caching them would only add invalidation cost */
+	TSharedPtr<STextBlock> TimerTextBlock;
+	TSharedPtr<STextBlock> SpeedTextBlock;
+
+	TSharedPtr<SInvalidationPanel> PlacePanel;
+	TSharedPtr<STextBlock> PlaceTextBlock;
+
+	/** Displayed race time in centiseconds, -1 when hidden */
+	int32 DisplayedRaceTime;
+
+	/** Displayed speed in km/h, -1 when hidden */
+	int32 DisplayedSpeed;
+
+	/** Displayed place and number of racers, 0 when hidden */
+	int32 DisplayedPlace;
+	int32 DisplayedNumRacers;
 
 	/** Pointer to our parent World */
 	TWeakObjectPtr<UWorld> OwnerWorld;
@@ -4,16 +4,37 @@
 #include "VehicleGameMode.h"
 #include "Track/VehicleTrackPoint.h"
 #include "Player/VehiclePlayerController.h"
+#include "Player/VehicleAIController.h"
+#include "Player/VehiclePlayerState.h"
+#include "Pawns/BuggyPawn.h"
 #include "VehicleGameState.h"
+#include "VehicleReplay.h"
+#include "Leaderboard/VehicleResultSubmitter.h"
 #include "Landscape.h"
 
+DECLARE_CYCLE_STAT(TEXT("Vehicle spawn"), STAT_VehicleSpawn, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicles spawned"), STAT_VehiclesSpawned, STATGROUP_VehicleGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicles revived from pool"), STAT_VehiclesRevived, STATGROUP_VehicleGame);
+
 AVehicleGameMode::AVehicleGameMode(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	RaceStartTime = 0;
 	RaceFinishTime = 0;	
 	bLockingActive = false;
+	MaxLagCompensation = 0.25f;
+	NumLaps = 1;
+	ReplayTailTime = 5.0f;
+	RacePlaceInterval = 0.25f;
+	CountdownRemaining = 0;
+	ResetCountdown = 3;
+	MaxPooledPawns = 8;
+	PooledPawnReuseDelay = 0.5f;
+	NumBots = 0;
+	NumBotsSpawned = 0;
+	BotControllerClass = AVehicleAIController::StaticClass();
 
 	GameStateClass = AVehicleGameState::StaticClass();
+	PlayerStateClass = AVehiclePlayerState::StaticClass();
 	if ((GEngine != nullptr ) && ( GEngine->GameViewport != nullptr))
 	{
 		GEngine->GameViewport->SetSuppressTransitionMessage( true );
@@ -22,11 +43,65 @@ AVehicleGameMode::AVehicleGameMode(const FObjectInitializer& ObjectInitializer)
 	PrimaryActorTick.bCanEverTick = true;
 }
 
+void AVehicleGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	NumBots = UGameplayStatics::GetIntOption(Options, TEXT("Bots"), NumBots);
+}
+
 void AVehicleGameMode::StartPlay()
 {
 	Super::StartPlay();
 
 	EnablePlayerLocking();
+	AddBots(NumBots);
+	FVehicleReplay::StartRecording(GetWorld());
+
+	GetWorldTimerManager().SetTimer(TimerHandle_RacePlaces, this, &AVehicleGameMode::UpdateRacePlaces, RacePlaceInterval, true);
+}
+
+void AVehicleGameMode::AddBots(int32 Num)
+{
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	for (int32 BotIdx = 0; BotIdx < Num; BotIdx++)
+	{
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Instigator = Instigator;
+		SpawnInfo.ObjectFlags |= RF_Transient;
+		AVehicleAIController* Bot = GetWorld()->SpawnActor<AVehicleAIController>(BotControllerClass, SpawnInfo);
+		if (Bot == nullptr)
+		{
+			continue;
+		}
+
+		NumBotsSpawned++;
+		if (Bot->PlayerState)
+		{
+			Bot->PlayerState->SetPlayerName(FString::Printf(TEXT("Bot %d"), NumBotsSpawned));
+			Bot->PlayerState->bIsABot = true;
+		}
+
+		Bot->SetHandbrakeForced(bLockingActive && !IsRaceActive());
+		if (VehicleGameState != nullptr)
+		{
+			VehicleGameState->NumRacers++;
+		}
+
+		RestartPlayer(Bot);
+	}
+}
+
+void AVehicleGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FVehicleReplay::StopRecording(GetWorld());
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVehicleGameMode::StopReplayRecording()
+{
+	FVehicleReplay::StopRecording(GetWorld());
 }
 
 AActor* AVehicleGameMode::ChoosePlayerStart_Implementation(AController* Player)
@@ -61,8 +136,73 @@ AActor* AVehicleGameMode::ChoosePlayerStart_Implementation(AController* Player)
 APawn* AVehicleGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlayer, class AActor* StartSpot)
 {
 	check(StartSpot);
-	bool bGotStart = false;
+	SCOPE_CYCLE_COUNTER(STAT_VehicleSpawn);
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
 	//APawn* NewPawn = Super::SpawnDefaultPawnFor_Implementation(NewPlayer, StartSpot);
+	const FTransform SpawnTransform = GetSpawnTransform(StartSpot, TArray<AActor*>());
+	UClass* PawnClass = GetDefaultPawnClassForController(NewPlayer);
+	APawn* ResultPawn = AcquirePawn(PawnClass, SpawnTransform);
+	const bool bRevived = (ResultPawn != nullptr);
+	if (bRevived)
+	{
+		INC_DWORD_STAT(STAT_VehiclesRevived);
+	}
+	else
+	{
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Instigator = Instigator;
+		ResultPawn = GetWorld()->SpawnActor<APawn>(PawnClass, SpawnTransform.GetLocation(), SpawnTransform.Rotator(), SpawnInfo);
+		INC_DWORD_STAT(STAT_VehiclesSpawned);
+	}
+	check(ResultPawn != nullptr);
+
+	UE_LOG(LogVehicle, Log, TEXT("%s %s in %.3f ms, %d new objects"), bRevived ? TEXT("Revived") : TEXT("Spawned"), *ResultPawn->GetName(),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, GUObjectArray.GetObjectArrayNumMinusAvailable() - NumObjectsBefore);
+	return ResultPawn;
+}
+
+bool AVehicleGameMode::ReleasePawn(ABuggyPawn* DeadPawn)
+{
+	if (DeadPawn == nullptr || PooledPawns.Num() >= MaxPooledPawns)
+	{
+		return false;
+	}
+
+	FVehiclePooledPawn& Entry = PooledPawns[PooledPawns.AddDefaulted()];
+	Entry.Pawn = DeadPawn;
+	Entry.PoolTime = GetWorld()->GetTimeSeconds();
+	return true;
+}
+
+ABuggyPawn* AVehicleGameMode::AcquirePawn(UClass* PawnClass, const FTransform& SpawnTransform)
+{
+	// nobody has to see the death replicated in standalone game
+	const float ReadyTime = GetWorld()->GetTimeSeconds() - (GetNetMode() == NM_Standalone ? 0.0f : PooledPawnReuseDelay);
+	for (int32 PoolIdx = 0; PoolIdx < PooledPawns.Num(); PoolIdx++)
+	{
+		ABuggyPawn* PooledPawn = PooledPawns[PoolIdx].Pawn;
+		if (PooledPawn == nullptr || PooledPawn->IsPendingKill())
+		{
+			PooledPawns.RemoveAt(PoolIdx--);
+			continue;
+		}
+
+		if (PooledPawn->GetClass() == PawnClass && PooledPawns[PoolIdx].PoolTime <= ReadyTime)
+		{
+			PooledPawns.RemoveAt(PoolIdx);
+			PooledPawn->Revive(SpawnTransform);
+			return PooledPawn;
+		}
+	}
+
+	return nullptr;
+}
+
+FTransform AVehicleGameMode::GetSpawnTransform(AActor* StartSpot, const TArray<AActor*>& IgnoredActors) const
+{
+	bool bGotStart = false;
 	FVector StartLocation = StartSpot->GetActorLocation();
 	FRotator StartRotation(ForceInit);
 	StartRotation.Yaw = StartSpot->GetActorRotation().Yaw;
@@ -80,7 +220,8 @@ APawn* AVehicleGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlay
 		FVector NewOff = EachRot.RotateVector(RotationOffset);
 
 		const FVector NewPos = StartLocation + NewOff;
-		const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(SpawnTrace), true);
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(SpawnTrace), true);
+		TraceParams.AddIgnoredActors(IgnoredActors);
 		const FVector TraceStart = NewPos + TraceOffset;
 		const FVector TraceEnd = NewPos - TraceOffset;
 		FHitResult Hit;
@@ -102,11 +243,7 @@ APawn* AVehicleGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlay
 
 	// Move the spawn Z up a little so we drop onto the track
 	StartLocation.Z += 150.0f;
-	FActorSpawnParameters SpawnInfo;
-	SpawnInfo.Instigator = Instigator;
-	APawn* ResultPawn = GetWorld()->SpawnActor<APawn>(GetDefaultPawnClassForController(NewPlayer), StartLocation, StartRotation, SpawnInfo);
-	check(ResultPawn != nullptr);
-	return ResultPawn;
+	return FTransform(StartRotation, StartLocation);
 }
 
 void AVehicleGameMode::PostLogin(APlayerController* NewPlayer)
@@ -127,13 +264,19 @@ void AVehicleGameMode::PostLogin(APlayerController* NewPlayer)
 
 void AVehicleGameMode::BroadcastRaceState()
 {
-	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	for (FConstControllerIterator It = GetWorld()->GetControllerIterator(); It; ++It)
 	{
 		AVehiclePlayerController* VehiclePC = Cast<AVehiclePlayerController>(*It);
 		if (VehiclePC)
 		{
 			VehiclePC->SetHandbrakeForced(bLockingActive && !IsRaceActive());
 		}
+
+		AVehicleAIController* VehicleAI = Cast<AVehicleAIController>(*It);
+		if (VehicleAI)
+		{
+			VehicleAI->SetHandbrakeForced(bLockingActive && !IsRaceActive());
+		}
 	}
 }
 
@@ -146,11 +289,73 @@ void AVehicleGameMode::StartRace()
 		{			
 			VehicleGameState->bIsRaceActive = true;
 		}
-		RaceStartTime = GetWorld()->GetTimeSeconds();
+
+		// clients already released at the scheduled time, count from it rather than from this frame
+		const bool bWasScheduled = (VehicleGameState != nullptr && VehicleGameState->RaceStartServerTime > 0.0f);
+		RaceStartTime = bWasScheduled ? VehicleGameState->RaceStartServerTime : GetWorld()->GetTimeSeconds();
+		GetWorldTimerManager().ClearTimer(TimerHandle_RaceStart);
 		BroadcastRaceState();
+
+		if (VehicleGameState != nullptr)
+		{
+			VehicleGameState->AddRaceEvent(EVehicleRaceEvent::RaceStart, nullptr, 0, 0.0f);
+
+			AVehicleTrackPoint* FinishLine = VehicleGameState->GetFinishLine();
+			if (FinishLine && !FinishLine->bIsFinishLine)
+			{
+				UE_LOG(LogVehicle, Warning, TEXT("No track point is flagged as finish line, using last one %s"), *FinishLine->GetName());
+			}
+		}
 	}
 }
 
+void AVehicleGameMode::ScheduleRaceStart(float Delay)
+{
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (IsRaceActive() || VehicleGameState == nullptr)
+	{
+		return;
+	}
+
+	if (Delay <= 0.0f)
+	{
+		StartRace();
+		return;
+	}
+
+	VehicleGameState->RaceStartServerTime = GetWorld()->GetTimeSeconds() + Delay;
+	GetWorldTimerManager().SetTimer(TimerHandle_RaceStart, this, &AVehicleGameMode::StartRace, Delay, false);
+}
+
+void AVehicleGameMode::StartCountdown(int32 Seconds)
+{
+	if (IsRaceActive())
+	{
+		return;
+	}
+
+	CountdownRemaining = Seconds;
+	ScheduleRaceStart(Seconds);
+	TickCountdown();
+}
+
+void AVehicleGameMode::TickCountdown()
+{
+	if (CountdownRemaining <= 0)
+	{
+		return;
+	}
+
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (VehicleGameState != nullptr)
+	{
+		VehicleGameState->AddRaceEvent(EVehicleRaceEvent::Countdown, nullptr, CountdownRemaining, 0.0f);
+	}
+
+	CountdownRemaining--;
+	GetWorldTimerManager().SetTimer(TimerHandle_Countdown, this, &AVehicleGameMode::TickCountdown, 1.0f, false);
+}
+
 void AVehicleGameMode::FinishRace()
 {
 	if (IsRaceActive())
@@ -159,14 +364,245 @@ void AVehicleGameMode::FinishRace()
 		if (VehicleGameState != nullptr)
 		{
 			VehicleGameState->bIsRaceActive = false;
+			VehicleGameState->RaceStartServerTime = 0.0f;
 		}
 		RaceFinishTime = GetWorld()->GetTimeSeconds();
 		BroadcastRaceState();
+
+		// keep recording a moment longer to capture the finish
+		GetWorldTimerManager().SetTimer(TimerHandle_StopReplay, this, &AVehicleGameMode::StopReplayRecording, ReplayTailTime, false);
+
+		if (VehicleGameState != nullptr)
+		{
+			for (APlayerState* PlayerState : VehicleGameState->PlayerArray)
+			{
+				AVehiclePlayerState* RacerState = Cast<AVehiclePlayerState>(PlayerState);
+				if (RacerState && !RacerState->bHasFinished)
+				{
+					VehicleGameState->AddRaceEvent(EVehicleRaceEvent::DidNotFinish, RacerState, 0, RaceFinishTime - RaceStartTime);
+				}
+			}
+		}
+
+		// places are final now, results are only queued here and posted in background
+		const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+		FVehicleResultSubmitter* ResultSubmitter = FVehicleResultSubmitter::Get();
+		for (int32 PlaceIdx = 0; ResultSubmitter && PlaceIdx < FinishedRacers.Num(); PlaceIdx++)
+		{
+			AVehiclePlayerState* RacerState = FinishedRacers[PlaceIdx];
+			if (RacerState && !RacerState->bIsABot)
+			{
+				FVehicleRaceResult Result;
+				Result.MapName = MapName;
+				Result.ModeName = GetClass()->GetName();
+				Result.PlayerName = RacerState->PlayerName;
+				Result.Place = PlaceIdx + 1;
+				Result.FinishTime = RacerState->FinishTime;
+				ResultSubmitter->Submit(Result);
+			}
+		}
 	}
 }
 
+void AVehicleGameMode::ResetRace()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_Countdown);
+	GetWorldTimerManager().ClearTimer(TimerHandle_RaceStart);
+	GetWorldTimerManager().ClearTimer(TimerHandle_StopReplay);
+	CountdownRemaining = 0;
+	RaceStartTime = 0;
+	RaceFinishTime = 0;
+	FinishedRacers.Reset();
+
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (VehicleGameState != nullptr)
+	{
+		VehicleGameState->ResetRace();
+	}
+
+	// grid slots are handed out in controller order, in the order ChoosePlayerStart tries them
+	TArray<AActor*> GridSlots;
+	for (TActorIterator<APlayerStart> PlayerStartIt(GetWorld()); PlayerStartIt; ++PlayerStartIt)
+	{
+		GridSlots.Add(*PlayerStartIt);
+	}
+
+	// vehicles still out on the track must not block the landscape traces of each other's slots
+	TArray<AActor*> RacerPawns;
+	for (FConstPawnIterator PawnIt = GetWorld()->GetPawnIterator(); PawnIt; ++PawnIt)
+	{
+		if (*PawnIt != nullptr)
+		{
+			RacerPawns.Add(PawnIt->Get());
+		}
+	}
+
+	int32 NumMoved = 0;
+	int32 NumRespawned = 0;
+	int32 SlotIdx = 0;
+	for (FConstControllerIterator It = GetWorld()->GetControllerIterator(); It; ++It)
+	{
+		AController* Racer = It->Get();
+		AVehiclePlayerController* VehiclePC = Cast<AVehiclePlayerController>(Racer);
+		AVehicleAIController* VehicleAI = Cast<AVehicleAIController>(Racer);
+		AVehiclePlayerState* RacerState = Racer ? Cast<AVehiclePlayerState>(Racer->PlayerState) : nullptr;
+		if ((VehiclePC == nullptr && VehicleAI == nullptr) || RacerState == nullptr || RacerState->bOnlySpectator)
+		{
+			continue;
+		}
+
+		RacerState->ResetRaceProgress();
+		if (VehiclePC)
+		{
+			VehiclePC->LastTrackPoint = nullptr;
+			VehiclePC->StartSpot = nullptr;
+		}
+		if (VehicleAI)
+		{
+			VehicleAI->ResetRaceProgress();
+		}
+
+		AActor* GridSlot = GridSlots.IsValidIndex(SlotIdx) ? GridSlots[SlotIdx] : ChoosePlayerStart(Racer);
+		SlotIdx++;
+		if (GridSlot == nullptr)
+		{
+			continue;
+		}
+
+		// dying vehicles are already detached, their racers get a new one right away instead of waiting for respawn
+		ABuggyPawn* RacerPawn = Cast<ABuggyPawn>(Racer->GetPawn());
+		if (RacerPawn && !RacerPawn->bIsDying)
+		{
+			Racer->StartSpot = GridSlot;
+			RacerPawn->ResetToTransform(GetSpawnTransform(GridSlot, RacerPawns));
+			NumMoved++;
+		}
+		else
+		{
+			RestartPlayerAtPlayerStart(Racer, GridSlot);
+			NumRespawned++;
+		}
+	}
+
+	// everybody waits on the grid again
+	EnablePlayerLocking();
+
+	FVehicleReplay::StopRecording(GetWorld());
+	FVehicleReplay::StartRecording(GetWorld());
+
+	if (ResetCountdown > 0)
+	{
+		StartCountdown(ResetCountdown);
+	}
+
+	UE_LOG(LogVehicle, Log, TEXT("Race reset in %.2f ms, %d vehicles moved to grid, %d respawned"), 
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, NumMoved, NumRespawned);
+}
+
+void AVehicleGameMode::Logout(AController* Exiting)
+{
+	AVehiclePlayerState* RacerState = Exiting ? Cast<AVehiclePlayerState>(Exiting->PlayerState) : nullptr;
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (RacerState && VehicleGameState && IsRaceActive() && !RacerState->bHasFinished)
+	{
+		VehicleGameState->AddRaceEvent(EVehicleRaceEvent::DidNotFinish, RacerState, 0, GetRaceTimer());
+	}
+
+	// counted in PostLogin
+	if (VehicleGameState && Cast<AVehiclePlayerController>(Exiting))
+	{
+		VehicleGameState->NumRacers = FMath::Max(VehicleGameState->NumRacers - 1, 0);
+	}
+
+	Super::Logout(Exiting);
+}
+
+void AVehicleGameMode::OnTrackPointCrossed(AController* Racer, AVehicleTrackPoint* TrackPoint, float CrossingTime)
+{
+	AVehiclePlayerState* RacerState = Racer ? Cast<AVehiclePlayerState>(Racer->PlayerState) : nullptr;
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (RacerState == nullptr || VehicleGameState == nullptr || RacerState->bHasFinished || !IsRaceActive())
+	{
+		return;
+	}
+
+	const TArray<AVehicleTrackPoint*>& TrackPoints = VehicleGameState->GetTrackPoints();
+	const int32 TrackPointIndex = TrackPoints.IndexOfByKey(TrackPoint);
+	// track points count only in order, so driving back and forth through gates never adds up to a lap
+	if (TrackPointIndex == INDEX_NONE || TrackPointIndex != (RacerState->LastTrackPointIndex + 1) % TrackPoints.Num())
+	{
+		return;
+	}
+
+	RacerState->LastTrackPointIndex = TrackPointIndex;
+	RacerState->LastTrackPointTime = CrossingTime;
+	RacerState->NumTrackPointsPassed++;
+	VehicleGameState->AddRaceEvent(EVehicleRaceEvent::Checkpoint, RacerState, TrackPointIndex, CrossingTime - RaceStartTime);
+
+	// a lap counts when the finish line is crossed after passing every track point once more
+	if (TrackPoint != VehicleGameState->GetFinishLine() || RacerState->NumTrackPointsPassed < TrackPoints.Num() * (RacerState->NumLapsCompleted + 1))
+	{
+		return;
+	}
+
+	// the server sees the crossing half a round trip after the racer drove it, backdate the
+	// line time by that (capped, so a faked ping can't buy time) to settle close finishes fairly
+	const float LagCompensation = FMath::Clamp(RacerState->ExactPing * 0.0005f, 0.0f, MaxLagCompensation);
+	const float LineRaceTime = FMath::Max(CrossingTime - LagCompensation - RaceStartTime, 0.0f);
+	float LapStartRaceTime = 0.0f;
+	for (float LapTime : RacerState->LapTimes)
+	{
+		LapStartRaceTime += LapTime;
+	}
+	RacerState->LapTimes.Add(FMath::Max(LineRaceTime - LapStartRaceTime, 0.0f));
+
+	RacerState->NumLapsCompleted++;
+	VehicleGameState->AddRaceEvent(EVehicleRaceEvent::Lap, RacerState, RacerState->NumLapsCompleted, CrossingTime - RaceStartTime);
+
+	if (RacerState->NumLapsCompleted >= NumLaps)
+	{
+		RacerState->FinishTime = LineRaceTime;
+		RacerState->bHasFinished = true;
+
+		FinishedRacers.Add(RacerState);
+		FinishedRacers.StableSort([](const AVehiclePlayerState& A, const AVehiclePlayerState& B)
+		{
+			return A.FinishTime < B.FinishTime;
+		});
+
+		UE_LOG(LogVehicle, Log, TEXT("%s finished in %.3fs (lag compensation %.3fs)"), *RacerState->PlayerName, RacerState->FinishTime, LagCompensation);
+		VehicleGameState->AddRaceEvent(EVehicleRaceEvent::Finish, RacerState, FinishedRacers.IndexOfByKey(RacerState) + 1, RacerState->FinishTime);
+	}
+}
+
+void AVehicleGameMode::UpdateRacePlaces()
+{
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (VehicleGameState == nullptr || !HasRaceStarted())
+	{
+		return;
+	}
+
+	VehicleGameState->UpdateRacerProgress();
+
+	const TArray<FVehicleRacerProgress>& RacerProgress = VehicleGameState->GetRacerProgress();
+	for (int32 PlaceIdx = 0; PlaceIdx < RacerProgress.Num(); PlaceIdx++)
+	{
+		RacerProgress[PlaceIdx].RacerState->RacePlace = PlaceIdx + 1;
+	}
+}
+
+const TArray<AVehiclePlayerState*>& AVehicleGameMode::GetFinishedRacers() const
+{
+	return FinishedRacers;
+}
+
 void AVehicleGameMode::Tick(float DeltaSeconds)
 {
+	AIDriving.Update(GetWorld(), DeltaSeconds);
+
 	AVehicleGameState* VehicleGameState = GetGameState<AVehicleGameState>();
 	if (VehicleGameState != nullptr)
 	{
@@ -236,23 +672,33 @@ AVehicleGameState* AVehicleGameMode::GetVehicleGameState() const
 
 void AVehicleGameMode::SetGameInfoText(const FText& InText)
 {
-	GameInfoText = InText;
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	if (VehicleGameState != nullptr)
+	{
+		VehicleGameState->SetGameInfoText(InText);
+	}
 }
 
 const FText& AVehicleGameMode::GetGameInfoText() const
 {
-	return GameInfoText;
+	AVehicleGameState* VehicleGameState = GetVehicleGameState();
+	return VehicleGameState ? VehicleGameState->GetGameInfoText() : FText::GetEmpty();
 }
 
 
 AActor* AVehicleGameMode::FindPlayerStart_Implementation(AController* Player, const FString& IncomingName)
 {
 	AVehiclePlayerController* VehicleController = Cast<AVehiclePlayerController>(Player);
+	AVehicleAIController* VehicleAI = Cast<AVehicleAIController>(Player);
 	AActor* RestartSpot = nullptr;
 	if ((VehicleController != nullptr) && (VehicleController->LastTrackPoint != nullptr))
 	{
 		RestartSpot = Cast<AActor>(VehicleController->LastTrackPoint);
 	}
+	else if ((VehicleAI != nullptr) && (VehicleAI->LastTrackPoint != nullptr))
+	{
+		RestartSpot = Cast<AActor>(VehicleAI->LastTrackPoint);
+	}
 	if (RestartSpot == nullptr)
 	{
 		RestartSpot = Super::FindPlayerStart_Implementation(Player, IncomingName);		
@@ -5,6 +5,8 @@
 #include "VehicleMenuSoundsWidgetStyle.h"
 #include "VehicleMenuWidgetStyle.h"
 #include "VehicleMenuItemWidgetStyle.h"
+#include "Streaming/VehiclePreloader.h"
+#include "Leaderboard/VehicleResultSubmitter.h"
 
 
 
@@ -15,10 +17,14 @@ class FVehicleGameModule : public FDefaultGameModuleImpl
 		//Hot reload hack
 		FSlateStyleRegistry::UnRegisterSlateStyle(FVehicleStyle::GetStyleSetName());
 		FVehicleStyle::Initialize();
+		FVehiclePreloader::Initialize();
+		FVehicleResultSubmitter::Initialize();
 	}
 
 	virtual void ShutdownModule() override
 	{
+		FVehicleResultSubmitter::Shutdown();
+		FVehiclePreloader::Shutdown();
 		FVehicleStyle::Shutdown();
 	}
 };
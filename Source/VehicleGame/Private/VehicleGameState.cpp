@@ -2,6 +2,13 @@
 
 #include "VehicleGame.h"
 #include "VehicleGameState.h"
+#include "Track/VehicleTrackPoint.h"
+#include "Track/VehicleRacingLine.h"
+#include "Streaming/VehicleStreamingGrid.h"
+#include "Streaming/VehicleGridStreamer.h"
+#include "Player/VehiclePlayerState.h"
+#include "Ghost/VehicleGhostManager.h"
+#include "UI/VehicleHUD.h"
 
 AVehicleGameState::AVehicleGameState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -9,6 +16,10 @@ AVehicleGameState::AVehicleGameState(const FObjectInitializer& ObjectInitializer
 	TotalTime = 0;
 	bTimerPaused = false;
 	bIsRaceActive = false;
+	RaceStartServerTime = 0.0f;
+	MaxRaceEvents = 64;
+	RacerProgressFrame = 0;
+	RaceEvents.Owner = this;
 	// need to tick when paused to check king state.
 	PrimaryActorTick.bCanEverTick = true;
 	SetTickableWhenPaused(true);
@@ -22,6 +33,9 @@ void AVehicleGameState::GetLifetimeReplicatedProps( TArray< FLifetimeProperty >
 	DOREPLIFETIME( AVehicleGameState, TotalTime );
 	DOREPLIFETIME( AVehicleGameState, bTimerPaused );
 	DOREPLIFETIME( AVehicleGameState, bIsRaceActive );
+	DOREPLIFETIME( AVehicleGameState, RaceStartServerTime );
+	DOREPLIFETIME( AVehicleGameState, RaceEvents );
+	DOREPLIFETIME( AVehicleGameState, GameInfoText );
 	
 }
 
@@ -33,4 +47,256 @@ float AVehicleGameState::GetTotalTime()
 bool AVehicleGameState::IsRaceActive() const
 {
 	return bIsRaceActive;
-}
\ No newline at end of file
+}
+
+void AVehicleGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	RacingLine = UVehicleRacingLine::LoadForMap(MapName);
+
+	// cells around player starts are loaded before the first vehicle spawns on them
+	StreamingGrid = UVehicleStreamingGrid::LoadForMap(MapName);
+	if (StreamingGrid)
+	{
+		GridStreamer = MakeShareable(new FVehicleGridStreamer(GetWorld(), StreamingGrid, RacingLine));
+		GridStreamer->Update(true);
+	}
+
+	// on clients HUDs may be spawned before game state replicates
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		AVehicleHUD* VehicleHUD = (PC && PC->IsLocalController()) ? Cast<AVehicleHUD>(PC->GetHUD()) : nullptr;
+		if (VehicleHUD)
+		{
+			VehicleHUD->BindRaceEvents();
+		}
+	}
+}
+
+void AVehicleGameState::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (GridStreamer.IsValid())
+	{
+		GridStreamer->Update();
+	}
+}
+
+void AVehicleGameState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (GridStreamer.IsValid())
+	{
+		GridStreamer->LogStats();
+		GridStreamer.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UVehicleRacingLine* AVehicleGameState::GetRacingLine() const
+{
+	return RacingLine;
+}
+
+FVehicleGridStreamer* AVehicleGameState::GetGridStreamer() const
+{
+	return GridStreamer.Get();
+}
+
+void AVehicleGameState::RegisterTrackPoint(AVehicleTrackPoint* TrackPoint)
+{
+	if (TrackPoint && !TrackPoints.Contains(TrackPoint))
+	{
+		TrackPoints.Add(TrackPoint);
+		TrackPoints.Sort(&AVehicleTrackPoint::IsBefore);
+	}
+}
+
+void AVehicleGameState::UnregisterTrackPoint(AVehicleTrackPoint* TrackPoint)
+{
+	TrackPoints.Remove(TrackPoint);
+}
+
+const TArray<AVehicleTrackPoint*>& AVehicleGameState::GetTrackPoints() const
+{
+	return TrackPoints;
+}
+
+AVehicleTrackPoint* AVehicleGameState::GetFinishLine() const
+{
+	for (AVehicleTrackPoint* TrackPoint : TrackPoints)
+	{
+		if (TrackPoint->bIsFinishLine)
+		{
+			return TrackPoint;
+		}
+	}
+	return TrackPoints.Num() > 0 ? TrackPoints.Last() : nullptr;
+}
+
+void AVehicleGameState::RegisterGhostManager(AVehicleGhostManager* GhostManager)
+{
+	if (GhostManager)
+	{
+		GhostManagers.AddUnique(GhostManager);
+	}
+}
+
+void AVehicleGameState::UnregisterGhostManager(AVehicleGhostManager* GhostManager)
+{
+	GhostManagers.Remove(GhostManager);
+}
+
+const TArray<AVehicleGhostManager*>& AVehicleGameState::GetGhostManagers() const
+{
+	return GhostManagers;
+}
+
+void AVehicleGameState::UpdateRacerProgress()
+{
+	if (RacerProgressFrame == GFrameCounter)
+	{
+		return;
+	}
+	RacerProgressFrame = GFrameCounter;
+
+	RacerProgress.Reset();
+
+	// vehicles first, player states don't know their pawn on clients
+	for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
+	{
+		APawn* Pawn = It->Get();
+		AVehiclePlayerState* RacerState = Pawn ? Cast<AVehiclePlayerState>(Pawn->PlayerState) : nullptr;
+		if (RacerState == nullptr || RacerState->bOnlySpectator)
+		{
+			continue;
+		}
+
+		FVehicleRacerProgress Progress;
+		Progress.RacerState = RacerState;
+		Progress.Location = Pawn->GetActorLocation();
+		Progress.DistSquaredToNext = MAX_flt;
+		Progress.bHasVehicle = true;
+		if (TrackPoints.Num() > 0)
+		{
+			const AVehicleTrackPoint* NextTrackPoint = TrackPoints[(RacerState->LastTrackPointIndex + 1) % TrackPoints.Num()];
+			Progress.DistSquaredToNext = FVector::DistSquared(Progress.Location, NextTrackPoint->GetActorLocation());
+		}
+		RacerProgress.Add(Progress);
+	}
+
+	for (APlayerState* PlayerState : PlayerArray)
+	{
+		AVehiclePlayerState* RacerState = Cast<AVehiclePlayerState>(PlayerState);
+		if (RacerState == nullptr || RacerState->bOnlySpectator || 
+			RacerProgress.ContainsByPredicate([RacerState](const FVehicleRacerProgress& Progress) { return Progress.RacerState == RacerState; }))
+		{
+			continue;
+		}
+
+		FVehicleRacerProgress Progress;
+		Progress.RacerState = RacerState;
+		Progress.Location = FVector::ZeroVector;
+		Progress.DistSquaredToNext = MAX_flt;
+		Progress.bHasVehicle = false;
+		RacerProgress.Add(Progress);
+	}
+
+	RacerProgress.Sort([](const FVehicleRacerProgress& A, const FVehicleRacerProgress& B)
+	{
+		if (A.RacerState->bHasFinished != B.RacerState->bHasFinished)
+		{
+			return A.RacerState->bHasFinished;
+		}
+		if (A.RacerState->bHasFinished)
+		{
+			return A.RacerState->FinishTime < B.RacerState->FinishTime;
+		}
+		if (A.RacerState->NumTrackPointsPassed != B.RacerState->NumTrackPointsPassed)
+		{
+			return A.RacerState->NumTrackPointsPassed > B.RacerState->NumTrackPointsPassed;
+		}
+		return A.DistSquaredToNext < B.DistSquaredToNext;
+	});
+}
+
+const TArray<FVehicleRacerProgress>& AVehicleGameState::GetRacerProgress() const
+{
+	return RacerProgress;
+}
+
+void AVehicleGameState::AddRaceEvent(EVehicleRaceEvent::Type Type, APlayerState* Racer, int32 Value, float RaceTime, const FText& Text)
+{
+	FVehicleRaceEvent& NewEvent = RaceEvents.Events[RaceEvents.Events.AddDefaulted()];
+	NewEvent.Type = Type;
+	NewEvent.Racer = Racer;
+	NewEvent.Value = Value;
+	NewEvent.RaceTime = RaceTime;
+	NewEvent.Text = Text;
+	NewEvent.ServerTime = GetServerWorldTimeSeconds();
+	RaceEvents.MarkItemDirty(NewEvent);
+
+	// copy before trimming, the new event may move
+	const FVehicleRaceEvent EventCopy = NewEvent;
+
+	const int32 NumToDrop = RaceEvents.Events.Num() - FMath::Max(MaxRaceEvents, 1);
+	if (NumToDrop > 0)
+	{
+		RaceEvents.Events.RemoveAt(0, NumToDrop, false);
+		RaceEvents.MarkArrayDirty();
+	}
+
+	OnRaceEvent.Broadcast(EventCopy);
+}
+
+const TArray<FVehicleRaceEvent>& AVehicleGameState::GetRaceEvents() const
+{
+	return RaceEvents.Events;
+}
+
+void AVehicleGameState::ResetRace()
+{
+	bIsRaceActive = false;
+	bTimerPaused = false;
+	RaceStartServerTime = 0.0f;
+	TotalTime = 0.0f;
+	RacerProgress.Reset();
+	RacerProgressFrame = 0;
+
+	RaceEvents.Events.Reset();
+	RaceEvents.MarkArrayDirty();
+	AddRaceEvent(EVehicleRaceEvent::RaceReset, nullptr, 0, 0.0f);
+	SetGameInfoText(FText::GetEmpty());
+}
+
+void AVehicleGameState::SetGameInfoText(const FText& InText)
+{
+	if (!GameInfoText.EqualTo(InText))
+	{
+		GameInfoText = InText;
+		AddRaceEvent(EVehicleRaceEvent::InfoText, nullptr, 0, TotalTime, InText);
+	}
+}
+
+const FText& AVehicleGameState::GetGameInfoText() const
+{
+	return GameInfoText;
+}
+
+/** replicated race events older than this are history, s */
+static const float RaceEventHistoryAge = 2.0f;
+
+void FVehicleRaceEvent::PostReplicatedAdd(const FVehicleRaceEventArray& InArraySerializer)
+{
+	AVehicleGameState* Owner = InArraySerializer.Owner;
+	if (Owner)
+	{
+		// late joiners receive the whole log before game state begins play, server time is known only after that
+		bIsHistory = !Owner->HasActorBegunPlay() || Owner->GetServerWorldTimeSeconds() - ServerTime > RaceEventHistoryAge;
+		Owner->OnRaceEvent.Broadcast(*this);
+	}
+}
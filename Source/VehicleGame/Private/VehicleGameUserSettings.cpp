@@ -2,6 +2,8 @@
 
 #include "VehicleGame.h"
 #include "VehicleGameUserSettings.h"
+#include "GameFramework/InputSettings.h"
+#include "Async/Async.h"
 
 static const auto StaticCVar = IConsoleManager::Get().RegisterConsoleVariable
 	(
@@ -17,6 +19,7 @@ static const auto StaticCVar = IConsoleManager::Get().RegisterConsoleVariable
 UVehicleGameUserSettings::UVehicleGameUserSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	NumSplitscreenViews = 1;
 	SetToDefaults();
 }
 
@@ -28,60 +31,217 @@ void UVehicleGameUserSettings::SetToDefaults()
 	MouseSensitivity = 1.0f;
 
 	GraphicsQuality = 1;
+	bSplitscreenQualityScaling = true;
 }
 
 void UVehicleGameUserSettings::ApplySettings(bool bCheckForCommandLineOverrides)
 {
 	Super::ApplySettings(bCheckForCommandLineOverrides);
 
-	// Graphics Quality
-	{
-		auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("samplegame.graphics.quality"));
-		const int CVarValue = CVar->GetValueOnGameThread();
-
-		int LocalGraphicsQuality = 0;
+	ApplyGraphicsQuality();
 
-		if( CVarValue == -1 )
+	TArray<APlayerController*> PlayerList;
+	GEngine->GetAllLocalPlayerControllers(PlayerList);
+	for (auto It = PlayerList.CreateIterator(); It; ++It)
+	{
+		APlayerController* PC = *It;
+		if (!PC || !PC->PlayerInput)
 		{
-			LocalGraphicsQuality = GraphicsQuality;
+			continue;
 		}
-		else
+
+		//set the mouse sensitivity
+		PC->PlayerInput->SetMouseSensitivity(GetMouseSensitivity());
+
+		//invert it, and if does not equal our bool, invert it again
+		if(PC->PlayerInput->GetInvertAxis("Lookup") != GetInvertedMouse())
 		{
-			LocalGraphicsQuality = FMath::Clamp(CVarValue, 0, 1);
+			PC->PlayerInput->InvertAxis("Lookup");
 		}
+	}
+}
+
+void UVehicleGameUserSettings::ApplyGraphicsQuality()
+{
+	auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("samplegame.graphics.quality"));
+	const int CVarValue = CVar->GetValueOnGameThread();
+
+	int LocalGraphicsQuality = 0;
+
+	if( CVarValue == -1 )
+	{
+		LocalGraphicsQuality = GraphicsQuality;
+	}
+	else
+	{
+		LocalGraphicsQuality = FMath::Clamp(CVarValue, 0, 1);
+	}
+
+	UE_LOG(LogConsoleResponse, Display, TEXT("  GraphicsQuality %d"), LocalGraphicsQuality);
+
+	if( LocalGraphicsQuality == 0 )
+	{
+		SetLowQuality();
+	}
+	else if( LocalGraphicsQuality == 1 )
+	{
+		SetHighQuality();
+	}
+
+	ApplySplitscreenScaling();
+}
+
+void UVehicleGameUserSettings::SetNumSplitscreenViews(int32 InNumViews)
+{
+	InNumViews = FMath::Max(InNumViews, 1);
+	if (NumSplitscreenViews != InNumViews)
+	{
+		NumSplitscreenViews = InNumViews;
+		ApplyGraphicsQuality();
+	}
+}
+
+void UVehicleGameUserSettings::ApplySplitscreenScaling()
+{
+	// every view covers a fraction of the screen but costs a full scene traversal,
+	// so trade resolution, draw distance, shadow cascades and particles for view count
+	float ResolutionScale = 1.0f;
+	float DetailScale = 1.0f;
+	if (bSplitscreenQualityScaling && NumSplitscreenViews > 1)
+	{
+		ResolutionScale = NumSplitscreenViews == 2 ? 0.85f : 0.7f;
+		DetailScale = NumSplitscreenViews == 2 ? 0.75f : 0.5f;
+	}
+
+	IConsoleVariable* CScreenPercentage = IConsoleManager::Get().FindConsoleVariable(TEXT("r.ScreenPercentage"));
+	IConsoleVariable* CVarViewDistanceScale = IConsoleManager::Get().FindConsoleVariable(TEXT("r.ViewDistanceScale"));
+	IConsoleVariable* CVarCascades = IConsoleManager::Get().FindConsoleVariable(TEXT("r.Shadow.CSM.MaxCascades"));
+	IConsoleVariable* CVarEmitterSpawnRate = IConsoleManager::Get().FindConsoleVariable(TEXT("r.EmitterSpawnRateScale"));
+	CScreenPercentage->Set(CScreenPercentage->GetFloat() * ResolutionScale);
+	CVarViewDistanceScale->Set(CVarViewDistanceScale->GetFloat() * DetailScale);
+	CVarCascades->Set(FMath::Max(FMath::RoundToInt(CVarCascades->GetInt() * DetailScale), 1));
+	CVarEmitterSpawnRate->Set(DetailScale);
+
+	UE_LOG(LogConsoleResponse, Display, TEXT("  Splitscreen views %d, resolution scale %.2f, detail scale %.2f"), NumSplitscreenViews, ResolutionScale, DetailScale);
+
+	IConsoleManager::Get().CallAllConsoleVariableSinks();
+}
+
+void UVehicleGameUserSettings::RequestDeferredSave(float Delay)
+{
+	// ticker keeps running while game is paused in menus, unlike world timers
+	FTicker::GetCoreTicker().RemoveTicker(DeferredSaveHandle);
+	DeferredSaveHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UVehicleGameUserSettings::DeferredSave), Delay);
+
+	if (!PreExitHandle.IsValid())
+	{
+		PreExitHandle = FCoreDelegates::OnPreExit.AddUObject(this, &UVehicleGameUserSettings::FlushDeferredSave);
+	}
+}
+
+void UVehicleGameUserSettings::FlushDeferredSave()
+{
+	if (DeferredSaveHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(DeferredSaveHandle);
+		DeferredSave(0.0f);
+	}
+
+	if (PendingWrite.IsValid())
+	{
+		PendingWrite.Wait();
+	}
+}
 
-		UE_LOG(LogConsoleResponse, Display, TEXT("  GraphicsQuality %d"), LocalGraphicsQuality);
+FString UVehicleGameUserSettings::BuildIniText(const FConfigFile& ConfigFile)
+{
+	// like FConfigFile::Write, only values that differ from the default hierarchy go to saved file,
+	// so later changes of default ini files still reach the user
+	FString Text;
+	for (const TPair<FString, FConfigSection>& Section : ConfigFile)
+	{
+		const FConfigSection* SourceSection = ConfigFile.SourceConfigFile ? ConfigFile.SourceConfigFile->Find(Section.Key) : nullptr;
+		FString SectionText;
 
-		if( LocalGraphicsQuality == 0 )
+		TArray<FName> Keys;
+		Section.Value.GetKeys(Keys);
+		for (const FName& Key : Keys)
 		{
-			SetLowQuality();
+			TArray<FConfigValue> Values;
+			Section.Value.MultiFind(Key, Values, true);
+
+			TArray<FConfigValue> SourceValues;
+			if (SourceSection)
+			{
+				SourceSection->MultiFind(Key, SourceValues, true);
+			}
+
+			bool bMatchesSource = Values.Num() == SourceValues.Num();
+			for (int32 ValueIdx = 0; bMatchesSource && ValueIdx < Values.Num(); ValueIdx++)
+			{
+				bMatchesSource = Values[ValueIdx].GetSavedValue() == SourceValues[ValueIdx].GetSavedValue();
+			}
+			if (bMatchesSource)
+			{
+				continue;
+			}
+
+			// changed arrays replace the default ones
+			const bool bIsArray = Values.Num() > 1 || SourceValues.Num() > 1;
+			if (bIsArray)
+			{
+				SectionText += FString::Printf(TEXT("!%s=ClearArray") LINE_TERMINATOR, *Key.ToString());
+			}
+			for (const FConfigValue& Value : Values)
+			{
+				SectionText += FString::Printf(TEXT("%s%s=%s") LINE_TERMINATOR, bIsArray ? TEXT(".") : TEXT(""), *Key.ToString(), *Value.GetSavedValue());
+			}
 		}
-		else if( LocalGraphicsQuality == 1 )
+
+		if (!SectionText.IsEmpty())
 		{
-			SetHighQuality();
+			Text += FString::Printf(TEXT("[%s]") LINE_TERMINATOR, *Section.Key) + SectionText + LINE_TERMINATOR;
 		}
 	}
+	return Text;
+}
 
+bool UVehicleGameUserSettings::DeferredSave(float DeltaTime)
+{
+	DeferredSaveHandle.Reset();
 
-	TArray<APlayerController*> PlayerList;
-	GEngine->GetAllLocalPlayerControllers(PlayerList);
-	for (auto It = PlayerList.CreateIterator(); It; ++It)
+	// update config cache only, files are written from text built below
+	GConfig->DisableFileOperations();
+	SaveSettings();
+	GetMutableDefault<UInputSettings>()->SaveKeyMappings();
+	GConfig->EnableFileOperations();
+
+	FConfigFile* UserSettingsFile = GConfig->Find(GGameUserSettingsIni, false);
+	FConfigFile* InputFile = GConfig->Find(GInputIni, false);
+	if (UserSettingsFile && InputFile)
 	{
-		APlayerController* PC = *It;
-		if (!PC || !PC->PlayerInput)
+		// one write at a time, so older text never overwrites newer
+		if (PendingWrite.IsValid())
 		{
-			continue;
+			PendingWrite.Wait();
 		}
 
-		//set the mouse sensitivity
-		PC->PlayerInput->SetMouseSensitivity(GetMouseSensitivity());
+		// config files never leave the game thread, and are clean now so GConfig->Flush doesn't write them alongside the worker
+		FString UserSettingsText = BuildIniText(*UserSettingsFile);
+		FString InputText = BuildIniText(*InputFile);
+		UserSettingsFile->Dirty = false;
+		InputFile->Dirty = false;
 
-		//invert it, and if does not equal our bool, invert it again
-		if(PC->PlayerInput->GetInvertAxis("Lookup") != GetInvertedMouse())
+		TFunction<void()> WriteFiles = [UserSettingsText = MoveTemp(UserSettingsText), InputText = MoveTemp(InputText), UserSettingsFilename = GGameUserSettingsIni, InputFilename = GInputIni]()
 		{
-			PC->PlayerInput->InvertAxis("Lookup");
-		}
+			FFileHelper::SaveStringToFile(UserSettingsText, *UserSettingsFilename);
+			FFileHelper::SaveStringToFile(InputText, *InputFilename);
+		};
+		PendingWrite = Async<void>(EAsyncExecution::ThreadPool, MoveTemp(WriteFiles));
 	}
+
+	// don't repeat
+	return false;
 }
 
 bool UVehicleGameUserSettings::IsMouseSensitivityDirty() const
@@ -2,6 +2,40 @@
 
 #include "VehicleGame.h"
 #include "VehicleGameViewportClient.h"
+#include "VehicleGameUserSettings.h"
+
+/** add or remove local players to measure split-screen cost */
+static void SetSplitscreenPlayers(const TArray<FString>& Args, UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (GameInstance == nullptr || Args.Num() < 1)
+	{
+		UE_LOG(LogVehicle, Display, TEXT("Usage: vehicle.SplitscreenPlayers NumPlayers"));
+		return;
+	}
+
+	const int32 NumPlayers = FMath::Clamp(FCString::Atoi(*Args[0]), 1, 4);
+	while (GameInstance->GetNumLocalPlayers() < NumPlayers)
+	{
+		FString Error;
+		if (GameInstance->CreateLocalPlayer(GameInstance->GetNumLocalPlayers(), Error, true) == nullptr)
+		{
+			UE_LOG(LogVehicle, Warning, TEXT("Can't add local player: %s"), *Error);
+			return;
+		}
+	}
+	while (GameInstance->GetNumLocalPlayers() > NumPlayers)
+	{
+		GameInstance->RemoveLocalPlayer(GameInstance->GetLocalPlayerByIndex(GameInstance->GetNumLocalPlayers() - 1));
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("%d local players, compare with 'stat unit' and 'stat VehicleGame'"), NumPlayers);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SetSplitscreenPlayersCmd(
+	TEXT("vehicle.SplitscreenPlayers"),
+	TEXT("Adds or removes local split-screen players. Usage: vehicle.SplitscreenPlayers NumPlayers"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SetSplitscreenPlayers));
 
 UVehicleGameViewportClient::UVehicleGameViewportClient(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -9,6 +43,29 @@ UVehicleGameViewportClient::UVehicleGameViewportClient(const FObjectInitializer&
 	SetSuppressTransitionMessage(true);
 }
 
+void UVehicleGameViewportClient::NotifyPlayerAdded(int32 PlayerIndex, ULocalPlayer* AddedPlayer)
+{
+	Super::NotifyPlayerAdded(PlayerIndex, AddedPlayer);
+
+	UpdateSplitscreenQuality();
+}
+
+void UVehicleGameViewportClient::NotifyPlayerRemoved(int32 PlayerIndex, ULocalPlayer* RemovedPlayer)
+{
+	Super::NotifyPlayerRemoved(PlayerIndex, RemovedPlayer);
+
+	UpdateSplitscreenQuality();
+}
+
+void UVehicleGameViewportClient::UpdateSplitscreenQuality()
+{
+	UVehicleGameUserSettings* UserSettings = GEngine ? Cast<UVehicleGameUserSettings>(GEngine->GetGameUserSettings()) : nullptr;
+	if (UserSettings && GetGameInstance())
+	{
+		UserSettings->SetNumSplitscreenViews(IsSplitscreenForceDisabled() ? 1 : GetGameInstance()->GetNumLocalPlayers());
+	}
+}
+
 #if WITH_EDITOR
 void UVehicleGameViewportClient::DrawTransition(UCanvas* Canvas)
 {
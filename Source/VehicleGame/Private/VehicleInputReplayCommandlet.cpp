@@ -0,0 +1,152 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "VehicleInputReplayCommandlet.h"
+#include "Player/VehicleInputReplay.h"
+
+UVehicleInputReplayCommandlet::UVehicleInputReplayCommandlet(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UVehicleInputReplayCommandlet::Main(const FString& Params)
+{
+	TArray<FString> MapNames;
+	FString MapsParam;
+	if (FParse::Value(*Params, TEXT("Maps="), MapsParam))
+	{
+		MapsParam.ParseIntoArray(MapNames, TEXT("+"));
+	}
+	else
+	{
+		// every map with a recorded input log or golden file, a map with only one of them fails below
+		TArray<FString> TestFiles;
+		IFileManager::Get().FindFiles(TestFiles, *FVehicleInputReplay::GetInputLogFilename(TEXT("*")), true, false);
+		IFileManager::Get().FindFiles(TestFiles, *FVehicleInputReplay::GetGoldenFilename(TEXT("*")), true, false);
+		for (const FString& TestFile : TestFiles)
+		{
+			MapNames.AddUnique(FPaths::GetBaseFilename(TestFile));
+		}
+	}
+
+	// an empty suite must not pass
+	if (MapNames.Num() == 0)
+	{
+		UE_LOG(LogVehicle, Error, TEXT("No input logs found in %s, record one with -VehicleInputRecord"), *FPaths::GetPath(FVehicleInputReplay::GetInputLogFilename(TEXT("*"))));
+		return 1;
+	}
+
+	TArray<FString> FailedMaps;
+	for (const FString& MapName : MapNames)
+	{
+		const bool bHasInputLog = IFileManager::Get().FileExists(*FVehicleInputReplay::GetInputLogFilename(MapName));
+		const bool bHasGolden = IFileManager::Get().FileExists(*FVehicleInputReplay::GetGoldenFilename(MapName));
+		if (!bHasInputLog || !bHasGolden)
+		{
+			UE_LOG(LogVehicle, Error, TEXT("%s: failed, %s missing"), *MapName, !bHasInputLog ? TEXT("input log") : TEXT("golden file"));
+			FailedMaps.Add(MapName);
+		}
+	}
+	const int32 NumMaps = MapNames.Num();
+	MapNames.RemoveAll([&FailedMaps](const FString& MapName) { return FailedMaps.Contains(MapName); });
+
+	int32 MaxParallel = FPlatformMisc::NumberOfCores();
+	FParse::Value(*Params, TEXT("Parallel="), MaxParallel);
+	MaxParallel = FMath::Max(1, MaxParallel);
+
+	float Timeout = 600.0f;
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+
+	int32 FPS = 60;
+	FParse::Value(*Params, TEXT("FPS="), FPS);
+
+	struct FMapRun
+	{
+		FString MapName;
+		FProcHandle Process;
+		double StartTime;
+	};
+
+	const FString Executable = FPlatformProcess::ExecutablePath();
+	const FString ProjectFile = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	const double SuiteStartTime = FPlatformTime::Seconds();
+
+	TArray<FMapRun> Runs;
+	int32 NextMapIdx = 0;
+
+	while (NextMapIdx < MapNames.Num() || Runs.Num() > 0)
+	{
+		while (NextMapIdx < MapNames.Num() && Runs.Num() < MaxParallel)
+		{
+			const FString& MapName = MapNames[NextMapIdx++];
+			const FString ResultFile = FVehicleInputReplay::GetResultFilename(MapName);
+			IFileManager::Get().Delete(*ResultFile, false, true, true);
+
+			const FString LogFile = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("InputReplay") / MapName + TEXT(".log"));
+			const FString Args = FString::Printf(TEXT("\"%s\" %s -game -nullrhi -nosound -unattended -nosplash -benchmark -fps=%d -VehicleInputReplay -abslog=\"%s\""),
+				*ProjectFile, *MapName, FPS, *LogFile);
+
+			FMapRun Run;
+			Run.MapName = MapName;
+			Run.Process = FPlatformProcess::CreateProc(*Executable, *Args, false, true, true, nullptr, 0, nullptr, nullptr);
+			Run.StartTime = FPlatformTime::Seconds();
+			if (!Run.Process.IsValid())
+			{
+				UE_LOG(LogVehicle, Error, TEXT("%s: failed to launch %s"), *MapName, *Executable);
+				FailedMaps.Add(MapName);
+				continue;
+			}
+
+			UE_LOG(LogVehicle, Display, TEXT("%s: replaying"), *MapName);
+			Runs.Add(Run);
+		}
+
+		for (int32 RunIdx = Runs.Num() - 1; RunIdx >= 0; RunIdx--)
+		{
+			FMapRun& Run = Runs[RunIdx];
+			const bool bTimedOut = FPlatformTime::Seconds() - Run.StartTime > Timeout;
+			if (FPlatformProcess::IsProcRunning(Run.Process) && !bTimedOut)
+			{
+				continue;
+			}
+
+			if (bTimedOut)
+			{
+				FPlatformProcess::TerminateProc(Run.Process, true);
+			}
+			FPlatformProcess::CloseProc(Run.Process);
+
+			FString Result, Reason, Outcome;
+			int32 FirstMismatchTick = INDEX_NONE;
+			const bool bHasResult = FFileHelper::LoadFileToString(Result, *FVehicleInputReplay::GetResultFilename(Run.MapName));
+			FParse::Value(*Result, TEXT("Result="), Outcome);
+			FParse::Value(*Result, TEXT("Reason="), Reason);
+			FParse::Value(*Result, TEXT("FirstMismatchTick="), FirstMismatchTick);
+
+			if (bHasResult && Outcome == TEXT("Passed"))
+			{
+				UE_LOG(LogVehicle, Display, TEXT("%s: passed in %.1fs"), *Run.MapName, FPlatformTime::Seconds() - Run.StartTime);
+			}
+			else
+			{
+				FString LapTimes, GoldenLapTimes;
+				FParse::Value(*Result, TEXT("LapTimes="), LapTimes);
+				FParse::Value(*Result, TEXT("GoldenLapTimes="), GoldenLapTimes);
+
+				UE_LOG(LogVehicle, Error, TEXT("%s: failed (%s), first mismatching tick %d, lap times [%s] golden [%s]"), *Run.MapName,
+					bTimedOut ? TEXT("timed out") : bHasResult ? *Reason : TEXT("no result, game crashed?"), FirstMismatchTick, *LapTimes, *GoldenLapTimes);
+				FailedMaps.Add(Run.MapName);
+			}
+
+			Runs.RemoveAtSwap(RunIdx);
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("Input replay: %d of %d maps passed in %.1fs"), NumMaps - FailedMaps.Num(), NumMaps, FPlatformTime::Seconds() - SuiteStartTime);
+	return FailedMaps.Num() > 0 ? 1 : 0;
+}
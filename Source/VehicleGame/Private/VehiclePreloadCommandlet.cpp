@@ -0,0 +1,141 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "VehiclePreloadCommandlet.h"
+#include "Streaming/VehiclePreloadManifest.h"
+#include "Streaming/VehiclePreloader.h"
+
+UVehiclePreloadCommandlet::UVehiclePreloadCommandlet(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	MinRuns = 1;
+	MaxTime = 600.0f;
+}
+
+int32 UVehiclePreloadCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FParse::Value(*Params, TEXT("MinRuns="), MinRuns);
+	FParse::Value(*Params, TEXT("MaxTime="), MaxTime);
+	MinRuns = FMath::Max(MinRuns, 1);
+
+	TArray<FString> MapNames;
+	FString MapsParam;
+	if (FParse::Value(*Params, TEXT("Maps="), MapsParam))
+	{
+		MapsParam.ParseIntoArray(MapNames, TEXT("+"));
+	}
+	else
+	{
+		IFileManager::Get().FindFiles(MapNames, *FVehiclePreloader::GetRecordingDir(TEXT("*")), false, true);
+	}
+
+	int32 NumBaked = 0;
+	for (const FString& MapName : MapNames)
+	{
+		NumBaked += BakeMap(FPackageName::GetShortName(MapName)) ? 1 : 0;
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("Preload manifests baked for %d of %d maps"), NumBaked, MapNames.Num());
+	return (MapNames.Num() > 0 && NumBaked == MapNames.Num()) ? 0 : 1;
+#else
+	UE_LOG(LogVehicle, Error, TEXT("Preload manifests can only be baked by editor builds"));
+	return 1;
+#endif
+}
+
+bool UVehiclePreloadCommandlet::BakeMap(const FString& MapName)
+{
+#if WITH_EDITOR
+	const FString RecordingDir = FVehiclePreloader::GetRecordingDir(MapName);
+	TArray<FString> RunFiles;
+	IFileManager::Get().FindFiles(RunFiles, *(RecordingDir / TEXT("*.csv")), true, false);
+	if (RunFiles.Num() == 0)
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("%s: no recorded runs in %s"), *MapName, *RecordingDir);
+		return false;
+	}
+
+	// earliest use and number of runs of every asset
+	TMap<FString, TPair<float, int32>> Uses;
+	for (const FString& RunFile : RunFiles)
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *(RecordingDir / RunFile));
+
+		TSet<FString> SeenInRun;
+		for (const FString& Line : Lines)
+		{
+			FString TimeString;
+			FString Path;
+			if (!Line.Split(TEXT(","), &TimeString, &Path) || Path.IsEmpty() || SeenInRun.Contains(Path))
+			{
+				continue;
+			}
+			SeenInRun.Add(Path);
+
+			const float UseTime = FCString::Atof(*TimeString);
+			TPair<float, int32>* Use = Uses.Find(Path);
+			if (Use)
+			{
+				Use->Key = FMath::Min(Use->Key, UseTime);
+				Use->Value++;
+			}
+			else
+			{
+				Uses.Add(Path, TPair<float, int32>(UseTime, 1));
+			}
+		}
+	}
+
+	// assets renamed or deleted since recording would only log warnings at load
+	TArray<TPair<float, FString>> Entries;
+	for (const TPair<FString, TPair<float, int32>>& Use : Uses)
+	{
+		const FSoftObjectPath Path(Use.Key);
+		if (Use.Value.Value >= MinRuns && Use.Value.Key <= MaxTime && FPackageName::DoesPackageExist(Path.GetLongPackageName()))
+		{
+			Entries.Add(TPair<float, FString>(Use.Value.Key, Use.Key));
+		}
+	}
+	Entries.Sort([](const TPair<float, FString>& A, const TPair<float, FString>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	const FString PackageName = UVehiclePreloadManifest::GetPackageName(MapName);
+	const FString AssetName = FPackageName::GetShortName(PackageName);
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->FullyLoad();
+
+	UVehiclePreloadManifest* Manifest = FindObject<UVehiclePreloadManifest>(Package, *AssetName);
+	if (Manifest == nullptr)
+	{
+		Manifest = NewObject<UVehiclePreloadManifest>(Package, *AssetName, RF_Public | RF_Standalone);
+	}
+
+	Manifest->Assets.Reset(Entries.Num());
+	Manifest->FirstUseTimes.Reset(Entries.Num());
+	for (const TPair<float, FString>& Entry : Entries)
+	{
+		Manifest->Assets.Add(FSoftObjectPath(Entry.Value));
+		Manifest->FirstUseTimes.Add(Entry.Key);
+	}
+	Package->MarkPackageDirty();
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	const bool bSaved = UPackage::SavePackage(Package, Manifest, RF_Public | RF_Standalone, *Filename, GError, nullptr, false, true, SAVE_NoError);
+
+	UE_LOG(LogVehicle, Display, TEXT("%s: %d runs, %d assets recorded, %d kept, %s"),
+		*MapName, RunFiles.Num(), Uses.Num(), Entries.Num(), bSaved ? TEXT("saved") : TEXT("failed to save"));
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return bSaved;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,292 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "VehicleRacingLineCommandlet.h"
+#include "Track/VehicleRacingLine.h"
+#include "Track/VehicleTrackPoint.h"
+#include "Async/ParallelFor.h"
+
+UVehicleRacingLineCommandlet::UVehicleRacingLineCommandlet(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	SampleSpacing = 200.0f;
+	LengthWeight = 0.0f;
+	EdgeMargin = 200.0f;
+	MaxIterations = 20000;
+	Tolerance = 0.01f;
+	MaxSpeed = 3000.0f;
+	LateralAcceleration = 800.0f;
+	Acceleration = 500.0f;
+	BrakingDeceleration = 1200.0f;
+}
+
+int32 UVehicleRacingLineCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FParse::Value(*Params, TEXT("Spacing="), SampleSpacing);
+	FParse::Value(*Params, TEXT("LengthWeight="), LengthWeight);
+	FParse::Value(*Params, TEXT("EdgeMargin="), EdgeMargin);
+	FParse::Value(*Params, TEXT("MaxIterations="), MaxIterations);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	FParse::Value(*Params, TEXT("MaxSpeed="), MaxSpeed);
+	FParse::Value(*Params, TEXT("LateralAcceleration="), LateralAcceleration);
+	FParse::Value(*Params, TEXT("Acceleration="), Acceleration);
+	FParse::Value(*Params, TEXT("BrakingDeceleration="), BrakingDeceleration);
+	SampleSpacing = FMath::Max(SampleSpacing, 10.0f);
+
+	TArray<FString> MapPackageNames;
+	FString MapsParam;
+	if (FParse::Value(*Params, TEXT("Maps="), MapsParam))
+	{
+		TArray<FString> MapNames;
+		MapsParam.ParseIntoArray(MapNames, TEXT("+"));
+		for (const FString& MapName : MapNames)
+		{
+			MapPackageNames.Add(FPackageName::IsShortPackageName(MapName) ? TEXT("/Game/Maps/") + MapName : MapName);
+		}
+	}
+	else
+	{
+		TArray<FString> MapFiles;
+		FPackageName::FindPackagesInDirectory(MapFiles, FPaths::ProjectContentDir() / TEXT("Maps"));
+		for (const FString& MapFile : MapFiles)
+		{
+			if (FPaths::GetExtension(MapFile, true) == FPackageName::GetMapPackageExtension())
+			{
+				MapPackageNames.Add(FPackageName::FilenameToLongPackageName(MapFile));
+			}
+		}
+	}
+
+	int32 NumBaked = 0;
+	for (const FString& MapPackageName : MapPackageNames)
+	{
+		NumBaked += BakeMap(MapPackageName) ? 1 : 0;
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("Racing lines baked for %d of %d maps"), NumBaked, MapPackageNames.Num());
+	return (MapPackageNames.Num() > 0 && NumBaked == MapPackageNames.Num()) ? 0 : 1;
+#else
+	UE_LOG(LogVehicle, Error, TEXT("Racing lines can only be baked by editor builds"));
+	return 1;
+#endif
+}
+
+bool UVehicleRacingLineCommandlet::BakeMap(const FString& MapPackageName)
+{
+#if WITH_EDITOR
+	const FString MapName = FPackageName::GetShortName(MapPackageName);
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (World == nullptr)
+	{
+		UE_LOG(LogVehicle, Error, TEXT("%s: failed to load map"), *MapName);
+		return false;
+	}
+
+	// collision is needed to drop the line onto the landscape
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	TArray<AVehicleTrackPoint*> TrackPoints;
+	for (TActorIterator<AVehicleTrackPoint> It(World); It; ++It)
+	{
+		TrackPoints.Add(*It);
+	}
+	TrackPoints.Sort(&AVehicleTrackPoint::IsBefore);
+
+	const int32 NumTrackPoints = TrackPoints.Num();
+	if (NumTrackPoints < 3)
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("%s: needs at least 3 track points, found %d"), *MapName, NumTrackPoints);
+		World->RemoveFromRoot();
+		World->CleanupWorld();
+		return false;
+	}
+
+	// centerline: closed Catmull-Rom spline through gate centers, corridor narrows from gate to gate
+	TArray<FVector> Centers;
+	TArray<FVector> Normals;
+	TArray<float> HalfWidths;
+	for (int32 TrackPointIdx = 0; TrackPointIdx < NumTrackPoints; TrackPointIdx++)
+	{
+		const FVector P0 = TrackPoints[(TrackPointIdx + NumTrackPoints - 1) % NumTrackPoints]->GetActorLocation();
+		const FVector P1 = TrackPoints[TrackPointIdx]->GetActorLocation();
+		const FVector P2 = TrackPoints[(TrackPointIdx + 1) % NumTrackPoints]->GetActorLocation();
+		const FVector P3 = TrackPoints[(TrackPointIdx + 2) % NumTrackPoints]->GetActorLocation();
+		const float StartHalfWidth = TrackPoints[TrackPointIdx]->GetTriggerComponent()->GetScaledBoxExtent().Y;
+		const float EndHalfWidth = TrackPoints[(TrackPointIdx + 1) % NumTrackPoints]->GetTriggerComponent()->GetScaledBoxExtent().Y;
+
+		const int32 NumSegmentSamples = FMath::Max(FMath::CeilToInt(FVector::Dist(P1, P2) / SampleSpacing), 1);
+		for (int32 SampleIdx = 0; SampleIdx < NumSegmentSamples; SampleIdx++)
+		{
+			const float T = (float)SampleIdx / NumSegmentSamples;
+			const float T2 = T * T;
+			const float T3 = T2 * T;
+			const FVector Center = 0.5f * ((2.0f * P1) + (P2 - P0) * T + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * T2 + (3.0f * P1 - P0 - 3.0f * P2 + P3) * T3);
+			const FVector Tangent = 0.5f * ((P2 - P0) + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * (2.0f * T) + (3.0f * P1 - P0 - 3.0f * P2 + P3) * (3.0f * T2));
+
+			Centers.Add(Center);
+			Normals.Add(FVector(-Tangent.Y, Tangent.X, 0.0f).GetSafeNormal());
+			HalfWidths.Add(FMath::Max(FMath::Lerp(StartHalfWidth, EndHalfWidth, T) - EdgeMargin, 0.0f));
+		}
+	}
+
+	// projected damped Jacobi on sum of squared second differences (+ length), every sample only moves sideways within its corridor
+	const int32 NumSamples = Centers.Num();
+	TArray<float> Offsets;
+	TArray<float> NewOffsets;
+	TArray<float> Changes;
+	Offsets.SetNumZeroed(NumSamples);
+	NewOffsets.SetNumZeroed(NumSamples);
+	Changes.SetNumZeroed(NumSamples);
+
+	auto GetPoint = [&](const TArray<float>& InOffsets, int32 Index)
+	{
+		Index = (Index % NumSamples + NumSamples) % NumSamples;
+		return Centers[Index] + Normals[Index] * InOffsets[Index];
+	};
+
+	const float Damping = 0.5f;
+	const float Diagonal = 6.0f + 2.0f * LengthWeight;
+	int32 NumIterations = 0;
+	float MaxChange = MAX_flt;
+	const double OptimizeStart = FPlatformTime::Seconds();
+	for (; NumIterations < MaxIterations && MaxChange > Tolerance; NumIterations++)
+	{
+		ParallelFor(NumSamples, [&](int32 SampleIdx)
+		{
+			const FVector PrevPrev = GetPoint(Offsets, SampleIdx - 2);
+			const FVector Prev = GetPoint(Offsets, SampleIdx - 1);
+			const FVector Current = GetPoint(Offsets, SampleIdx);
+			const FVector Next = GetPoint(Offsets, SampleIdx + 1);
+			const FVector NextNext = GetPoint(Offsets, SampleIdx + 2);
+
+			const FVector CurvatureGradient = PrevPrev - 4.0f * Prev + 6.0f * Current - 4.0f * Next + NextNext;
+			const FVector LengthGradient = 2.0f * Current - Prev - Next;
+			const float Step = Damping * ((CurvatureGradient + LengthWeight * LengthGradient) | Normals[SampleIdx]) / Diagonal;
+
+			NewOffsets[SampleIdx] = FMath::Clamp(Offsets[SampleIdx] - Step, -HalfWidths[SampleIdx], HalfWidths[SampleIdx]);
+			Changes[SampleIdx] = FMath::Abs(NewOffsets[SampleIdx] - Offsets[SampleIdx]);
+		});
+
+		Swap(Offsets, NewOffsets);
+		MaxChange = 0.0f;
+		for (float Change : Changes)
+		{
+			MaxChange = FMath::Max(MaxChange, Change);
+		}
+	}
+	const double OptimizeTime = FPlatformTime::Seconds() - OptimizeStart;
+
+	// resample at even spacing, so runtime lookups by distance are a single index
+	TArray<FVector> LinePoints;
+	{
+		FVector SegmentStart = GetPoint(Offsets, 0);
+		float DistanceToNextSample = 0.0f;
+		for (int32 SampleIdx = 1; SampleIdx <= NumSamples; SampleIdx++)
+		{
+			const FVector SegmentEnd = GetPoint(Offsets, SampleIdx);
+			const float SegmentLength = FVector::Dist(SegmentStart, SegmentEnd);
+			float SegmentPosition = DistanceToNextSample;
+			while (SegmentPosition < SegmentLength)
+			{
+				LinePoints.Add(FMath::Lerp(SegmentStart, SegmentEnd, SegmentPosition / SegmentLength));
+				SegmentPosition += SampleSpacing;
+			}
+			DistanceToNextSample = SegmentPosition - SegmentLength;
+			SegmentStart = SegmentEnd;
+		}
+	}
+
+	// drop onto the landscape
+	const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(RacingLineTrace), true);
+	for (FVector& LinePoint : LinePoints)
+	{
+		FHitResult Hit;
+		if (World->LineTraceSingleByChannel(Hit, LinePoint + FVector(0.0f, 0.0f, 10000.0f), LinePoint - FVector(0.0f, 0.0f, 10000.0f), ECC_Visibility, TraceParams))
+		{
+			LinePoint.Z = Hit.ImpactPoint.Z;
+		}
+	}
+
+	// speed limit from curvature, then forward pass for acceleration and backward pass for braking, twice around to wrap
+	const int32 NumLinePoints = LinePoints.Num();
+	TArray<float> Speeds;
+	Speeds.SetNumUninitialized(NumLinePoints);
+	for (int32 PointIdx = 0; PointIdx < NumLinePoints; PointIdx++)
+	{
+		const FVector A = LinePoints[(PointIdx + NumLinePoints - 1) % NumLinePoints];
+		const FVector B = LinePoints[PointIdx];
+		const FVector C = LinePoints[(PointIdx + 1) % NumLinePoints];
+		const float Cross = FMath::Abs((B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X));
+		const float SideProduct = FVector::Dist2D(A, B) * FVector::Dist2D(B, C) * FVector::Dist2D(C, A);
+		const float Curvature = SideProduct > KINDA_SMALL_NUMBER ? 2.0f * Cross / SideProduct : 0.0f;
+		Speeds[PointIdx] = Curvature > KINDA_SMALL_NUMBER ? FMath::Min(MaxSpeed, FMath::Sqrt(LateralAcceleration / Curvature)) : MaxSpeed;
+	}
+	for (int32 Step = 1; Step < NumLinePoints * 2; Step++)
+	{
+		const int32 PointIdx = Step % NumLinePoints;
+		const float PrevSpeed = Speeds[(PointIdx + NumLinePoints - 1) % NumLinePoints];
+		Speeds[PointIdx] = FMath::Min(Speeds[PointIdx], FMath::Sqrt(FMath::Square(PrevSpeed) + 2.0f * Acceleration * SampleSpacing));
+	}
+	for (int32 Step = NumLinePoints * 2 - 2; Step >= 0; Step--)
+	{
+		const int32 PointIdx = Step % NumLinePoints;
+		const float NextSpeed = Speeds[(PointIdx + 1) % NumLinePoints];
+		Speeds[PointIdx] = FMath::Min(Speeds[PointIdx], FMath::Sqrt(FMath::Square(NextSpeed) + 2.0f * BrakingDeceleration * SampleSpacing));
+	}
+
+	World->RemoveFromRoot();
+	World->CleanupWorld();
+
+	const FString PackageName = UVehicleRacingLine::GetPackageName(MapName);
+	const FString AssetName = FPackageName::GetShortName(PackageName);
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->FullyLoad();
+
+	UVehicleRacingLine* RacingLine = FindObject<UVehicleRacingLine>(Package, *AssetName);
+	if (RacingLine == nullptr)
+	{
+		RacingLine = NewObject<UVehicleRacingLine>(Package, *AssetName, RF_Public | RF_Standalone);
+	}
+
+	float LapTime = 0.0f;
+	RacingLine->SampleSpacing = SampleSpacing;
+	RacingLine->Points = LinePoints;
+	RacingLine->TargetSpeeds.SetNumUninitialized(NumLinePoints);
+	for (int32 PointIdx = 0; PointIdx < NumLinePoints; PointIdx++)
+	{
+		RacingLine->TargetSpeeds[PointIdx] = (uint16)FMath::Clamp(FMath::RoundToInt(Speeds[PointIdx]), 1, (int32)MAX_uint16);
+		LapTime += SampleSpacing / RacingLine->TargetSpeeds[PointIdx];
+	}
+	Package->MarkPackageDirty();
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	const bool bSaved = UPackage::SavePackage(Package, RacingLine, RF_Public | RF_Standalone, *Filename, GError, nullptr, false, true, SAVE_NoError);
+
+	UE_LOG(LogVehicle, Display, TEXT("%s: %d track points, %.0f m line, %d samples, %d iterations in %.2fs (last change %.3f cm), estimated lap %.2fs, %s"),
+		*MapName, NumTrackPoints, RacingLine->GetLength() / 100.0f, NumLinePoints, NumIterations, OptimizeTime, MaxChange, LapTime,
+		bSaved ? TEXT("saved") : TEXT("failed to save"));
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return bSaved;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,137 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "VehicleReplay.h"
+#include "Engine/DemoNetDriver.h"
+
+static TAutoConsoleVariable<int32> CVarRecordReplays(
+	TEXT("vehicle.RecordReplays"),
+	1,
+	TEXT("Record whole races as replays.\n")
+	TEXT("0: off, 1: dedicated server only, 2: any server"));
+
+static TAutoConsoleVariable<float> CVarReplayCheckpointInterval(
+	TEXT("vehicle.ReplayCheckpointInterval"),
+	10.0f,
+	TEXT("Seconds between replay checkpoints, seeking fast forwards at most this long"));
+
+FString FVehicleReplay::RecordingReplayName;
+double FVehicleReplay::RecordingStartTime = 0.0;
+
+void FVehicleReplay::StartRecording(UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (GameInstance == nullptr || IsRecording(World))
+	{
+		return;
+	}
+
+	const int32 RecordMode = CVarRecordReplays.GetValueOnGameThread();
+	const ENetMode NetMode = World->GetNetMode();
+	const bool bShouldRecord = (RecordMode == 1 && NetMode == NM_DedicatedServer) || (RecordMode == 2 && NetMode != NM_Client);
+	if (!bShouldRecord)
+	{
+		return;
+	}
+
+	IConsoleVariable* CheckpointDelayCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("demo.CheckpointUploadDelayInSeconds"));
+	if (CheckpointDelayCVar)
+	{
+		CheckpointDelayCVar->Set(CVarReplayCheckpointInterval.GetValueOnGameThread(), ECVF_SetByCode);
+	}
+
+	RecordingReplayName = FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s"), *World->GetMapName(), *FDateTime::Now().ToString()));
+	RecordingStartTime = FPlatformTime::Seconds();
+	GameInstance->StartRecordingReplay(RecordingReplayName, RecordingReplayName);
+
+	UE_LOG(LogVehicle, Log, TEXT("Recording replay %s, checkpoint every %.1fs"), *RecordingReplayName, CVarReplayCheckpointInterval.GetValueOnGameThread());
+}
+
+void FVehicleReplay::StopRecording(UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (GameInstance == nullptr || !IsRecording(World))
+	{
+		return;
+	}
+
+	GameInstance->StopRecordingReplay();
+
+	const double Minutes = (FPlatformTime::Seconds() - RecordingStartTime) / 60.0;
+	const double SizeMB = GetReplaySize(RecordingReplayName) / (1024.0 * 1024.0);
+	UE_LOG(LogVehicle, Log, TEXT("Replay %s: %.1f min, %.2f MB, %.2f MB/min"), 
+		*RecordingReplayName, Minutes, SizeMB, Minutes > 0.0 ? SizeMB / Minutes : 0.0);
+
+	RecordingReplayName.Empty();
+}
+
+bool FVehicleReplay::IsRecording(UWorld* World)
+{
+	return World && World->DemoNetDriver && World->DemoNetDriver->IsRecording();
+}
+
+void FVehicleReplay::Seek(UWorld* World, float TimeInSeconds)
+{
+	UDemoNetDriver* DemoDriver = World ? World->DemoNetDriver : nullptr;
+	if (DemoDriver == nullptr || !DemoDriver->IsPlaying())
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("No replay is playing"));
+		return;
+	}
+
+	const double RequestTime = FPlatformTime::Seconds();
+	DemoDriver->GotoTimeInSeconds(TimeInSeconds, FOnGotoTimeDelegate::CreateLambda([RequestTime, TimeInSeconds](const bool bWasSuccessful)
+	{
+		UE_LOG(LogVehicle, Log, TEXT("Replay seek to %.1fs %s in %.1f ms"), 
+			TimeInSeconds, bWasSuccessful ? TEXT("done") : TEXT("failed"), (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+	}));
+}
+
+int64 FVehicleReplay::GetReplaySize(const FString& ReplayName)
+{
+	// local file streamers keep each replay in its own folder under Saved/Demos
+	TArray<FString> ReplayFiles;
+	const FString ReplayDir = FPaths::ProjectSavedDir() / TEXT("Demos") / ReplayName;
+	IFileManager::Get().FindFilesRecursive(ReplayFiles, *ReplayDir, TEXT("*"), true, false);
+
+	int64 TotalSize = 0;
+	for (const FString& ReplayFile : ReplayFiles)
+	{
+		TotalSize += FMath::Max<int64>(IFileManager::Get().FileSize(*ReplayFile), 0);
+	}
+	return TotalSize;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void ReplayPlay(const TArray<FString>& Args, UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (Args.Num() < 1 || GameInstance == nullptr)
+	{
+		UE_LOG(LogVehicle, Display, TEXT("Usage: vehicle.ReplayPlay <ReplayName>"));
+		return;
+	}
+	GameInstance->PlayReplay(Args[0], World);
+}
+
+static void ReplaySeek(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogVehicle, Display, TEXT("Usage: vehicle.ReplaySeek <Seconds>"));
+		return;
+	}
+	FVehicleReplay::Seek(World, FCString::Atof(*Args[0]));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayPlayCmd(
+	TEXT("vehicle.ReplayPlay"),
+	TEXT("Plays recorded race replay. Usage: vehicle.ReplayPlay <ReplayName>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReplayPlay));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplaySeekCmd(
+	TEXT("vehicle.ReplaySeek"),
+	TEXT("Jumps replay playback to given time and logs seek latency. Usage: vehicle.ReplaySeek <Seconds>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReplaySeek));
@@ -0,0 +1,278 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "VehicleGame.h"
+#include "VehicleStreamingGridCommandlet.h"
+#include "Streaming/VehicleStreamingGrid.h"
+#include "Track/VehicleTrackPoint.h"
+#include "Engine/LevelStreamingKismet.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/PlayerStart.h"
+#include "LandscapeProxy.h"
+#include "UObject/GarbageCollection.h"
+
+UVehicleStreamingGridCommandlet::UVehicleStreamingGridCommandlet(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	CellSize = 50000.0f;
+	MaxActorSize = 50000.0f;
+}
+
+int32 UVehicleStreamingGridCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	FParse::Value(*Params, TEXT("MaxActorSize="), MaxActorSize);
+	CellSize = FMath::Max(CellSize, 1000.0f);
+
+	// maps are saved in place, so only the large open map is split unless asked otherwise
+	FString MapsParam(TEXT("Open_Desert_level_1"));
+	FParse::Value(*Params, TEXT("Maps="), MapsParam);
+
+	TArray<FString> MapNames;
+	MapsParam.ParseIntoArray(MapNames, TEXT("+"));
+
+	int32 NumSplit = 0;
+	for (const FString& MapName : MapNames)
+	{
+		NumSplit += SplitMap(FPackageName::IsShortPackageName(MapName) ? TEXT("/Game/Maps/") + MapName : MapName) ? 1 : 0;
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("Streaming grids baked for %d of %d maps"), NumSplit, MapNames.Num());
+	return (MapNames.Num() > 0 && NumSplit == MapNames.Num()) ? 0 : 1;
+#else
+	UE_LOG(LogVehicle, Error, TEXT("Streaming grids can only be baked by editor builds"));
+	return 1;
+#endif
+}
+
+bool UVehicleStreamingGridCommandlet::CanMoveToCell(AActor* Actor) const
+{
+	USceneComponent* RootComponent = Actor ? Actor->GetRootComponent() : nullptr;
+	if (RootComponent == nullptr || RootComponent->Mobility != EComponentMobility::Static || Actor->IsPendingKill() || Actor->GetIsReplicated())
+	{
+		return false;
+	}
+
+	// gameplay actors are looked up by the game mode and game state when the map starts
+	return !Actor->IsA<AInfo>() && !Actor->IsA<ABrush>() && !Actor->IsA<ALevelScriptActor>() && !Actor->IsA<ALandscapeProxy>()
+		&& !Actor->IsA<APlayerStart>() && !Actor->IsA<AVehicleTrackPoint>();
+}
+
+/** does any primitive of actor collide? */
+static bool HasCollision(AActor* Actor)
+{
+	if (!Actor->GetActorEnableCollision())
+	{
+		return false;
+	}
+
+	TInlineComponentArray<UPrimitiveComponent*> Primitives;
+	Actor->GetComponents(Primitives);
+	for (UPrimitiveComponent* Primitive : Primitives)
+	{
+		if (Primitive->IsCollisionEnabled())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UVehicleStreamingGridCommandlet::SplitMap(const FString& MapPackageName)
+{
+#if WITH_EDITOR
+	const FString MapName = FPackageName::GetShortName(MapPackageName);
+	if (UVehicleStreamingGrid::LoadForMap(MapName))
+	{
+		UE_LOG(LogVehicle, Warning, TEXT("%s: already split, revert the map and delete %s to split it again"), *MapName, *UVehicleStreamingGrid::GetPackageName(MapName));
+		return false;
+	}
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (World == nullptr)
+	{
+		UE_LOG(LogVehicle, Error, TEXT("%s: failed to load map"), *MapName);
+		return false;
+	}
+
+	// components must be registered for their bounds
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(false));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	// references between levels do not survive streaming, so actors referencing or referenced by other actors stay together in the persistent level
+	TArray<AActor*> Actors = World->PersistentLevel->Actors;
+	TSet<AActor*> LinkedActors;
+	for (AActor* Actor : Actors)
+	{
+		if (Actor == nullptr)
+		{
+			continue;
+		}
+
+		TArray<UObject*> ReferencedObjects;
+		FReferenceFinder Finder(ReferencedObjects, nullptr, false, true, false, true);
+		Finder.FindReferences(Actor);
+		TInlineComponentArray<UActorComponent*> Components;
+		Actor->GetComponents(Components);
+		for (UActorComponent* Component : Components)
+		{
+			Finder.FindReferences(Component);
+		}
+
+		for (UObject* Object : ReferencedObjects)
+		{
+			AActor* ReferencedActor = Object ? (Object->IsA<AActor>() ? Cast<AActor>(Object) : Object->GetTypedOuter<AActor>()) : nullptr;
+			if (ReferencedActor && ReferencedActor != Actor && ReferencedActor->GetLevel() == World->PersistentLevel)
+			{
+				LinkedActors.Add(Actor);
+				LinkedActors.Add(ReferencedActor);
+			}
+		}
+	}
+
+	TMap<FIntPoint, TArray<AActor*>> CellActors[2];
+	int32 NumKept = 0;
+	for (AActor* Actor : Actors)
+	{
+		if (Actor == nullptr || !CanMoveToCell(Actor) || LinkedActors.Contains(Actor))
+		{
+			NumKept += Actor ? 1 : 0;
+			continue;
+		}
+
+		const FBox Bounds = Actor->GetComponentsBoundingBox(true);
+		if (!Bounds.IsValid || Bounds.GetSize().GetMax() > MaxActorSize)
+		{
+			NumKept++;
+			continue;
+		}
+
+		const FVector Center = Bounds.GetCenter();
+		const FIntPoint Coords(FMath::FloorToInt(Center.X / CellSize), FMath::FloorToInt(Center.Y / CellSize));
+		CellActors[HasCollision(Actor) ? 1 : 0].FindOrAdd(Coords).Add(Actor);
+	}
+
+	const FString GridPackageName = UVehicleStreamingGrid::GetPackageName(MapName);
+	const FString GridAssetName = FPackageName::GetShortName(GridPackageName);
+	UPackage* GridPackage = CreatePackage(nullptr, *GridPackageName);
+	UVehicleStreamingGrid* Grid = NewObject<UVehicleStreamingGrid>(GridPackage, *GridAssetName, RF_Public | RF_Standalone);
+	Grid->CellSize = CellSize;
+
+	int32 NumMoved = 0;
+	int32 NumFailedCells = 0;
+	for (int32 CollisionIdx = 0; CollisionIdx < ARRAY_COUNT(CellActors); CollisionIdx++)
+	{
+		for (const TPair<FIntPoint, TArray<AActor*>>& Cell : CellActors[CollisionIdx])
+		{
+			const FString CellPackageName = FString::Printf(TEXT("/Game/Maps/%s_Grid/%s_%s_%d_%d"), *MapName, *MapName,
+				CollisionIdx ? TEXT("Col") : TEXT("Vis"), Cell.Key.X, Cell.Key.Y);
+			UPackage* CellPackage = CreatePackage(nullptr, *CellPackageName);
+			UWorld* CellWorld = UWorld::CreateWorld(EWorldType::Inactive, false, *FPackageName::GetShortName(CellPackageName), CellPackage);
+
+			FVehicleStreamingCell& GridCell = Grid->Cells[Grid->Cells.AddDefaulted()];
+			GridCell.PackageName = *CellPackageName;
+			GridCell.Coords = Cell.Key;
+			GridCell.bCollision = CollisionIdx != 0;
+
+			// spawning from the actor as template copies its properties and components into the cell
+			TArray<AActor*> CellSpawnedActors;
+			for (AActor* Actor : Cell.Value)
+			{
+				FActorSpawnParameters SpawnInfo;
+				SpawnInfo.Template = Actor;
+				SpawnInfo.Name = Actor->GetFName();
+				SpawnInfo.OverrideLevel = CellWorld->PersistentLevel;
+				SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+				const FTransform ActorTransform = Actor->GetActorTransform();
+				AActor* CellActor = CellWorld->SpawnActor(Actor->GetClass(), &ActorTransform, SpawnInfo);
+				if (CellActor)
+				{
+					CellSpawnedActors.Add(CellActor);
+					GridCell.Bounds += Actor->GetComponentsBoundingBox(true);
+				}
+			}
+
+			CellPackage->MarkPackageDirty();
+			const FString CellFilename = FPackageName::LongPackageNameToFilename(CellPackageName, FPackageName::GetMapPackageExtension());
+			const bool bCellSaved = CellSpawnedActors.Num() == Cell.Value.Num()
+				&& UPackage::SavePackage(CellPackage, CellWorld, RF_NoFlags, *CellFilename, GError, nullptr, false, true, SAVE_NoError);
+
+			CellWorld->RemoveFromRoot();
+			CellWorld->DestroyWorld(false);
+
+			// a cell that failed keeps all its actors in the persistent level
+			if (!bCellSaved)
+			{
+				UE_LOG(LogVehicle, Error, TEXT("%s: failed to save cell %s"), *MapName, *CellPackageName);
+				Grid->Cells.Pop();
+				NumKept += Cell.Value.Num();
+				NumFailedCells++;
+				continue;
+			}
+
+			for (AActor* Actor : Cell.Value)
+			{
+				World->EditorDestroyActor(Actor, true);
+			}
+			NumMoved += Cell.Value.Num();
+
+			// streamer decides when cells load, bInitiallyLoaded stays off
+			ULevelStreamingKismet* StreamingLevel = NewObject<ULevelStreamingKismet>(World, NAME_None, RF_NoFlags);
+			StreamingLevel->SetWorldAssetByPackageName(GridCell.PackageName);
+			World->StreamingLevels.Add(StreamingLevel);
+		}
+	}
+
+	MapPackage->MarkPackageDirty();
+	const FString MapFilename = FPackageName::LongPackageNameToFilename(MapPackageName, FPackageName::GetMapPackageExtension());
+	const bool bMapSaved = UPackage::SavePackage(MapPackage, World, RF_NoFlags, *MapFilename, GError, nullptr, false, true, SAVE_NoError);
+
+	// without the map the grid would stream actors the persistent level still holds
+	bool bGridSaved = false;
+	if (bMapSaved && Grid->Cells.Num() > 0)
+	{
+		GridPackage->MarkPackageDirty();
+		const FString GridFilename = FPackageName::LongPackageNameToFilename(GridPackageName, FPackageName::GetAssetPackageExtension());
+		bGridSaved = UPackage::SavePackage(GridPackage, Grid, RF_Public | RF_Standalone, *GridFilename, GError, nullptr, false, true, SAVE_NoError);
+	}
+
+	World->RemoveFromRoot();
+	World->CleanupWorld();
+
+	int32 NumCollisionCells = 0;
+	for (const FVehicleStreamingCell& GridCell : Grid->Cells)
+	{
+		NumCollisionCells += GridCell.bCollision ? 1 : 0;
+	}
+
+	UE_LOG(LogVehicle, Display, TEXT("%s: %d actors moved into %d colliding and %d visual cells of %.0f m, %d actors kept in persistent level, %d cells failed, %s"),
+		*MapName, NumMoved, NumCollisionCells, Grid->Cells.Num() - NumCollisionCells, CellSize / 100.0f, NumKept, NumFailedCells,
+		!bMapSaved ? TEXT("failed to save map") : bGridSaved ? TEXT("saved") : TEXT("no grid saved"));
+	if (NumMoved > 0)
+	{
+		// built lighting of moved actors stays in the persistent level's build data
+		UE_LOG(LogVehicle, Warning, TEXT("%s: lighting of moved actors is unbuilt, rebuild lighting of the map with all cells loaded"), *MapName);
+	}
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return bMapSaved && bGridSaved;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,153 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Ghost/VehicleGhostStream.h"
+#include "VehicleGhostManager.generated.h"
+
+/** playback state of single ghost */
+struct FVehicleGhostPlayback
+{
+	/** encoded ghost stream, shared by all ghosts playing the same file */
+	TSharedPtr<TArray<uint8>> Data;
+
+	/** forward decoder over Data */
+	FVehicleGhostReader Reader;
+
+	/** decoded sample at or before playback time */
+	FVehicleGhostSample PrevSample;
+
+	/** decoded sample after playback time */
+	FVehicleGhostSample NextSample;
+
+	/** time of NextSample, PrevSample is one sample interval before */
+	float NextSampleTime;
+
+	/** current time in ghost stream */
+	float PlaybackTime;
+
+	/** current interpolated transform */
+	FTransform Transform;
+
+	/** current interpolated engine rotation speed */
+	float EngineRPM;
+
+	/** visual proxy, null on dedicated server and once finished */
+	USkeletalMeshComponent* Proxy;
+
+	/** engine sound, only assigned to running ghosts near the listener */
+	UAudioComponent* Audio;
+
+	/** has reached end of stream? */
+	bool bFinished;
+
+	FVehicleGhostPlayback(const TSharedPtr<TArray<uint8>>& InData);
+};
+
+/**
+ * Plays many recorded ghosts at once.
+ * Ghosts are not vehicles: every ghost is a mesh component without collision, physics or animation,
+ * moved by one tick of this actor from samples decoded incrementally out of the ghost stream.
+ */
+UCLASS()
+class AVehicleGhostManager : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin Actor overrides
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End Actor overrides
+
+	/** 
+	 * Start playing ghost file
+	 *
+	 * @param	Filename	ghost file written by UVehicleGhostRecorderComponent
+	 * @param	StartTime	time in ghost stream to start from
+	 * @returns	ghost index or INDEX_NONE if file can't be read
+	 */
+	int32 AddGhost(const FString& Filename, float StartTime = 0.0f);
+
+	/** 
+	 * Start playing ghost from encoded stream
+	 *
+	 * @param	Data		encoded ghost stream, can be shared between ghosts
+	 * @param	StartTime	time in ghost stream to start from
+	 * @returns	ghost index or INDEX_NONE if stream is invalid
+	 */
+	int32 AddGhostFromData(const TSharedPtr<TArray<uint8>>& Data, float StartTime = 0.0f);
+
+	/** stop and remove all ghosts */
+	void ClearGhosts();
+
+	/** get number of playing ghosts */
+	int32 GetNumGhosts() const;
+
+	/** get current transform of ghost */
+	bool GetGhostTransform(int32 GhostIndex, FTransform& OutTransform) const;
+
+	/** advance all ghosts and move their proxies */
+	void UpdateGhosts(float DeltaSeconds);
+
+protected:
+	/** mesh used for ghost proxies, loaded with the first proxy so dedicated servers never load it */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	TSoftObjectPtr<USkeletalMesh> GhostMesh;
+
+	/** material override for ghost proxies, usually translucent */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	UMaterialInterface* GhostMaterial;
+
+	/** looping engine sound, ghosts are silent if not set */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	USoundBase* GhostEngineSound;
+
+	/** max number of ghosts with engine sound */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	int32 MaxAudibleGhosts;
+
+	/** ghosts further from the listener are silent */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	float GhostAudioRadius;
+
+	/** how often engine sounds are reassigned to the closest ghosts */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	float GhostAudioUpdateInterval;
+
+	/** restart ghosts when they reach the end of stream */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	bool bLoopGhosts;
+
+	/** engine sound components, shared by audible ghosts */
+	UPROPERTY(Transient)
+	TArray<UAudioComponent*> AudioPool;
+
+	/** engine sound components not assigned to any ghost */
+	TArray<UAudioComponent*> FreeAudio;
+
+	/** proxies of finished or removed ghosts, reused by new ones */
+	UPROPERTY(Transient)
+	TArray<USkeletalMeshComponent*> FreeProxies;
+
+	/** playing ghosts */
+	TArray<FVehicleGhostPlayback> Ghosts;
+
+	/** loaded ghost files by name */
+	TMap<FString, TSharedPtr<TArray<uint8>>> LoadedGhostFiles;
+
+	/** time of last audio assignment */
+	float LastAudioUpdateTime;
+
+	/** decode forward and interpolate, returns false when ghost has finished */
+	bool AdvanceGhost(FVehicleGhostPlayback& Ghost, float DeltaSeconds);
+
+	/** give engine sounds to ghosts closest to the listener */
+	void UpdateGhostAudio();
+
+	/** get proxy from the free list or create new one */
+	USkeletalMeshComponent* AcquireProxy();
+
+	/** return proxy and engine sound of ghost to the free lists */
+	void ReleaseGhostComponents(FVehicleGhostPlayback& Ghost);
+};
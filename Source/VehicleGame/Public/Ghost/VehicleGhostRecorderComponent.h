@@ -0,0 +1,57 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Ghost/VehicleGhostStream.h"
+#include "VehicleGhostRecorderComponent.generated.h"
+
+/**
+ * Records owning vehicle into a ghost file at fixed rate [Server only]
+ * Enabled by vehicle.GhostRecord console variable.
+ */
+UCLASS()
+class UVehicleGhostRecorderComponent : public UActorComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin ActorComponent overrides
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	// End ActorComponent overrides
+
+	/** start recording once owner has PlayerState, if vehicle.GhostRecord is on, also after StopRecording */
+	void EnableAutoRecording();
+
+	/** start writing new ghost file, finishing the current one */
+	void StartRecording();
+
+	/** finish current ghost file */
+	void StopRecording();
+
+	/** is recording active? */
+	bool IsRecording() const;
+
+	/** get path of current or last ghost file */
+	const FString& GetGhostFilename() const;
+
+protected:
+	/** samples per second */
+	UPROPERTY(EditDefaultsOnly, Category=Ghost)
+	int32 SampleRate;
+
+	/** time accumulated towards next sample */
+	float SampleAccumulator;
+
+	/** path of current or last ghost file */
+	FString GhostFilename;
+
+	/** ghost file, valid while recording */
+	TUniquePtr<FArchive> GhostArchive;
+
+	/** stream encoder, valid while recording */
+	TUniquePtr<FVehicleGhostWriter> GhostWriter;
+
+	/** read current state of owning vehicle */
+	void CaptureSample(FVehicleGhostSample& OutSample) const;
+};
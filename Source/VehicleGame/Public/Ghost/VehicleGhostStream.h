@@ -0,0 +1,168 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/** single state of a recorded vehicle */
+struct FVehicleGhostSample
+{
+	/** world location */
+	FVector Location;
+
+	/** world rotation */
+	FRotator Rotation;
+
+	/** front wheels steer angle in degrees */
+	float SteerAngle;
+
+	/** suspension offset of each wheel */
+	float SuspensionOffset[4];
+
+	/** engine rotation speed */
+	float EngineRPM;
+
+	/** throttle input, -1..1 */
+	float ThrottleInput;
+
+	/** steering input, -1..1 */
+	float SteeringInput;
+
+	/** is handbrake pressed? */
+	bool bHandbrake;
+
+	FVehicleGhostSample();
+
+	/** get sample of synthetic lap around bumpy circle, used by benchmarks */
+	static FVehicleGhostSample MakeSynthetic(float Time);
+};
+
+/** quantized channels of ghost sample, each one is delta encoded separately */
+namespace EVehicleGhostChannel
+{
+	enum Type
+	{
+		LocationX,
+		LocationY,
+		LocationZ,
+		Pitch,
+		Yaw,
+		Roll,
+		SteerAngle,
+		Suspension0,
+		Suspension1,
+		Suspension2,
+		Suspension3,
+		EngineRPM,
+		ThrottleInput,
+		SteeringInput,
+		Num,
+	};
+}
+
+/**
+ * Encodes fixed rate stream of ghost samples.
+ *
+ * Every sample is quantized, delta encoded against the previous one and written as zigzag varints.
+ * Once per second a keyframe is stored against zero, so playback can start from any second.
+ * Samples are collected in a preallocated buffer which is flushed to the archive when full, 
+ * so recording doesn't allocate per sample.
+ */
+class FVehicleGhostWriter : public FNoncopyable
+{
+public:
+	/**
+	 * @param	InArchive		archive to write to, must outlive the writer. Null only counts encoded bytes
+	 * @param	InSampleRate	samples per second
+	 * @param	BufferSize		bytes collected before writing to archive
+	 */
+	FVehicleGhostWriter(FArchive* InArchive, int32 InSampleRate, int32 BufferSize = 4096);
+	~FVehicleGhostWriter();
+
+	/** encode next sample */
+	void AddSample(const FVehicleGhostSample& Sample);
+
+	/** write buffered data to archive */
+	void Flush();
+
+	/** get number of encoded samples */
+	int32 GetNumSamples() const;
+
+	/** get number of encoded bytes including header */
+	int64 GetTotalBytes() const;
+
+private:
+	/** append zigzag encoded varint to buffer */
+	void WriteVarInt(int32 Value);
+
+	/** archive to write to */
+	FArchive* Archive;
+
+	/** encoded data waiting for flush */
+	TArray<uint8> Buffer;
+
+	/** samples per second */
+	int32 SampleRate;
+
+	/** number of encoded samples */
+	int32 NumSamples;
+
+	/** number of encoded bytes */
+	int64 TotalBytes;
+
+	/** quantized channels of previous sample */
+	int32 LastChannels[EVehicleGhostChannel::Num];
+};
+
+/**
+ * Decodes ghost stream written by FVehicleGhostWriter, one sample at a time.
+ */
+class FVehicleGhostReader
+{
+public:
+	/**
+	 * @param	InData	encoded stream including header, must outlive the reader
+	 * @param	InSize	size of encoded stream
+	 */
+	FVehicleGhostReader(const uint8* InData, int32 InSize);
+
+	/** is header valid? */
+	bool IsValid() const;
+
+	/** get samples per second */
+	int32 GetSampleRate() const;
+
+	/** get index of the next sample */
+	int32 GetSampleIndex() const;
+
+	/** 
+	 * Decode next sample
+	 *
+	 * @param	OutSample	decoded sample
+	 * @returns	false at the end of stream or if data are corrupted
+	 */
+	bool ReadSample(FVehicleGhostSample& OutSample);
+
+	/** start again from the first sample */
+	void Rewind();
+
+private:
+	/** read zigzag encoded varint */
+	bool ReadVarInt(int32& OutValue);
+
+	/** encoded data */
+	const uint8* Data;
+
+	/** size of encoded data */
+	int32 Size;
+
+	/** read position */
+	int32 Offset;
+
+	/** samples per second, 0 if header is invalid */
+	int32 SampleRate;
+
+	/** index of the next sample */
+	int32 SampleIndex;
+
+	/** quantized channels of previous sample */
+	int32 LastChannels[EVehicleGhostChannel::Num];
+};
@@ -0,0 +1,141 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Queue.h"
+
+/** kind of time kept by leaderboard */
+namespace EVehicleLeaderboard
+{
+	enum Type
+	{
+		Lap,
+		Race,
+	};
+}
+
+/** single leaderboard time, stored as fixed size record */
+struct FVehicleLeaderboardEntry
+{
+	/** maximum name length including terminator */
+	static const int32 MaxNameLen = 16;
+
+	/** time in milliseconds, lower is better */
+	uint32 TimeMs;
+
+	/** when the time was set, FDateTime ticks */
+	int64 Timestamp;
+
+	/** racer name, zero padded */
+	ANSICHAR Name[MaxNameLen];
+
+	FVehicleLeaderboardEntry();
+	FVehicleLeaderboardEntry(const FString& InName, float Time);
+
+	/** get time in seconds */
+	float GetTime() const;
+
+	/** get racer name */
+	FString GetName() const;
+
+	/** faster times first, equal times keep the one set earlier */
+	bool operator<(const FVehicleLeaderboardEntry& Other) const
+	{
+		return TimeMs < Other.TimeMs || (TimeMs == Other.TimeMs && Timestamp < Other.Timestamp);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FVehicleLeaderboardEntry& Entry);
+};
+
+/**
+ * Local best lap and race times, one board per map, game mode and kind of time.
+ *
+ * Every board is stored as a sorted index file and an append-only log of times submitted since the
+ * index was written. New times are appended to the log by a worker thread, so finishing a race never
+ * waits for disk; once the log grows long enough the worker merges it into a new index.
+ * Boards are read on first query and kept sorted in memory, so rank and insert position are binary
+ * searches, top times are a prefix of the array and personal bests are a map lookup.
+ */
+class FVehicleLeaderboardStore : public FNoncopyable
+{
+public:
+	/** get store shared by all worlds */
+	static FVehicleLeaderboardStore& Get();
+
+	/** get name of board keeping given kind of times on map in game mode */
+	static FString GetBoardName(const FString& MapName, const FString& ModeName, EVehicleLeaderboard::Type Kind);
+
+	/** add time to board, written to disk in background */
+	void SubmitTime(const FString& BoardName, const FString& RacerName, float Time);
+
+	/**
+	 * Get fastest times of board
+	 *
+	 * @param	BoardName	board to query
+	 * @param	Count		maximum number of returned times
+	 * @param	OutEntries	times, fastest first
+	 */
+	void GetTopEntries(const FString& BoardName, int32 Count, TArray<FVehicleLeaderboardEntry>& OutEntries);
+
+	/** get fastest time of racer, false if racer has none on board */
+	bool GetPersonalBest(const FString& BoardName, const FString& RacerName, FVehicleLeaderboardEntry& OutEntry);
+
+	/** get place Time would take on board, 1 is fastest */
+	int32 GetRank(const FString& BoardName, float Time);
+
+	/** get number of times on board */
+	int32 GetNumEntries(const FString& BoardName);
+
+	/** write all queued times now */
+	void Flush();
+
+private:
+	FVehicleLeaderboardStore();
+
+	/** board loaded to memory */
+	struct FBoard
+	{
+		/** all times, sorted */
+		TArray<FVehicleLeaderboardEntry> Entries;
+
+		/** fastest time of every racer */
+		TMap<FString, FVehicleLeaderboardEntry> PersonalBests;
+
+		/** add time keeping entries sorted */
+		void Add(const FVehicleLeaderboardEntry& Entry);
+	};
+
+	/** time waiting to be written */
+	struct FPendingWrite
+	{
+		FString BoardName;
+		FVehicleLeaderboardEntry Entry;
+	};
+
+	/** get board, reads its files on first use */
+	FBoard& FindOrLoadBoard(const FString& BoardName);
+
+	/** write queued times, caller holds WriteLock */
+	void ProcessWriteQueue();
+
+	/** merge log of board into its index, caller holds WriteLock */
+	void CompactBoard(const FString& BoardName);
+
+	/** get file of board, Extension is index or log */
+	static FString GetBoardFilename(const FString& BoardName, const TCHAR* Extension);
+
+	/** read records of index or log file, false if file is missing or invalid */
+	static bool ReadRecords(const FString& Filename, TArray<FVehicleLeaderboardEntry>& OutEntries);
+
+	/** number of entries before first one slower than TimeMs, or not faster if bIncludeEqual is false */
+	static int32 FindPosition(const TArray<FVehicleLeaderboardEntry>& Entries, uint32 TimeMs, bool bIncludeEqual);
+
+	/** boards read so far [Game thread] */
+	TMap<FString, FBoard> Boards;
+
+	/** times waiting to be written, produced on game thread */
+	TQueue<FPendingWrite, EQueueMode::Spsc> WriteQueue;
+
+	/** serializes file access between writer tasks and board loading */
+	FCriticalSection WriteLock;
+};
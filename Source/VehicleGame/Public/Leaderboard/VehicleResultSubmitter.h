@@ -0,0 +1,154 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Async/Future.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+
+/** finished race result sent to leaderboard service */
+struct FVehicleRaceResult
+{
+	/** unique id, lets service drop results resent after a lost response */
+	FGuid Id;
+
+	/** map short name */
+	FString MapName;
+
+	/** game mode class name */
+	FString ModeName;
+
+	/** racer name */
+	FString PlayerName;
+
+	/** finishing place, 1 is the winner */
+	int32 Place;
+
+	/** race time at the finish line */
+	float FinishTime;
+
+	/** when race finished, UTC */
+	FDateTime Timestamp;
+
+	FVehicleRaceResult();
+
+	/** write as JSON object */
+	void WriteJson(TJsonWriter<>& Writer) const;
+
+	/** read from JSON object, false if fields are missing */
+	bool ReadJson(const FJsonObject& Object);
+
+	/** get made up result, used by stress test */
+	static FVehicleRaceResult MakeSynthetic(int32 Index);
+};
+
+/**
+ * Sends finished race results to the central leaderboard service. [Server only]
+ *
+ * Submit only queues the result. A core ticker collects queued results into batches and posts one batch
+ * at a time; failed batches are retried with exponential backoff. Unsent results are written to a spool
+ * file on a worker thread, and once more synchronously on engine exit. The spool is read back on a worker
+ * thread when the submitter is created at module startup, so results survive server restarts.
+ * Service URL "mock://" posts to an in-process mock service instead of HTTP, see vehicle.MockResultService* cvars.
+ */
+class FVehicleResultSubmitter : public TSharedFromThis<FVehicleResultSubmitter>, public FNoncopyable
+{
+public:
+	/**
+	 * @param	InServiceURL		URL batches are posted to, empty follows vehicle.ResultServiceURL
+	 * @param	InSpoolFilename		file keeping unsent results across restarts, empty keeps them in memory only
+	 */
+	FVehicleResultSubmitter(const FString& InServiceURL, const FString& InSpoolFilename);
+	~FVehicleResultSubmitter();
+
+	/** create submitter of this process and start reading its spool, not in commandlets */
+	static void Initialize();
+
+	/** destroy submitter of this process, its spool was already written on engine exit */
+	static void Shutdown();
+
+	/** get submitter of this process, posting to vehicle.ResultServiceURL, null if there is none */
+	static FVehicleResultSubmitter* Get();
+
+	/** queue result for sending, never waits for network or disk */
+	void Submit(const FVehicleRaceResult& Result);
+
+	/** get number of results not yet accepted by service */
+	int32 GetNumPending() const;
+
+	/** get number of results accepted by service */
+	int32 GetNumSent() const;
+
+	/** get number of posted batches, including failed ones */
+	int32 GetNumBatches() const;
+
+private:
+	/** ticker callback, starts next batch and writes spool */
+	bool Tick(float DeltaTime);
+
+	/** post oldest queued results */
+	void SendBatch();
+
+	/** batch of first NumInFlight pending results finished */
+	void OnBatchSent(bool bSuccess);
+
+	/** post payload to service, OnComplete is called on game thread */
+	void PostBatch(const FString& Payload, int32 NumResults, TFunction<void(bool)> OnComplete);
+
+	/** URL batches are posted to, read when posting so console changes apply, empty disables submitting */
+	FString GetServiceURL() const;
+
+	/** write pending results to spool file on worker thread */
+	void WriteSpool();
+
+	/** start reading results left in spool file by previous run on worker thread */
+	void ReadSpool();
+
+	/** queue results read from spool ahead of results submitted since, once read finished */
+	void FinishReadSpool();
+
+	/** write spool synchronously, engine is about to exit */
+	void OnPreExit();
+
+	/** fixed URL batches are posted to, empty follows vehicle.ResultServiceURL */
+	FString ServiceURL;
+
+	/** file keeping unsent results */
+	FString SpoolFilename;
+
+	/** results not yet accepted, oldest first; the first NumInFlight are being sent */
+	TArray<FVehicleRaceResult> Pending;
+
+	/** number of results in the batch being sent */
+	int32 NumInFlight;
+
+	/** failures since last accepted batch, drives the backoff */
+	int32 NumFailures;
+
+	/** no batch is sent before this time */
+	double NextSendTime;
+
+	/** time the oldest not yet sent result was queued */
+	double OldestQueuedTime;
+
+	/** number of accepted results */
+	int32 NumSent;
+
+	/** number of posted batches */
+	int32 NumBatches;
+
+	/** pending results changed since spool was written */
+	bool bSpoolDirty;
+
+	/** spool write running on worker thread */
+	TFuture<void> SpoolWrite;
+
+	/** spool read running on worker thread, spool is not written before it finished */
+	TFuture<TArray<FVehicleRaceResult>> SpoolRead;
+
+	/** handle of ticker */
+	FDelegateHandle TickerHandle;
+
+	/** submitter of this process */
+	static TSharedPtr<FVehicleResultSubmitter> Instance;
+};
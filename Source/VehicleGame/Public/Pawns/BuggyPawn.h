@@ -4,11 +4,14 @@
 
 #include "VehicleTypes.h"
 #include "WheeledVehicle.h"
+#include "Pawns/VehicleTransformHistory.h"
 #include "BuggyPawn.generated.h"
 
 class AVehicleTrackPoint;
 class UVehicleDustType;
 class AVehicleImpactEffect;
+class UVehicleGhostRecorderComponent;
+struct FStreamableHandle;
 
 UCLASS()
 class ABuggyPawn : public AWheeledVehicle
@@ -46,13 +49,34 @@ class ABuggyPawn : public AWheeledVehicle
 	/** Event on death [Server/Client] */
 	virtual void OnDeath();
 
-	/** notify about touching new checkpoint */
-	void OnTrackPointReached(AVehicleTrackPoint* TrackPoint);
+	/** 
+	 * Bring back vehicle kept in game mode's pool after death [Server only]
+	 *
+	 * @param	NewTransform	respawn pose
+	 */
+	void Revive(const FTransform& NewTransform);
+
+	/** 
+	 * Notify about touching new checkpoint 
+	 *
+	 * @param	TrackPoint		crossed track point
+	 * @param	CrossingTime	world time of the crossing, interpolated between physics frames on server
+	 */
+	void OnTrackPointReached(AVehicleTrackPoint* TrackPoint, float CrossingTime);
 
 	/** is handbrake active? */
 	UFUNCTION(BlueprintCallable, Category="Game|Vehicle")
 	bool IsHandbrakeActive() const;
 
+	/** is vehicle held by its player or bot controller until race starts? */
+	bool IsHandbrakeForced() const;
+
+	/** get last throttle input, -1 to 1 */
+	float GetThrottleInput() const { return ThrottleInput; }
+
+	/** get last steering input, -1 to 1 */
+	float GetTurnInput() const { return TurnInput; }
+
 	/** get current speed */
 	float GetVehicleSpeed() const;
 
@@ -61,6 +85,20 @@ class ABuggyPawn : public AWheeledVehicle
 
 	/** get maximum RPM */
 	float GetEngineMaxRotationSpeed() const;
+
+	/** recalculate NetUpdateFrequency from motion and distance to viewers [Server only] */
+	void UpdateAdaptiveNetUpdateFrequency();
+
+	/** 
+	 * Teleport to race start at rest, keeping the pawn and its loaded assets [Server only]
+	 *
+	 * @param	NewTransform	grid slot to place vehicle at
+	 */
+	void ResetToTransform(const FTransform& NewTransform);
+
+	/** repeat reset on owning client, which simulates its vehicle locally */
+	UFUNCTION(reliable, client)
+	void ClientResetToTransform(const FTransform& NewTransform);
 		
 	//////////////////////////////////////////////////////////////////////////
 	// Input handlers
@@ -89,6 +127,10 @@ private:
 	UPROPERTY(Category = Camera, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* Camera;
 
+	/** Records this vehicle into ghost file when enabled */
+	UPROPERTY(Category = Ghost, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	UVehicleGhostRecorderComponent* GhostRecorder;
+
 	/** AudioThread authoritative cache of desired RPM keyed by owner ID for SoundNodeVehicleEngine to reference */
 	static TMap<uint32, FVehicleDesiredRPM> BuggyDesiredRPMs;
 
@@ -96,7 +138,7 @@ protected:
 
 	/** dust FX config */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	UVehicleDustType* DustType;
+	TSoftObjectPtr<UVehicleDustType> DustType;
 
 	/** impact FX config */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
@@ -108,15 +150,15 @@ protected:
 
 	/** explosion FX */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	UParticleSystem* DeathFX;
+	TSoftObjectPtr<UParticleSystem> DeathFX;
 
 	/** explosion sound */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	USoundCue* DeathSound;
+	TSoftObjectPtr<USoundCue> DeathSound;
 
 	/** engine sound */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	USoundCue* EngineSound;
+	TSoftObjectPtr<USoundCue> EngineSound;
 
 private:
 	/** audio component for engine sounds */
@@ -126,7 +168,7 @@ protected:
 
 	/** landing sound */
 	UPROPERTY(Category = Effects, EditDefaultsOnly)
-	USoundCue* LandingSound;
+	TSoftObjectPtr<USoundCue> LandingSound;
 
 	/** dust FX components */
 	UPROPERTY(Transient)
@@ -134,11 +176,11 @@ protected:
 
 	/** skid sound loop */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	USoundCue* SkidSound;
+	TSoftObjectPtr<USoundCue> SkidSound;
 
 	/** skid sound stop */
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
-	USoundCue* SkidSoundStop;
+	TSoftObjectPtr<USoundCue> SkidSoundStop;
 
 	/** skid fadeout time */
 	UPROPERTY(Category = Effects, EditDefaultsOnly)
@@ -183,6 +225,68 @@ protected:
 	UPROPERTY(Category=Effects, EditDefaultsOnly)
 	TSubclassOf<UCameraShake> ImpactCameraShake;
 
+	/** net update frequency for a fast moving vehicle close to a viewer */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float MaxAdaptiveNetUpdateFrequency;
+
+	/** net update frequency for a stationary or distant vehicle */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float MinAdaptiveNetUpdateFrequency;
+
+	/** net update frequency while the vehicle is held on the grid by forced handbrake */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float LockedNetUpdateFrequency;
+
+	/** speed at which the vehicle is considered to be changing as fast as possible */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float NetFullRateSpeed;
+
+	/** angular speed (deg/s) at which the vehicle is considered to be changing as fast as possible */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float NetFullRateAngularSpeed;
+
+	/** change of velocity per second at which the vehicle is considered to be changing as fast as possible */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float NetFullRateAcceleration;
+
+	/** viewers closer than this get full relevance */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float NetRelevanceNearDistance;
+
+	/** viewers further than this get no relevance */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float NetRelevanceFarDistance;
+
+	/** relevance of the vehicle for its own driver, who is already simulating it locally */
+	UPROPERTY(Category=Replication, EditDefaultsOnly, meta = (ClampMin = "0.0", UIMin = "0.0", ClampMax = "1.0", UIMax = "1.0"))
+	float OwnerNetRelevance;
+
+	/** how often adaptive net update frequency is recalculated */
+	UPROPERTY(Category=Replication, EditDefaultsOnly)
+	float AdaptiveNetUpdateInterval;
+
+	/** time of last adaptive net update frequency recalculation */
+	float LastAdaptiveNetUpdateTime;
+
+	/** velocity at the last recalculation, used to estimate acceleration */
+	FVector LastAdaptiveNetVelocity;
+
+	/** movement between two frames longer than this is treated as teleport and never crosses track points */
+	UPROPERTY(Category=Track, EditDefaultsOnly)
+	float MaxTrackPointSweepDistance;
+
+	/** recent transforms, used to find exact track point crossing times [Server only] */
+	FVehicleTransformHistory TransformHistory;
+
+	/** keeps effect assets loaded while pawn exists [Client only] */
+	TSharedPtr<FStreamableHandle> EffectsHandle;
+
+	/** request async load of sounds and effects, dedicated servers never load them */
+	void LoadEffects();
+
+	/** sounds and effects finished loading */
+	void OnEffectsLoaded();
+
 	/** How much throttle forward (max 1.0f) or reverse (max -1.0f) */
 	float ThrottleInput;
 
@@ -220,6 +324,15 @@ protected:
 	/** Plays explosion particle and audio. */
 	void PlayDestructionFX();
 
+	/** hide dead vehicle and stop its physics, sounds and effects, components are kept */
+	void DeactivateVehicle();
+
+	/** show vehicle again and restart what DeactivateVehicle stopped */
+	void ReactivateVehicle();
+
+	/** record transform and credit track points crossed since last frame [Server only] */
+	void UpdateTrackPointCrossings();
+
 protected:
 	/** Returns SpringArm subobject **/
 	FORCEINLINE USpringArmComponent* GetSpringArm() const { return SpringArm; }
@@ -229,6 +342,8 @@ protected:
 	FORCEINLINE UAudioComponent* GetEngineAC() const { return EngineAC; }
 	/** Returns SkidAC subobject **/
 	FORCEINLINE UAudioComponent* GetSkidAC() const { return SkidAC; }
+	/** Returns GhostRecorder subobject **/
+	FORCEINLINE UVehicleGhostRecorderComponent* GetGhostRecorder() const { return GhostRecorder; }
 };
 
 
@@ -0,0 +1,47 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Fixed size ring buffer of past vehicle locations.
+ * Server uses it to resolve track point crossings between physics frames.
+ */
+struct FVehicleTransformHistory
+{
+	/** single recorded location */
+	struct FSample
+	{
+		/** world time of the sample */
+		float Time;
+
+		/** vehicle location */
+		FVector Location;
+	};
+
+	/** number of kept samples - about one second at 60Hz, 1KB per vehicle */
+	static const int32 MaxSamples = 64;
+
+	FVehicleTransformHistory();
+
+	/** records new sample, overwriting the oldest one if buffer is full */
+	void Add(float Time, const FVector& Location);
+
+	/** forgets all samples, used after teleports */
+	void Reset();
+
+	/** number of valid samples */
+	int32 Num() const;
+
+	/** get sample by age, 0 is the newest one */
+	const FSample& GetSample(int32 Age) const;
+
+private:
+	/** sample storage */
+	FSample Samples[MaxSamples];
+
+	/** index of the newest sample */
+	int32 Head;
+
+	/** number of valid samples */
+	int32 Count;
+};
@@ -0,0 +1,109 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Player/VehicleAIDriving.h"
+#include "VehicleAIController.generated.h"
+
+class ABuggyPawn;
+class AVehicleTrackPoint;
+
+/**
+ * Bot driver, follows the racing line or the ordered track points. [Server only]
+ * Driving decisions of all bots are made together by FVehicleAIDrivingBatch, the controller
+ * applies them and respawns at the last track point when stuck.
+ */
+UCLASS(config=Game)
+class AVehicleAIController : public AController
+{
+	GENERATED_UCLASS_BODY()
+
+	/** checkpoint on track, bot respawns there */
+	UPROPERTY(BlueprintReadOnly, transient, Category=Game)
+	AVehicleTrackPoint* LastTrackPoint;
+
+	// Begin AController overrides
+	virtual void Possess(APawn* InPawn) override;
+	virtual void PawnPendingDestroy(APawn* InPawn) override;
+	// End AController overrides
+
+	/** notify about touching new checkpoint */
+	void OnTrackPointReached(AVehicleTrackPoint* TrackPoint);
+
+	/** is handbrake forced? */
+	bool IsHandbrakeForced() const;
+
+	/** set handbrake forced */
+	void SetHandbrakeForced(bool bNewForced);
+
+	/** destroy vehicle, it respawns at last track point */
+	void Suicide();
+
+	/** forget track progress and pending respawn of previous race */
+	void ResetRaceProgress();
+
+	/** 
+	 * Feed driving decision to the vehicle
+	 *
+	 * @param	Throttle		throttle input, negative brakes or reverses
+	 * @param	Steering		steering input
+	 * @param	bHandbrake		should handbrake be pulled?
+	 * @param	bNewReversing	is bot backing up to turn around?
+	 * @param	NewRacingLineDistance	distance of vehicle along the racing line
+	 * @param	DeltaSeconds	frame time, for stuck detection
+	 */
+	void ApplyDriving(float Throttle, float Steering, bool bHandbrake, bool bNewReversing, float NewRacingLineDistance, float DeltaSeconds);
+
+	/** get driving tuning */
+	const FVehicleAIDriverSettings& GetDriverSettings() const { return DriverSettings; }
+
+	/** get index of the track point bot drives to */
+	int32 GetNextTrackPointIndex() const { return NextTrackPointIndex; }
+
+	/** is bot backing up to turn around? */
+	bool IsReversing() const { return bReversing; }
+
+	/** get distance of vehicle along the racing line, negative if not known yet */
+	float GetRacingLineDistance() const { return RacingLineDistance; }
+
+protected:
+	/** driving tuning */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	FVehicleAIDriverSettings DriverSettings;
+
+	/** vehicle slower than this counts as stuck */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float StuckSpeed;
+
+	/** seconds of being stuck or upside down before respawning */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float MaxStuckTime;
+
+	/** delay between losing vehicle and respawning */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float RespawnDelay;
+
+	/** index of the track point bot drives to */
+	int32 NextTrackPointIndex;
+
+	/** how long vehicle has been stuck */
+	float StuckTime;
+
+	/** is bot backing up to turn around? */
+	bool bReversing;
+
+	/** distance of vehicle along the racing line, negative until first found */
+	float RacingLineDistance;
+
+	/** if set, handbrake will be forced */
+	bool bHandbrakeOverride;
+
+	/** Handle for efficient management of Respawn timer */
+	FTimerHandle TimerHandle_Respawn;
+
+	/** restart with new vehicle */
+	void Respawn();
+
+	/** respawn if vehicle didn't move or lies on its roof for too long */
+	void UpdateStuck(ABuggyPawn* MyPawn, float DeltaSeconds);
+};
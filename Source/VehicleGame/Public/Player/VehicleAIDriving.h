@@ -0,0 +1,146 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "VehicleAIDriving.generated.h"
+
+class AVehicleAIController;
+class UVehicleRacingLine;
+
+/** bot driving tuning */
+USTRUCT()
+struct FVehicleAIDriverSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** base distance of steering target ahead of vehicle */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float LookAheadDistance;
+
+	/** steering target moves further ahead by this many seconds of travel at current speed */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float LookAheadTime;
+
+	/** angle to steering target that turns the wheels fully */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float MaxSteeringAngle;
+
+	/** speed on straights, cm/s */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float MaxSpeed;
+
+	/** slowest planned speed, so tight corners don't stop the bot */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float MinSpeed;
+
+	/** sideways acceleration the vehicle holds in corners, cm/s^2 */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float MaxLateralAcceleration;
+
+	/** deceleration assumed when braking before corners, cm/s^2 */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float BrakingDeceleration;
+
+	/** racing line target speed is read this many seconds of travel ahead, covers throttle response */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float SpeedLeadTime;
+
+	/** speed error that gives full throttle or brake */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float SpeedControlRange;
+
+	/** number of upcoming track points considered by speed planning */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	int32 NumPlannedTrackPoints;
+
+	/** handbrake is pulled when steering target is further to the side than this */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float HandbrakeAngle;
+
+	/** handbrake is only pulled above this speed */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float HandbrakeMinSpeed;
+
+	/** bot facing the wrong way backs up to turn around when slower than this */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float ReverseMaxSpeed;
+
+	/** cars closer than this ahead are avoided */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float AvoidanceDistance;
+
+	/** cars further to the side than this are not in our way */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float AvoidanceWidth;
+
+	/** steering added to pass a car right ahead */
+	UPROPERTY(EditDefaultsOnly, Category=AI)
+	float AvoidanceSteering;
+
+	FVehicleAIDriverSettings();
+};
+
+/**
+ * Driving decisions of all bots, made in one batch. [Server only]
+ * Bots follow the baked racing line of the map, or the track points if there is none.
+ * Vehicle state is gathered into flat arrays on the game thread, throttle, steering and handbrake
+ * are computed for every driver on worker threads and applied through the pawn input handlers
+ * back on the game thread.
+ */
+class FVehicleAIDrivingBatch
+{
+public:
+	FVehicleAIDrivingBatch();
+
+	/** gather bots of World, compute and apply their input */
+	void Update(UWorld* World, float DeltaSeconds);
+
+	/** resize driver arrays, keeps allocations */
+	void SetNumDrivers(int32 NumDrivers);
+
+	/** compute output for gathered state, bParallel spreads drivers over worker threads */
+	void Compute(bool bParallel);
+
+	/** track point locations in driving order */
+	TArray<FVector> TrackPoints;
+
+	/** baked racing line followed instead of track points when set */
+	const UVehicleRacingLine* RacingLine;
+
+	// per driver state, gathered on game thread
+
+	TArray<FVector> Locations;
+	TArray<FVector> Forwards;
+	TArray<FVector> Rights;
+	TArray<float> Speeds;
+	TArray<int32> NextTrackPoints;
+	TArray<const FVehicleAIDriverSettings*> Settings;
+
+	// per driver output, Reversing and RacingLineDistances are also read as state
+
+	TArray<float> Throttles;
+	TArray<float> Steerings;
+	TArray<bool> Handbrakes;
+	TArray<bool> Reversing;
+	TArray<float> RacingLineDistances;
+
+private:
+	/** compute output of single driver, reads shared state only */
+	void ComputeDriver(int32 DriverIdx);
+
+	/** location of track point Offset points after NextTrackPoint, Offset -1 is the last passed one */
+	FORCEINLINE const FVector& GetPathPoint(int32 NextTrackPoint, int32 Offset) const
+	{
+		const int32 NumTrackPoints = TrackPoints.Num();
+		return TrackPoints[((NextTrackPoint + Offset) % NumTrackPoints + NumTrackPoints) % NumTrackPoints];
+	}
+
+	/** point Distance ahead of From along the track */
+	FVector GetLookAheadPoint(int32 NextTrackPoint, const FVector& From, float Distance) const;
+
+	/** fastest speed at From that still brakes down to the corner speed of every upcoming track point */
+	float GetPlannedSpeed(int32 NextTrackPoint, const FVector& From, const FVehicleAIDriverSettings& DriverSettings) const;
+
+	/** controllers matching per driver arrays */
+	TArray<AVehicleAIController*> Controllers;
+};
@@ -0,0 +1,97 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+class ABuggyPawn;
+class AVehiclePlayerState;
+
+/**
+ * Deterministic input log for physics regression runs.
+ *
+ * Started with -VehicleInputRecord or -VehicleInputReplay on a fixed timestep game (-benchmark -fps=60).
+ * Record mode stores driver input of every tick into Test/InputReplay/<Map>.vinput and the resulting
+ * vehicle state hashes and lap times into <Map>.vgolden. Replay mode feeds the stored input through
+ * the pawn input handlers, compares against the golden file and writes Saved/InputReplay/<Map>.result.
+ */
+class FVehicleInputReplay
+{
+public:
+	enum class EMode : uint8
+	{
+		Record,
+		Replay,
+	};
+
+	/** create from command line switches, null if no input replay was requested */
+	static TUniquePtr<FVehicleInputReplay> CreateFromCommandLine(UWorld* World);
+
+	FVehicleInputReplay(EMode InMode, const FString& InMapName);
+
+	/** hash state left by last physics step, then record or inject input of this tick, call after player input was processed */
+	void Tick(ABuggyPawn* Pawn, AVehiclePlayerState* PlayerState);
+
+	/** store files or compare lap times, write result and request exit */
+	void Finish(AVehiclePlayerState* PlayerState, const FString& Reason);
+
+	/** is run over? */
+	bool IsFinished() const { return bFinished; }
+
+	/** input log file for given map */
+	static FString GetInputLogFilename(const FString& MapName);
+
+	/** golden file for given map */
+	static FString GetGoldenFilename(const FString& MapName);
+
+	/** replay result file for given map */
+	static FString GetResultFilename(const FString& MapName);
+
+private:
+	/** driver input of single tick, quantized so replay feeds exactly what was recorded */
+	struct FInput
+	{
+		int8 Throttle;
+		int8 Steering;
+		uint8 bHandbrake;
+
+		friend FArchive& operator<<(FArchive& Ar, FInput& Input)
+		{
+			return Ar << Input.Throttle << Input.Steering << Input.bHandbrake;
+		}
+	};
+
+	/** hash of quantized vehicle location, rotation and velocity */
+	static uint32 HashVehicleState(ABuggyPawn* Pawn);
+
+	/** load input log and golden file, false if either is missing or doesn't match tick rate */
+	bool Load();
+
+	/** write input log and golden file */
+	bool Save();
+
+	EMode Mode;
+
+	FString MapName;
+
+	/** ticks per second, taken from fixed time step */
+	int32 TickRate;
+
+	/** index of the next tick */
+	int32 TickIndex;
+
+	/** input of every tick */
+	TArray<FInput> Inputs;
+
+	/** vehicle state hash at the start of every tick */
+	TArray<uint32> StateHashes;
+
+	/** duration of every completed lap, loaded from golden file in replay mode */
+	TArray<float> LapTimes;
+
+	/** first tick whose state hash didn't match golden file, INDEX_NONE if all matched so far */
+	int32 FirstMismatchTick;
+
+	bool bFinished;
+
+	/** recording stops after this many ticks even if race isn't finished */
+	int32 MaxTicks;
+};
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Player/VehicleInputReplay.h"
 #include "VehiclePlayerController.generated.h"
 
 class AVehicleTrackPoint;
@@ -17,6 +18,7 @@ class AVehiclePlayerController : public APlayerController
 	
 	// Begin PlayerController overrides
 	virtual void UnFreeze() override;
+	virtual void PlayerTick(float DeltaTime) override;
 	// End PlayerController overrides
 
 	/** notify about touching new checkpoint */
@@ -33,6 +35,12 @@ class AVehiclePlayerController : public APlayerController
 
 	void Suicide();
 
+	/** get current server world time, estimated from clock sync on clients */
+	float GetServerTime() const;
+
+	/** has at least one clock sync round trip completed? */
+	bool HasClockSync() const;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Replication
 
@@ -40,8 +48,57 @@ class AVehiclePlayerController : public APlayerController
 	UFUNCTION(reliable, server, WithValidation)
 	void ServerSuicide();
 
+	/** ask server for its time, ClientSendTime is echoed back to measure round trip */
+	UFUNCTION(unreliable, server, WithValidation)
+	void ServerRequestClockSync(float ClientSendTime);
+
+	/** server time response to ServerRequestClockSync */
+	UFUNCTION(unreliable, client)
+	void ClientReceiveClockSync(float ClientSendTime, float ServerTime);
+
 protected:
 
+	/** number of kept clock sync samples */
+	static const int32 NumClockSyncSamples = 8;
+
+	/** single clock sync measurement */
+	struct FClockSyncSample
+	{
+		/** request round trip time */
+		float RoundTripTime;
+
+		/** server time - local time, assuming symmetric latency */
+		float Offset;
+	};
+
+	/** recent clock sync samples, ring buffer */
+	FClockSyncSample ClockSyncSamples[NumClockSyncSamples];
+
+	/** total number of received clock sync samples */
+	int32 NumClockSyncSamplesTaken;
+
+	/** server time - local time, taken from the sample with the shortest round trip */
+	float ClockOffset;
+
+	/** standard deviation of round trip time over kept samples */
+	float ClockJitter;
+
+	/** time between clock sync requests once the first samples are in */
+	UPROPERTY(EditDefaultsOnly, Category=Replication)
+	float ClockSyncInterval;
+
+	/** Handle for efficient management of SendClockSyncRequest timer */
+	FTimerHandle TimerHandle_ClockSync;
+
+	/** sends next clock sync request */
+	void SendClockSyncRequest();
+
+	/** input recording or replay for physics regression runs, see FVehicleInputReplay */
+	TUniquePtr<FVehicleInputReplay> InputReplay;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** if set, handbrake will be forced */
 	UPROPERTY(transient, replicated)
 	bool bHandbrakeOverride;
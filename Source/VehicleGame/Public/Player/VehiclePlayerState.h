@@ -0,0 +1,45 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "VehiclePlayerState.generated.h"
+
+UCLASS()
+class AVehiclePlayerState : public APlayerState
+{
+	GENERATED_UCLASS_BODY()
+
+	/** number of track points crossed in current race */
+	UPROPERTY(Transient, Replicated)
+	int32 NumTrackPointsPassed;
+
+	/** index of last crossed track point in AVehicleGameState::GetTrackPoints(), INDEX_NONE before the first one */
+	UPROPERTY(Transient, Replicated)
+	int32 LastTrackPointIndex;
+
+	/** number of completed laps */
+	UPROPERTY(Transient, Replicated)
+	int32 NumLapsCompleted;
+
+	/** server time of last track point crossing, interpolated between physics frames [Server only] */
+	float LastTrackPointTime;
+
+	/** has crossed the finish line? */
+	UPROPERTY(Transient, Replicated)
+	bool bHasFinished;
+
+	/** lag compensated race time at the finish line */
+	UPROPERTY(Transient, Replicated)
+	float FinishTime;
+
+	/** lag compensated duration of every completed lap, recorded at the line on server */
+	UPROPERTY(Transient, Replicated)
+	TArray<float> LapTimes;
+
+	/** current place in race, 1 is leading, 0 before race progress is known */
+	UPROPERTY(Transient, Replicated)
+	int32 RacePlace;
+
+	/** forget progress of previous race [Server only] */
+	void ResetRaceProgress();
+};
@@ -0,0 +1,75 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+class UVehicleStreamingGrid;
+class UVehicleRacingLine;
+class ULevelStreaming;
+
+/**
+ * Streams cell sublevels of a UVehicleStreamingGrid around racers of a world.
+ *
+ * Every machine streams on its own: cells within vehicle.GridStreamingRadius of any vehicle, of the
+ * vehicle's predicted position vehicle.GridStreamingLookAhead seconds ahead along the racing line, of
+ * player starts and of local views are loaded asynchronously, others are unloaded. Dedicated servers
+ * stream only colliding cells with vehicle.GridStreamingServerCollisionOnly. Cell load times, loaded
+ * cells and used memory are logged when the map ends and by vehicle.GridStreamingStats.
+ */
+class FVehicleGridStreamer
+{
+public:
+	FVehicleGridStreamer(UWorld* InWorld, const UVehicleStreamingGrid* InGrid, const UVehicleRacingLine* InRacingLine);
+
+	/**
+	 * Request and release cells around current focus points, throttled by vehicle.GridStreamingInterval
+	 *
+	 * @param	bBlockOnLoad	update now and wait until requested cells are loaded, used before racers spawn
+	 */
+	void Update(bool bBlockOnLoad = false);
+
+	/** log load times and memory measured so far */
+	void LogStats() const;
+
+private:
+	/** locations cells must be loaded around */
+	void GatherFocusPoints(TArray<FVector>& OutPoints);
+
+	/** world being streamed */
+	UWorld* World;
+
+	/** cells of the map, kept alive by owner */
+	const UVehicleStreamingGrid* Grid;
+
+	/** racing line predictions follow, may be null */
+	const UVehicleRacingLine* RacingLine;
+
+	/** racing line distance of every pawn at last update, search hint for the next one */
+	TMap<TWeakObjectPtr<APawn>, float> RacingLineDistances;
+
+	/** streaming level of every grid cell, null for cells this machine never loads */
+	TArray<ULevelStreaming*> CellLevels;
+
+	/** time load of every cell was requested, 0 once it is visible or if it is not wanted */
+	TArray<double> LoadRequestTimes;
+
+	/** time of last update */
+	double LastUpdateTime;
+
+	/** number of cell loads requested */
+	int32 NumLoadRequests;
+
+	/** number of requested cells that became visible */
+	int32 NumLoadsCompleted;
+
+	/** sum of cell load times, s */
+	double TotalLoadTime;
+
+	/** longest cell load, s */
+	double MaxLoadTime;
+
+	/** most cells loaded at once */
+	int32 PeakLoadedCells;
+
+	/** highest used physical memory seen by updates, bytes */
+	uint64 PeakUsedPhysical;
+};
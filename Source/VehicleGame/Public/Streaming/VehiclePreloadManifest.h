@@ -0,0 +1,30 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "VehiclePreloadManifest.generated.h"
+
+/**
+ * Assets a map loads on first use during races, baked by the VehiclePreload commandlet from runs
+ * recorded with -VehiclePreloadRecord. FVehiclePreloader requests them while the map loads.
+ */
+UCLASS()
+class UVehiclePreloadManifest : public UDataAsset
+{
+	GENERATED_UCLASS_BODY()
+
+	/** assets ordered by first use, earliest first */
+	UPROPERTY(VisibleAnywhere, Category=Preload)
+	TArray<FSoftObjectPath> Assets;
+
+	/** earliest first use of every asset over all recorded runs, seconds after map load */
+	UPROPERTY(VisibleAnywhere, Category=Preload)
+	TArray<float> FirstUseTimes;
+
+	/** load manifest baked for map, null if there is none */
+	static UVehiclePreloadManifest* LoadForMap(const FString& MapName);
+
+	/** package the manifest of given map is baked into */
+	static FString GetPackageName(const FString& MapName);
+};
@@ -0,0 +1,107 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+struct FStreamableHandle;
+
+/**
+ * Moves first use loads of a map into its loading screen.
+ *
+ * With -VehiclePreloadRecord every package a map loads after it finished loading is logged with the time
+ * of its first use into Saved/Preload/<Map>/<Timestamp>.csv; the VehiclePreload commandlet bakes those
+ * runs into UVehiclePreloadManifest. When a map starts loading, assets of its manifest are requested
+ * asynchronously, earliest used first. Hitches over the first vehicle.HitchWindow seconds of every map
+ * are logged, compare runs with vehicle.Preload 0 and 1 to see the difference.
+ */
+class FVehiclePreloader
+{
+public:
+	/** create preloader of this process, hooks map loading, not on dedicated servers */
+	static void Initialize();
+
+	/** destroy preloader, running recording was already written on engine exit */
+	static void Shutdown();
+
+	/** directory recorded runs of given map are written to */
+	static FString GetRecordingDir(const FString& MapName);
+
+	FVehiclePreloader();
+	~FVehiclePreloader();
+
+private:
+	/** asset loaded during recording */
+	struct FRecordedAsset
+	{
+		/** seconds after map load */
+		float UseTime;
+
+		/** main asset of loaded package */
+		FSoftObjectPath Path;
+	};
+
+	/** finish recording of previous map and request preload of the new one */
+	void OnPreLoadMap(const FString& MapURL);
+
+	/** start recording and hitch counting */
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	/** finish recording and release preloaded assets while engine still runs */
+	void OnPreExit();
+
+	/** ticker callback, counts hitches and looks for newly loaded packages */
+	bool Tick(float DeltaTime);
+
+	/** request assets of map manifest, keeping previous map's preload until the new one is requested */
+	void RequestPreload(const FString& MapName);
+
+	/** record packages loaded since last call */
+	void CollectNewPackages();
+
+	/** write recorded run to disk */
+	void StopRecording();
+
+	/** log hitches counted so far */
+	void ReportHitches();
+
+	/** is recording requested by -VehiclePreloadRecord? */
+	bool bRecordingEnabled;
+
+	/** map being recorded, empty if none */
+	FString RecordingMapName;
+
+	/** packages loaded before recording started or already recorded */
+	TSet<FName> KnownPackages;
+
+	/** assets loaded during recording, in order of first use */
+	TArray<FRecordedAsset> RecordedAssets;
+
+	/** time of last CollectNewPackages */
+	double LastCollectTime;
+
+	/** time current map finished loading */
+	double MapLoadTime;
+
+	/** keep preloaded assets of current map in memory */
+	TArray<TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+	/** number of assets requested for current map, 0 without manifest or with vehicle.Preload 0 */
+	int32 NumPreloadAssets;
+
+	/** map hitches are counted for, empty if window is over */
+	FString HitchMapName;
+
+	/** number of frames over vehicle.HitchThreshold */
+	int32 NumHitches;
+
+	/** longest frame, ms */
+	float WorstHitchTime;
+
+	/** first frame after map load is the load itself, it is not counted */
+	bool bSkipNextFrame;
+
+	/** handle of ticker */
+	FDelegateHandle TickerHandle;
+
+	/** preloader of this process */
+	static TUniquePtr<FVehiclePreloader> Instance;
+};
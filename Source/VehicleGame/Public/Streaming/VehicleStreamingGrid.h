@@ -0,0 +1,60 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "VehicleStreamingGrid.generated.h"
+
+/** sublevel holding the actors of one grid cell */
+USTRUCT()
+struct FVehicleStreamingCell
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** long package name of the sublevel */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	FName PackageName;
+
+	/** bounds of all actors in the sublevel, may reach over the cell edges */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	FBox Bounds;
+
+	/** cell coordinates, world location divided by cell size */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	FIntPoint Coords;
+
+	/** does the sublevel hold colliding actors? otherwise it is visual only and skipped by servers */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	bool bCollision;
+
+	FVehicleStreamingCell()
+		: Bounds(ForceInit)
+		, Coords(0, 0)
+		, bCollision(false)
+	{
+	}
+};
+
+/**
+ * Cell sublevels a map was split into by the VehicleStreamingGrid commandlet.
+ * FVehicleGridStreamer streams them in and out around racers while the map is played.
+ */
+UCLASS()
+class UVehicleStreamingGrid : public UDataAsset
+{
+	GENERATED_UCLASS_BODY()
+
+	/** edge length of cells, cm */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	float CellSize;
+
+	/** cell sublevels, every cell has up to one colliding and one visual sublevel */
+	UPROPERTY(VisibleAnywhere, Category=Streaming)
+	TArray<FVehicleStreamingCell> Cells;
+
+	/** load grid baked for map, null if map was not split */
+	static UVehicleStreamingGrid* LoadForMap(const FString& MapName);
+
+	/** package the grid of given map is baked into */
+	static FString GetPackageName(const FString& MapName);
+};
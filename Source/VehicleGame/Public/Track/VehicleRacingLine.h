@@ -0,0 +1,59 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "VehicleRacingLine.generated.h"
+
+/**
+ * Racing line baked offline by the VehicleRacingLine commandlet.
+ * Closed loop sampled at even spacing starting at the first track point, so lookups by
+ * distance along the line are a single index computation.
+ */
+UCLASS()
+class UVehicleRacingLine : public UDataAsset
+{
+	GENERATED_UCLASS_BODY()
+
+	/** distance between neighbouring samples, cm */
+	UPROPERTY(VisibleAnywhere, Category=RacingLine)
+	float SampleSpacing;
+
+	/** line samples */
+	UPROPERTY(VisibleAnywhere, Category=RacingLine)
+	TArray<FVector> Points;
+
+	/** target speed at every sample, cm/s */
+	UPROPERTY(VisibleAnywhere, Category=RacingLine)
+	TArray<uint16> TargetSpeeds;
+
+	/** is line baked and consistent? */
+	bool HasSamples() const;
+
+	/** get length of the loop */
+	float GetLength() const;
+
+	/** get location at distance along the line, wraps around */
+	FVector GetLocationAtDistance(float Distance) const;
+
+	/** get target speed at distance along the line, wraps around */
+	float GetTargetSpeedAtDistance(float Distance) const;
+
+	/**
+	 * Find distance along the line closest to Location
+	 *
+	 * @param	Location		world location
+	 * @param	HintDistance	previous result, only its neighbourhood is searched unless Location is far from it; negative searches the whole line
+	 */
+	float FindDistance(const FVector& Location, float HintDistance) const;
+
+	/** load line baked for map, null if there is none */
+	static UVehicleRacingLine* LoadForMap(const FString& MapName);
+
+	/** package the line of given map is baked into */
+	static FString GetPackageName(const FString& MapName);
+
+protected:
+	/** wrap distance into [0, length) and split into sample index and fraction */
+	void GetSampleAtDistance(float Distance, int32& OutIndex, float& OutAlpha) const;
+};
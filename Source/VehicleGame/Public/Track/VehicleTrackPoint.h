@@ -12,18 +12,50 @@ class AVehicleTrackPoint : public AActor
 {
 	GENERATED_UCLASS_BODY()
 
-#if WITH_EDITORONLY_DATA
 private:
+	/** gate volume, crossed along its X axis */
+	UPROPERTY()
+	UBoxComponent* TriggerComponent;
+
+#if WITH_EDITORONLY_DATA
 	UPROPERTY()
 	UBillboardComponent* SpriteComponent;
 
 	UPROPERTY()
 	UArrowComponent* ArrowComponent;
-public:
 #endif
+public:
 
+	/** order of this point along the track, lower values come first */
+	UPROPERTY(EditAnywhere, Category=Track)
+	int32 TrackPointOrder;
+
+	/** crossing this point after all others completes a lap, the last track point does if none is flagged */
+	UPROPERTY(EditAnywhere, Category=Track)
+	bool bIsFinishLine;
+
+	// Begin Actor overrides
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/** set checkpoint for touching vehicle */
 	virtual void NotifyActorBeginOverlap(AActor* Other) override;
+	// End Actor overrides
+
+	/**
+	 * Test if segment crosses the gate in its forward direction.
+	 *
+	 * @param	Start		segment start in world space
+	 * @param	End			segment end in world space
+	 * @param	OutAlpha	position of the crossing along the segment, 0 = Start, 1 = End
+	 * @returns	true if the gate was crossed
+	 */
+	bool GetSegmentCrossing(const FVector& Start, const FVector& End, float& OutAlpha) const;
+
+	/** sort predicate of track points along the track, ties are broken by name so every machine gets the same order */
+	static bool IsBefore(const AVehicleTrackPoint& A, const AVehicleTrackPoint& B);
+
+	/** Returns TriggerComponent subobject **/
+	FORCEINLINE UBoxComponent* GetTriggerComponent() const { return TriggerComponent; }
 
 #if WITH_EDITORONLY_DATA
 	/** Returns SpriteComponent subobject **/
@@ -67,6 +67,6 @@ private:
 	/** quits the game */
 	void Quit();
 
-	/** Display the a loading screen for the given action if it is required. */
-	void ShowLoadingScreen();		
+	/** Display the a loading screen showing load progress of the map being traveled to. */
+	void ShowLoadingScreen(const FString& MapPackageName);		
 };
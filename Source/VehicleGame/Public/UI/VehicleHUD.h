@@ -3,13 +3,16 @@
 #pragma once
 
 #include "VehicleTypes.h"
+#include "VehicleRaceEvents.h"
+#include "UI/VehicleMinimap.h"
 #include "VehicleHUD.generated.h"
 
-class AVehicleTrackPoint;
+class AVehicleGameState;
 class SWeakWidget;
 class SVehicleMenuWidget;
 class SVehicleHUDWidget;
 class SVehicleControlsSetup;
+struct FStreamableHandle;
 
 namespace EVehicleGameMenu
 {
@@ -57,11 +60,12 @@ class AVehicleHUD : public AHUD
 	/** controls settings menu */
 	MenuPtr ControlsMenu;
 
-	/** main HUD update loop */
+	/** draws canvas elements only, widgets are built once and updated through events */
 	virtual void DrawHUD() override;
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	/** shows/hides in game menu */
@@ -73,6 +77,9 @@ public:
 	/** enables/disables game HUD display */
 	void EnableHUD(bool bEnable);
 
+	/** subscribes to race events, called again by game state when it replicates after HUD is created */
+	void BindRaceEvents();
+
 protected:
 
 	/** if game HUD should be drawn */
@@ -81,9 +88,6 @@ protected:
 	/** if game menu is currently opened*/
 	bool bIsGameMenuUp;
 
-	/** last notified track point */
-	TWeakObjectPtr<AVehicleTrackPoint> LastTrackPoint;
-
 	/** game menu container widget - used for removing */
 	TSharedPtr<SWeakWidget> GameMenuContainer;
 
@@ -102,15 +106,27 @@ protected:
 	/** quality descriptions list */
 	TArray<FText> LowHighList;
 
-	/** called when a hit box is clicked on. Provides the name associated with that box. */
-	virtual void NotifyHitBoxClick(FName BoxName) override;
+	/** store lap and race times of local racer under given name */
+	void SubmitLeaderboardTimes(const FString& RacerName);
 
 	/** menu callback */
 	void ExecuteMenuAction(EVehicleGameMenu::Type Action);
 
-	/** creates in game menu */
+	/** creates HUD widget in owner's view, done once when HUD begins play */
+	void BuildHUDWidget();
+
+	/** creates in game menu, done when it is first opened */
 	void BuildMenuWidgets();
 
+	/** graphics quality setting changed, updates menu item */
+	void OnGraphicsQualityChanged();
+
+	/** push race time, speed and place to HUD widget, it repaints only what changed */
+	void UpdateHUDWidget();
+
+	/** race event handler, updates HUD and plays sounds */
+	void OnRaceEvent(const FVehicleRaceEvent& Event);
+
 	/** removes widget from viewport */
 	void DetachGameMenu();
 	
@@ -126,41 +142,58 @@ protected:
 	/** Used to display debug/helper messages eg Server/Client. */
 	void DrawDebugInfoString(const FString& Text, float PosX, float PosY, bool bAlignLeft, bool bAlignTop, const FColor& TextColor);
 
-	/** speed meter material default instance reference */
+	/** minimap racer and ghost icon */
 	UPROPERTY()
-	UMaterialInstanceConstant* SpeedMeterMaterialConst;
+	TSoftObjectPtr<UTexture2D> MinimapRacerIcon;
 
-	/** speed meter material with current parameters */
+	/** minimap checkpoint icon */
 	UPROPERTY()
-	UMaterialInstanceDynamic* SpeedMeterMaterial;
+	TSoftObjectPtr<UTexture2D> MinimapCheckpointIcon;
 
-	/** font used in HUD */
-	UPROPERTY()
-	UFont* HUDFont;
+	/** track map with racers, ghosts and checkpoints */
+	FVehicleMinimap Minimap;
 
-	/** timer background */
-	UPROPERTY()
-	UTexture2D* TimerBackground;
+	/** if local racer finished and its times go to leaderboard once player state has them */
+	uint8 bLeaderboardSubmitPending : 1;
 
-	/** place background */
-	UPROPERTY()
-	UTexture2D* PlaceBackground;
+	/** keeps HUD assets loaded while HUD exists */
+	TSharedPtr<FStreamableHandle> HUDAssetsHandle;
 
-	/** current highscore name */
-	TArray<char> HighScoreName;
+	/** request async load of assets drawn by HUD */
+	void LoadHUDAssets();
 
-	/** current letter to change while entering highscore name */
-	uint8 CurrentLetter;
+	/** HUD assets finished loading */
+	void OnHUDAssetsLoaded();
 
-	/* if we should show enter name prompt */
-	uint8 bEnterNamePromptActive : 1;
+	/** UI Scale */
+	float UIScale;
 
-	/** up button texture */
-	UTexture2D* UpButtonTexture;
+	/** game state we receive race events from */
+	TWeakObjectPtr<AVehicleGameState> RaceEventSource;
 
-	/** down button texture*/
-	UTexture2D* DownButtonTexture;
+	/** handle of race event subscription */
+	FDelegateHandle RaceEventHandle;
 
-	/** UI Scale */
-	float UIScale;
+	/** handle of graphics quality subscription */
+	FDelegateHandle QualityChangedHandle;
+
+	/** countdown tick sound */
+	UPROPERTY(EditDefaultsOnly, Category=Sound)
+	USoundBase* CountdownSound;
+
+	/** race start sound */
+	UPROPERTY(EditDefaultsOnly, Category=Sound)
+	USoundBase* RaceStartSound;
+
+	/** own checkpoint sound */
+	UPROPERTY(EditDefaultsOnly, Category=Sound)
+	USoundBase* CheckpointSound;
+
+	/** own lap sound */
+	UPROPERTY(EditDefaultsOnly, Category=Sound)
+	USoundBase* LapSound;
+
+	/** own finish sound */
+	UPROPERTY(EditDefaultsOnly, Category=Sound)
+	USoundBase* FinishSound;
 };
@@ -0,0 +1,97 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+class AVehicleGameState;
+
+/**
+ * Top down track map drawn into the HUD canvas.
+ * Icons are collected into one triangle list per icon type and every list is a single canvas draw,
+ * so cost barely grows with the number of racers and ghosts. Racer locations come from
+ * AVehicleGameState::GetRacerProgress, checkpoint icons are rebuilt only when track or canvas changes.
+ * Maps without track points show racers and ghosts only, fitted to everywhere they have been.
+ */
+class FVehicleMinimap
+{
+public:
+	FVehicleMinimap();
+
+	/** 
+	 * Draw minimap
+	 *
+	 * @param	Canvas		HUD canvas
+	 * @param	GameState	source of track points, racers and ghosts, racer progress must be up to date
+	 * @param	OwnerState	racer drawn highlighted, may be null
+	 */
+	void Draw(UCanvas* Canvas, AVehicleGameState* GameState, const APlayerState* OwnerState);
+
+	/** racer and ghost icon, owning HUD keeps it referenced */
+	UTexture2D* RacerIcon;
+
+	/** checkpoint icon, owning HUD keeps it referenced */
+	UTexture2D* CheckpointIcon;
+
+	/** minimap size on 1080p screen */
+	float MapSize;
+
+	/** icon size on 1080p screen */
+	float IconSize;
+
+	/** distance of minimap from screen corner on 1080p screen */
+	float ScreenMargin;
+
+private:
+	/** fit track, or fallback bounds without track points, into minimap area, false if there is nothing to fit */
+	bool UpdateTransform(UCanvas* Canvas, const AVehicleGameState* GameState);
+
+	/** extend fallback bounds to contain location */
+	void GrowFallbackBounds(const FVector& Location);
+
+	/** project world location to canvas */
+	FORCEINLINE FVector2D WorldToCanvas(const FVector& Location) const
+	{
+		return MapCenter + (FVector2D(Location) - WorldCenter) * WorldToCanvasScale;
+	}
+
+	/** append quad of single icon to triangle list */
+	static void AddIcon(TArray<FCanvasUVTri>& Triangles, const FVector2D& Center, float HalfSize, const FLinearColor& Color);
+
+	/** draw triangle list as one canvas item */
+	static void DrawIcons(UCanvas* Canvas, const TArray<FCanvasUVTri>& Triangles, UTexture2D* Texture);
+
+	/** canvas location of minimap center */
+	FVector2D MapCenter;
+
+	/** world location shown in minimap center */
+	FVector2D WorldCenter;
+
+	/** canvas pixels per world unit */
+	float WorldToCanvasScale;
+
+	/** canvas size the transform and checkpoint icons were built for */
+	FVector2D CachedCanvasSize;
+
+	/** number of track points the transform and checkpoint icons were built for */
+	int32 CachedNumTrackPoints;
+
+	/** next track point of owner the checkpoint icons were built for */
+	int32 CachedNextTrackPoint;
+
+	/** area racers and ghosts have been in, shown when level has no track points */
+	FBox2D FallbackBounds;
+
+	/** fallback bounds grew since transform was built */
+	bool bFallbackBoundsChanged;
+
+	/** ghost locations of current frame */
+	TArray<FVector> GhostLocations;
+
+	/** checkpoint icons, kept between frames */
+	TArray<FCanvasUVTri> CheckpointTriangles;
+
+	/** racer icons, rebuilt every frame */
+	TArray<FCanvasUVTri> RacerTriangles;
+
+	/** ghost icons, rebuilt every frame */
+	TArray<FCanvasUVTri> GhostTriangles;
+};
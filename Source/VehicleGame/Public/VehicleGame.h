@@ -17,6 +17,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogVehicle, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("VehicleGame"), STATGROUP_VehicleGame, STATCAT_Advanced);
+
 /** when you modify this, please note that this information can be saved with instances
  * also DefaultEngine.ini [/Script/Engine.CollisionProfile] should match with this list **/
 #define COLLISION_PICKUP		ECC_GameTraceChannel1
@@ -2,14 +2,39 @@
 
 #pragma once
 
+#include "Player/VehicleAIDriving.h"
 #include "VehicleGameMode.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRaceStartingDelegate);
 
 // Forward declarations
 class AVehicleGameState;
+class AVehiclePlayerState;
+class AVehicleTrackPoint;
+class AVehicleAIController;
+class ABuggyPawn;
 class AActor;
 
+/** dead vehicle kept for reuse, see AVehicleGameMode::ReleasePawn */
+USTRUCT()
+struct FVehiclePooledPawn
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** hidden vehicle */
+	UPROPERTY()
+	ABuggyPawn* Pawn;
+
+	/** world time vehicle entered the pool */
+	float PoolTime;
+
+	FVehiclePooledPawn()
+		: Pawn(nullptr)
+		, PoolTime(0.0f)
+	{
+	}
+};
+
 UCLASS()
 class AVehicleGameMode : public AGameModeBase
 {
@@ -19,19 +44,72 @@ class AVehicleGameMode : public AGameModeBase
 	UFUNCTION(BlueprintCallable, Category=Game)
 	void StartRace();
 
+	/** 
+	 * Announces race start at server time now + Delay, clients release their vehicles at that time on their synced clocks
+	 *
+	 * @param	Delay	seconds until start, should cover the slowest client's latency
+	 */
+	UFUNCTION(BlueprintCallable, Category=Game)
+	void ScheduleRaceStart(float Delay);
+
+	/** 
+	 * Counts down and starts race at scheduled time, broadcasting every second as race event
+	 *
+	 * @param	Seconds		length of the countdown
+	 */
+	UFUNCTION(BlueprintCallable, Category=Game)
+	void StartCountdown(int32 Seconds);
+
 	/** Finishes race */
 	void FinishRace();
 
+	/** 
+	 * Starts race over without reloading the map: clears race progress, puts vehicles 
+	 * back on their grid slots at rest and counts down again [Server only]
+	 */
+	UFUNCTION(BlueprintCallable, Category=Game)
+	void ResetRace();
+
 	/** Lock movement of newly logged in players if race is not active */
 	void EnablePlayerLocking();
 
+	/** 
+	 * Spawns bot drivers on free starts
+	 *
+	 * @param	Num		number of bots to add
+	 */
+	UFUNCTION(BlueprintCallable, Category=Game)
+	void AddBots(int32 Num);
+
 	// Begin AGameModeBase interface
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 	virtual AActor* ChoosePlayerStart_Implementation(AController* Player) override;
 	virtual AActor* FindPlayerStart_Implementation(AController* Player, const FString& IncomingName = TEXT("")) override;
 	virtual APawn* SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot) override;
 	virtual void Tick(float DeltaSeconds) override;
+	virtual void Logout(AController* Exiting) override;
 	// End AGameModeBase interface
 
+	/** 
+	 * Credit racer for crossing a track point, finish times are lag compensated [Server only]
+	 *
+	 * @param	Racer			controller of the crossing vehicle
+	 * @param	TrackPoint		crossed track point
+	 * @param	CrossingTime	world time of the crossing, interpolated between physics frames
+	 */
+	void OnTrackPointCrossed(AController* Racer, AVehicleTrackPoint* TrackPoint, float CrossingTime);
+
+	/** 
+	 * Keep dead vehicle for reuse by a later respawn instead of destroying it [Server only]
+	 *
+	 * @param	DeadPawn	vehicle already detached from its controller and deactivated
+	 * @return	false if pooling is disabled or pool is full, vehicle should be destroyed then
+	 */
+	bool ReleasePawn(ABuggyPawn* DeadPawn);
+
+	/** Get racers that crossed the finish line, ordered by their lag compensated finish time */
+	const TArray<AVehiclePlayerState*>& GetFinishedRacers() const;
+
 	/** Check if race is active */
 	bool IsRaceActive() const;
 
@@ -75,9 +153,6 @@ class AVehicleGameMode : public AGameModeBase
 
 protected:
 
-	/** Information text at the bottom of the screen */
-	FText GameInfoText;
-
 	/** Timestamp of race start */
 	float RaceStartTime;
 
@@ -87,9 +162,103 @@ protected:
 	/** Is player locking active? */
 	bool bLockingActive;
 
+	/** Number of laps to complete the race */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	int32 NumLaps;
+
+	/** Number of bots spawned at start of play, overridden by ?Bots=N URL option */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	int32 NumBots;
+
+	/** Controller class of bot drivers */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	TSubclassOf<AVehicleAIController> BotControllerClass;
+
+	/** Number of bots spawned so far, names new bots */
+	int32 NumBotsSpawned;
+
+	/** Driving decisions of all bots, made together every frame */
+	FVehicleAIDrivingBatch AIDriving;
+
+	/** Seconds left until countdown ends */
+	int32 CountdownRemaining;
+
+	/** Handle for efficient management of Countdown timer */
+	FTimerHandle TimerHandle_Countdown;
+
+	/** Handle for efficient management of StartRace timer */
+	FTimerHandle TimerHandle_RaceStart;
+
+	/** Advance countdown by one second */
+	void TickCountdown();
+
+	/** Length of the countdown started by ResetRace, 0 leaves starting the race to the level */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	int32 ResetCountdown;
+
+	/** 
+	 * Find where vehicle starting at StartSpot is placed, dropping it onto the landscape nearby
+	 *
+	 * @param	StartSpot		player start or track point
+	 * @param	IgnoredActors	actors the landscape trace passes through
+	 */
+	FTransform GetSpawnTransform(AActor* StartSpot, const TArray<AActor*>& IgnoredActors) const;
+
+	/** 
+	 * Revive pooled vehicle instead of spawning a new one
+	 *
+	 * @param	PawnClass		class vehicle must have
+	 * @param	SpawnTransform	respawn pose
+	 * @return	revived vehicle, null if none of PawnClass is ready
+	 */
+	ABuggyPawn* AcquirePawn(UClass* PawnClass, const FTransform& SpawnTransform);
+
+	/** Dead vehicles kept for reuse, oldest first */
+	UPROPERTY(Transient)
+	TArray<FVehiclePooledPawn> PooledPawns;
+
+	/** Maximum number of dead vehicles kept for reuse, 0 destroys them like before */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	int32 MaxPooledPawns;
+
+	/** Seconds a dead vehicle stays hidden in network games, so clients see it die before it comes back */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	float PooledPawnReuseDelay;
+
+	/** Finish line crossings are moved back by half of the racer's ping, up to this many seconds */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	float MaxLagCompensation;
+
+	/** Racers that crossed the finish line, ordered by finish time */
+	UPROPERTY(Transient)
+	TArray<AVehiclePlayerState*> FinishedRacers;
+
+	/** Seconds between race place updates */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	float RacePlaceInterval;
+
+	/** Handle for efficient management of UpdateRacePlaces timer */
+	FTimerHandle TimerHandle_RacePlaces;
+
+	/** Assign replicated race places from racer progress */
+	void UpdateRacePlaces();
+
 	/** Lock all players until race starts */
 	virtual void StartPlay() override;
 
+	/** Finish replay recording */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Seconds the replay keeps recording after race finish */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	float ReplayTailTime;
+
+	/** Handle for efficient management of StopReplayRecording timer */
+	FTimerHandle TimerHandle_StopReplay;
+
+	/** Finish replay recording */
+	void StopReplayRecording();
+
 	/** Lock player movement if needed */
 	virtual void PostLogin(APlayerController* NewPlayer) override;
 
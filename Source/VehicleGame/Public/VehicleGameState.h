@@ -2,8 +2,32 @@
 
 #pragma once
 
+#include "VehicleRaceEvents.h"
 #include "VehicleGameState.generated.h"
 
+class AVehicleTrackPoint;
+class AVehiclePlayerState;
+class AVehicleGhostManager;
+class UVehicleRacingLine;
+class UVehicleStreamingGrid;
+class FVehicleGridStreamer;
+
+/** racer in race order, see AVehicleGameState::GetRacerProgress */
+struct FVehicleRacerProgress
+{
+	/** racer */
+	AVehiclePlayerState* RacerState;
+
+	/** vehicle location, valid if bHasVehicle */
+	FVector Location;
+
+	/** squared distance from vehicle to next track point, MAX_flt without vehicle */
+	float DistSquaredToNext;
+
+	/** does racer currently have a vehicle? */
+	bool bHasVehicle;
+};
+
 UCLASS()
 class AVehicleGameState : public AGameStateBase
 {
@@ -25,9 +49,119 @@ class AVehicleGameState : public AGameStateBase
 	UPROPERTY(Transient, Replicated)
 	bool bIsRaceActive;
 
+	/** server world time the race is scheduled to start at, 0 if not scheduled */
+	UPROPERTY(Transient, Replicated)
+	float RaceStartServerTime;
+
 	UFUNCTION(BlueprintCallable, Category = Game)
 	float GetTotalTime();
 
 	UFUNCTION(BlueprintCallable, Category = Game)
 	bool IsRaceActive() const;
+
+	/** add track point to the registry, called when it begins play */
+	void RegisterTrackPoint(AVehicleTrackPoint* TrackPoint);
+
+	/** remove track point from the registry */
+	void UnregisterTrackPoint(AVehicleTrackPoint* TrackPoint);
+
+	/** get all track points in the level, sorted by AVehicleTrackPoint::IsBefore */
+	const TArray<AVehicleTrackPoint*>& GetTrackPoints() const;
+
+	/** get track point completing laps: first one flagged bIsFinishLine, or the last one if none is, null without track points */
+	AVehicleTrackPoint* GetFinishLine() const;
+
+	/** add ghost manager to the registry, called when it begins play */
+	void RegisterGhostManager(AVehicleGhostManager* GhostManager);
+
+	/** remove ghost manager from the registry */
+	void UnregisterGhostManager(AVehicleGhostManager* GhostManager);
+
+	/** get all ghost managers in the level */
+	const TArray<AVehicleGhostManager*>& GetGhostManagers() const;
+
+	/** order racers by finish time, passed track points and distance to their next track point, done at most once per frame */
+	void UpdateRacerProgress();
+
+	/** get racers in race order as of last UpdateRacerProgress */
+	const TArray<FVehicleRacerProgress>& GetRacerProgress() const;
+
+	/** get racing line baked for current map, null if there is none */
+	UVehicleRacingLine* GetRacingLine() const;
+
+	/** get streamer of current map's cell sublevels, null if map was not split */
+	FVehicleGridStreamer* GetGridStreamer() const;
+
+	/** load racing line and streaming grid of current map, connect local HUDs to race events */
+	virtual void BeginPlay() override;
+
+	/** stream grid cells around racers */
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** log grid streaming measurements and stop streaming */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** 
+	 * Append event to the replicated race event log and notify listeners [Server only]
+	 *
+	 * @param	Type		event type
+	 * @param	Racer		racer the event is about, null for global events
+	 * @param	Value		event specific value, see EVehicleRaceEvent
+	 * @param	RaceTime	race time of the event
+	 * @param	Text		event specific text
+	 */
+	void AddRaceEvent(EVehicleRaceEvent::Type Type, APlayerState* Racer, int32 Value, float RaceTime, const FText& Text = FText::GetEmpty());
+
+	/** get recent race events, oldest first */
+	const TArray<FVehicleRaceEvent>& GetRaceEvents() const;
+
+	/** clear race timer, progress and event log for a new race on the same map [Server only] */
+	void ResetRace();
+
+	/** set the information text at the bottom of the screen [Server only] */
+	void SetGameInfoText(const FText& InText);
+
+	/** get the information text at the bottom of the screen */
+	const FText& GetGameInfoText() const;
+
+	/** called for every new race event, on server when added and on clients when received */
+	FOnVehicleRaceEvent OnRaceEvent;
+
+protected:
+	/** replicated log of recent race events */
+	UPROPERTY(Transient, Replicated)
+	FVehicleRaceEventArray RaceEvents;
+
+	/** information text at the bottom of the screen */
+	UPROPERTY(Transient, Replicated)
+	FText GameInfoText;
+
+	/** oldest events are dropped from the log above this count */
+	UPROPERTY(EditDefaultsOnly, Category=Game)
+	int32 MaxRaceEvents;
+
+	/** track points in the level, sorted by AVehicleTrackPoint::IsBefore */
+	UPROPERTY(Transient)
+	TArray<AVehicleTrackPoint*> TrackPoints;
+
+	/** ghost managers in the level */
+	UPROPERTY(Transient)
+	TArray<AVehicleGhostManager*> GhostManagers;
+
+	/** racers in race order */
+	TArray<FVehicleRacerProgress> RacerProgress;
+
+	/** frame of last racer progress update */
+	uint64 RacerProgressFrame;
+
+	/** racing line baked for current map */
+	UPROPERTY(Transient)
+	UVehicleRacingLine* RacingLine;
+
+	/** cell sublevels current map was split into */
+	UPROPERTY(Transient)
+	UVehicleStreamingGrid* StreamingGrid;
+
+	/** streams StreamingGrid cells on this machine */
+	TSharedPtr<FVehicleGridStreamer> GridStreamer;
 };
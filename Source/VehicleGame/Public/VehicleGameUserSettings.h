@@ -3,6 +3,7 @@
 #pragma once
 
 #include "VehicleTypes.h"
+#include "Async/Future.h"
 #include "VehicleGameUserSettings.generated.h"
 
 UCLASS()
@@ -47,9 +48,16 @@ class UVehicleGameUserSettings : public UGameUserSettings
 
 	void SetGraphicsQuality(int32 InGraphicsQuality)
 	{
-		GraphicsQuality = InGraphicsQuality;
+		if (GraphicsQuality != InGraphicsQuality)
+		{
+			GraphicsQuality = InGraphicsQuality;
+			OnGraphicsQualityChanged.Broadcast();
+		}
 	}
 
+	/** called when graphics quality setting changes */
+	FSimpleMulticastDelegate OnGraphicsQualityChanged;
+
 	/** Checks if the Mouse Sensitivity user setting is different from current */
 	bool IsMouseSensitivityDirty() const;
 
@@ -65,7 +73,57 @@ class UVehicleGameUserSettings : public UGameUserSettings
 	void SetLowQuality();
 	void SetHighQuality();
 
+	/** 
+	 * Set number of local split-screen views, reapplies graphics quality scaled down for smaller views
+	 *
+	 * @param	InNumViews	number of local players sharing the screen
+	 */
+	void SetNumSplitscreenViews(int32 InNumViews);
+
+	/** Get number of local split-screen views */
+	int32 GetNumSplitscreenViews() const
+	{
+		return NumSplitscreenViews;
+	}
+
+	/**
+	 * Save settings and input key mappings once no further save was requested for Delay seconds,
+	 * ini text is built on the game thread and written to disk on a worker thread
+	 */
+	void RequestDeferredSave(float Delay = 1.0f);
+
+	/** Save now if deferred save is pending and wait until ini files are written */
+	void FlushDeferredSave();
+
 private:
+	/** Ticker callback of deferred save */
+	bool DeferredSave(float DeltaTime);
+
+	/** Build saved ini file text of values in config file that differ from its default hierarchy */
+	static FString BuildIniText(const FConfigFile& ConfigFile);
+
+	/** Handle of pending deferred save ticker */
+	FDelegateHandle DeferredSaveHandle;
+
+	/** Handle of exit hook flushing deferred save */
+	FDelegateHandle PreExitHandle;
+
+	/** Ini write running on worker thread */
+	TFuture<void> PendingWrite;
+
+	/** Apply graphics quality preset and split-screen scaling */
+	void ApplyGraphicsQuality();
+
+	/** Scale down rendering cost of every view when screen is split */
+	void ApplySplitscreenScaling();
+
+	/** Number of local split-screen views */
+	int32 NumSplitscreenViews;
+
+	/** Should graphics quality be scaled down per view in split-screen? */
+	UPROPERTY(config)
+	bool bSplitscreenQualityScaling;
+
 	/** Is out mouse inverted or not? */
 	UPROPERTY(config)
 	bool bInvertedMouse;
@@ -12,9 +12,16 @@ class UVehicleGameViewportClient : public UGameViewportClient
 	GENERATED_UCLASS_BODY()
 
 public:
-
+	// Begin UGameViewportClient interface
+	virtual void NotifyPlayerAdded(int32 PlayerIndex, ULocalPlayer* AddedPlayer) override;
+	virtual void NotifyPlayerRemoved(int32 PlayerIndex, ULocalPlayer* RemovedPlayer) override;
+	// End UGameViewportClient interface
 
 #if WITH_EDITOR
 	virtual void DrawTransition(UCanvas* Canvas) override;
 #endif //WITH_EDITOR	
+
+protected:
+	/** scale graphics quality to number of split-screen views */
+	void UpdateSplitscreenQuality();
 };
\ No newline at end of file
@@ -0,0 +1,24 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "VehicleInputReplayCommandlet.generated.h"
+
+/**
+ * Physics regression run over recorded input logs, see FVehicleInputReplay.
+ * Every map is replayed headless in its own game process, several at once.
+ *
+ * UE4Editor-Cmd VehicleGame.uproject -run=VehicleInputReplay [-Maps=A+B] [-Parallel=N] [-Timeout=Seconds] [-FPS=60]
+ * Returns 0 when every map matched its golden file. Fails when no input logs are found
+ * or when a map is missing its input log or golden file.
+ */
+UCLASS()
+class UVehicleInputReplayCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+};
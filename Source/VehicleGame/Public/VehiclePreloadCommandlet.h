@@ -0,0 +1,34 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "VehiclePreloadCommandlet.generated.h"
+
+/**
+ * Bakes runs recorded with -VehiclePreloadRecord into UVehiclePreloadManifest assets, see UVehiclePreloadManifest::GetPackageName.
+ * Every asset keeps its earliest first use over all runs of the map; assets seen in fewer than -MinRuns runs
+ * or used later than -MaxTime seconds after map load are left out.
+ *
+ * UE4Editor-Cmd VehicleGame.uproject -run=VehiclePreload [-Maps=A+B] [-MinRuns=1] [-MaxTime=600]
+ * Returns 0 when every map was baked.
+ */
+UCLASS()
+class UVehiclePreloadCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+
+protected:
+	/** assets must be used in at least this many runs */
+	int32 MinRuns;
+
+	/** assets first used later than this are not worth holding for the whole map, seconds */
+	float MaxTime;
+
+	/** bake manifest of single map, false if it has no usable runs */
+	bool BakeMap(const FString& MapName);
+};
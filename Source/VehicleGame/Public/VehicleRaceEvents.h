@@ -0,0 +1,111 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "VehicleRaceEvents.generated.h"
+
+class AVehicleGameState;
+
+UENUM()
+namespace EVehicleRaceEvent
+{
+	enum Type
+	{
+		/** Value = seconds left until start */
+		Countdown,
+		RaceStart,
+		/** Value = index of crossed track point */
+		Checkpoint,
+		/** Value = number of completed laps */
+		Lap,
+		/** Value = finishing place */
+		Finish,
+		DidNotFinish,
+		/** Text = new info text, empty to hide it */
+		InfoText,
+		/** race was reset, progress of previous race is gone */
+		RaceReset,
+	};
+}
+
+/** single entry of the replicated race event log */
+USTRUCT()
+struct FVehicleRaceEvent : public FFastArraySerializerItem
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** what happened */
+	UPROPERTY()
+	TEnumAsByte<EVehicleRaceEvent::Type> Type;
+
+	/** racer the event is about, null for global events */
+	UPROPERTY()
+	APlayerState* Racer;
+
+	/** event specific value, see EVehicleRaceEvent */
+	UPROPERTY()
+	int32 Value;
+
+	/** race time of the event */
+	UPROPERTY()
+	float RaceTime;
+
+	/** event specific text, see EVehicleRaceEvent */
+	UPROPERTY()
+	FText Text;
+
+	/** server world time the event was added at */
+	UPROPERTY()
+	float ServerTime;
+
+	/** received with initial replication of the log or long after it happened, listeners apply its state only [Client only] */
+	bool bIsHistory;
+
+	FVehicleRaceEvent()
+		: Type(EVehicleRaceEvent::InfoText)
+		, Racer(nullptr)
+		, Value(0)
+		, RaceTime(0.0f)
+		, ServerTime(0.0f)
+		, bIsHistory(false)
+	{
+	}
+
+	/** notify owning game state about event received from server */
+	void PostReplicatedAdd(const struct FVehicleRaceEventArray& InArraySerializer);
+};
+
+/** append only race event log, replicating only new entries */
+USTRUCT()
+struct FVehicleRaceEventArray : public FFastArraySerializer
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** events, oldest first */
+	UPROPERTY()
+	TArray<FVehicleRaceEvent> Events;
+
+	/** game state owning this log */
+	AVehicleGameState* Owner;
+
+	FVehicleRaceEventArray()
+		: Owner(nullptr)
+	{
+	}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FVehicleRaceEvent, FVehicleRaceEventArray>(Events, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVehicleRaceEventArray> : public TStructOpsTypeTraitsBase2<FVehicleRaceEventArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVehicleRaceEvent, const FVehicleRaceEvent&);
@@ -0,0 +1,56 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "VehicleRacingLineCommandlet.generated.h"
+
+/**
+ * Bakes racing lines of maps into UVehicleRacingLine assets, see UVehicleRacingLine::GetPackageName.
+ * The line runs through the track point gates, optimized for minimum curvature on worker threads,
+ * optionally pulled shorter by -LengthWeight to approach minimum lap time, and dropped onto the landscape.
+ *
+ * UE4Editor-Cmd VehicleGame.uproject -run=VehicleRacingLine [-Maps=A+B] [-Spacing=200] [-LengthWeight=0] [-EdgeMargin=200]
+ *	[-MaxIterations=20000] [-Tolerance=0.01] [-MaxSpeed=3000] [-LateralAcceleration=800] [-Acceleration=500] [-BrakingDeceleration=1200]
+ * Returns 0 when every map was baked.
+ */
+UCLASS()
+class UVehicleRacingLineCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+
+protected:
+	/** line sample spacing, cm */
+	float SampleSpacing;
+
+	/** weight of line length against curvature, 0 for minimum curvature */
+	float LengthWeight;
+
+	/** kept distance between line and gate edges, cm */
+	float EdgeMargin;
+
+	/** optimizer stops after this many iterations */
+	int32 MaxIterations;
+
+	/** optimizer stops when no sample moved more than this, cm */
+	float Tolerance;
+
+	/** speed on straights, cm/s */
+	float MaxSpeed;
+
+	/** sideways acceleration the vehicle holds in corners, cm/s^2 */
+	float LateralAcceleration;
+
+	/** forward acceleration out of corners, cm/s^2 */
+	float Acceleration;
+
+	/** deceleration when braking before corners, cm/s^2 */
+	float BrakingDeceleration;
+
+	/** bake line of single map, false if map has no usable track */
+	bool BakeMap(const FString& MapPackageName);
+};
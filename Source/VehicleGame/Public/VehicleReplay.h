@@ -0,0 +1,34 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Whole race replays recorded through the engine demo net driver.
+ * Checkpoints are taken every vehicle.ReplayCheckpointInterval seconds, so seeking
+ * only has to fast forward from the closest checkpoint.
+ */
+class FVehicleReplay
+{
+public:
+	/** start recording if enabled for this net mode [Server only] */
+	static void StartRecording(UWorld* World);
+
+	/** stop recording and report replay size */
+	static void StopRecording(UWorld* World);
+
+	/** is replay being recorded? */
+	static bool IsRecording(UWorld* World);
+
+	/** jump replay playback to given time and report seek latency */
+	static void Seek(UWorld* World, float TimeInSeconds);
+
+private:
+	/** get size of recorded replay on disk, 0 if streamer doesn't store it locally */
+	static int64 GetReplaySize(const FString& ReplayName);
+
+	/** name of replay being recorded */
+	static FString RecordingReplayName;
+
+	/** real time recording started at */
+	static double RecordingStartTime;
+};
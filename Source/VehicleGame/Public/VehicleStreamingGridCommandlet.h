@@ -0,0 +1,40 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "VehicleStreamingGridCommandlet.generated.h"
+
+/**
+ * Splits static actors of maps into cell sublevels streamed by FVehicleGridStreamer and bakes their
+ * UVehicleStreamingGrid, see UVehicleStreamingGrid::GetPackageName. Colliding and visual only actors of a cell
+ * go to separate sublevels, so servers can skip the visual ones. Movable, replicated, gameplay and referenced
+ * actors, landscape, foliage and anything larger than -MaxActorSize stay in the persistent level.
+ * Maps are saved in place, run it once on a fresh checkout of the map. Lighting build data of moved actors is
+ * not carried over, rebuild lighting of the split map with all cells loaded afterwards.
+ *
+ * UE4Editor-Cmd VehicleGame.uproject -run=VehicleStreamingGrid [-Maps=A+B] [-CellSize=50000] [-MaxActorSize=50000]
+ * Returns 0 when every map was split.
+ */
+UCLASS()
+class UVehicleStreamingGridCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+
+protected:
+	/** edge length of cells, cm */
+	float CellSize;
+
+	/** actors with larger bounds stay in the persistent level, cm */
+	float MaxActorSize;
+
+	/** split single map, false if it could not be split */
+	bool SplitMap(const FString& MapPackageName);
+
+	/** can actor live in a cell sublevel? */
+	bool CanMoveToCell(AActor* Actor) const;
+};
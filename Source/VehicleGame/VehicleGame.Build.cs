@@ -19,6 +19,8 @@ public class VehicleGame : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[] {
 				"InputCore",
+				"HTTP",
+				"Json",
 				"Slate",
 				"SlateCore",
 				"VehicleGameLoadingScreen",
@@ -7,15 +7,37 @@
 #include "SlateExtras.h"
 #include "MoviePlayer.h"
 #include "SThrobber.h"
+#include "Engine/World.h"
 
 // This module must be loaded "PreLoadingScreen" in the .uproject file, otherwise it will not hook in time!
 
+DECLARE_LOG_CATEGORY_STATIC(LogVehicleLoading, Log, All);
+
+/** load progress of map shown by loading screen in 1/1000, sampled on game thread, read by loading screen widget */
+static FThreadSafeCounter MapLoadProgress;
+
+/** package of the loading screen image */
+static const TCHAR* LoadingScreenPackage = TEXT("/Game/UI/Menu/LoadingScreen");
+
+/** loading screen image, resource arrives from async load, drawn only once it is set */
 struct FVehicleGameLoadingScreenBrush : public FSlateDynamicImageBrush, public FGCObject
 {
 	FVehicleGameLoadingScreenBrush( const FName InTextureName, const FVector2D& InImageSize )
 		: FSlateDynamicImageBrush( InTextureName, InImageSize )
 	{
-		ResourceObject = LoadObject<UObject>( nullptr, *InTextureName.ToString() );
+	}
+
+	/** set loaded image, called on game thread */
+	void SetResource(UObject* InResourceObject)
+	{
+		ResourceObject = InResourceObject;
+		bLoaded = ResourceObject != nullptr;
+	}
+
+	/** can be drawn? safe on loading thread */
+	bool IsLoaded() const
+	{
+		return bLoaded;
 	}
 
 	virtual void AddReferencedObjects(FReferenceCollector& Collector)
@@ -25,18 +47,26 @@ struct FVehicleGameLoadingScreenBrush : public FSlateDynamicImageBrush, public F
 			Collector.AddReferencedObject(ResourceObject);
 		}
 	}
+
+private:
+	/** set after ResourceObject, so the loading thread never draws half set brush */
+	FThreadSafeBool bLoaded;
 };
 
 class SVehicleLoadingScreen : public SCompoundWidget
 {
 public:
 	SLATE_BEGIN_ARGS(SVehicleLoadingScreen) {}
+		/** loading screen image, drawn once loaded */
+		SLATE_ARGUMENT(TSharedPtr<FVehicleGameLoadingScreenBrush>, Brush)
+		/** show load progress of map published in MapLoadProgress, otherwise only a throbber */
+		SLATE_ARGUMENT(bool, ShowProgress)
 	SLATE_END_ARGS()
 
 	void Construct(const FArguments& InArgs)
 	{
-		static const FName LoadingScreenName(TEXT("/Game/UI/Menu/LoadingScreen.LoadingScreen"));
-		LoadingScreenBrush = MakeShareable( new FVehicleGameLoadingScreenBrush( LoadingScreenName, FVector2D(1920,1080) ) );
+		LoadingScreenBrush = InArgs._Brush;
+		bShowProgress = InArgs._ShowProgress;
 
 		ChildSlot
 		[
@@ -46,7 +76,7 @@ public:
 			.VAlign(VAlign_Fill)
 			[
 				SNew(SImage)
-				.Image(LoadingScreenBrush.Get())
+				.Image(this, &SVehicleLoadingScreen::GetLoadingScreenBrush)
 			]
 			+SOverlay::Slot()
 			.HAlign(HAlign_Fill)
@@ -61,19 +91,55 @@ public:
 					SNew(SThrobber)
 					.Visibility(this, &SVehicleLoadingScreen::GetLoadIndicatorVisibility)
 				]
+				+SVerticalBox::Slot()
+				.AutoHeight()
+				.VAlign(VAlign_Bottom)
+				.HAlign(HAlign_Fill)
+				.Padding(FMargin(40.0f, 10.0f, 40.0f, 40.0f))
+				[
+					SNew(SBox)
+					.HeightOverride(12.0f)
+					.Visibility(this, &SVehicleLoadingScreen::GetProgressBarVisibility)
+					[
+						SNew(SProgressBar)
+						.Percent(this, &SVehicleLoadingScreen::GetLoadProgress)
+					]
+				]
 			]
 		];
 	}
 
 private:
+	const FSlateBrush* GetLoadingScreenBrush() const
+	{
+		return LoadingScreenBrush.IsValid() && LoadingScreenBrush->IsLoaded() ? LoadingScreenBrush.Get() : nullptr;
+	}
+
 	EVisibility GetLoadIndicatorVisibility() const
 	{
-		bool Vis =  GetMoviePlayer()->IsLoadingFinished();
 		return GetMoviePlayer()->IsLoadingFinished() ? EVisibility::Collapsed : EVisibility::Visible;
 	}
-	
+
+	EVisibility GetProgressBarVisibility() const
+	{
+		return bShowProgress ? EVisibility::Visible : EVisibility::Collapsed;
+	}
+
+	/** progress of map package and its imports, runs on loading thread so it only reads the published value */
+	TOptional<float> GetLoadProgress() const
+	{
+		if (GetMoviePlayer()->IsLoadingFinished())
+		{
+			return 1.0f;
+		}
+		return MapLoadProgress.GetValue() * 0.001f;
+	}
+
 	/** loading screen image brush */
-	TSharedPtr<FSlateDynamicImageBrush> LoadingScreenBrush;
+	TSharedPtr<FVehicleGameLoadingScreenBrush> LoadingScreenBrush;
+
+	/** is progress bar shown? */
+	bool bShowProgress;
 };
 
 class FVehicleGameLoadingScreenModule : public IVehicleGameLoadingScreenModule
@@ -81,35 +147,173 @@ class FVehicleGameLoadingScreenModule : public IVehicleGameLoadingScreenModule
 public:
 	virtual void StartupModule() override
 	{
-		//force load for cooker reference
-		LoadObject<UObject>(nullptr, TEXT("/Game/UI/Menu/LoadingScreen.LoadingScreen")/*, nullptr, LOAD_None, nullptr*/);
+		ModuleStartTime = FPlatformTime::Seconds();
+		TravelStartTime = 0.0;
+		PreLoadMapTime = 0.0;
+
+		// image is a tiny package, but loading it here would stall engine startup, so only the cooker loads it to keep the reference
+		static const FName LoadingScreenName(TEXT("/Game/UI/Menu/LoadingScreen.LoadingScreen"));
+		LoadingScreenBrush = MakeShareable(new FVehicleGameLoadingScreenBrush(LoadingScreenName, FVector2D(1920, 1080)));
+		if (IsRunningCommandlet())
+		{
+			LoadObject<UObject>(nullptr, *LoadingScreenName.ToString());
+		}
+		else
+		{
+			TWeakPtr<FVehicleGameLoadingScreenBrush> WeakBrush = LoadingScreenBrush;
+			const double RequestTime = ModuleStartTime;
+			LoadPackageAsync(LoadingScreenPackage, FLoadPackageAsyncDelegate::CreateLambda([this, WeakBrush, RequestTime](const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+			{
+				TSharedPtr<FVehicleGameLoadingScreenBrush> Brush = WeakBrush.Pin();
+				if (Brush.IsValid() && Result == EAsyncLoadingResult::Succeeded)
+				{
+					Brush->SetResource(FindObject<UObject>(Package, *FPackageName::GetShortName(PackageName)));
+				}
+				RecordPhase(TEXT("Startup"), TEXT("LoadingScreenAssets"), FPlatformTime::Seconds() - RequestTime);
+			}));
+		}
+
+		FCoreDelegates::OnPostEngineInit.AddRaw(this, &FVehicleGameLoadingScreenModule::OnPostEngineInit);
+		FCoreUObjectDelegates::PreLoadMap.AddRaw(this, &FVehicleGameLoadingScreenModule::OnPreLoadMap);
+		FCoreUObjectDelegates::PostLoadMapWithWorld.AddRaw(this, &FVehicleGameLoadingScreenModule::OnPostLoadMap);
+		FCoreDelegates::OnAsyncLoadingFlushUpdate.AddRaw(this, &FVehicleGameLoadingScreenModule::SampleLoadProgress);
 
 		if (IsMoviePlayerEnabled())
 		{
-			CreateScreen();
+			CreateScreen(NAME_None);
 		}
 	}
-	
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnPostEngineInit.RemoveAll(this);
+		FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
+		FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+		FCoreDelegates::OnAsyncLoadingFlushUpdate.RemoveAll(this);
+		FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+	}
+
 	virtual bool IsGameModule() const override
 	{
 		return true;
 	}
 
-	virtual void StartInGameLoadingScreen() override
+	virtual void StartInGameLoadingScreen(const FString& MapPackageName) override
 	{
-		CreateScreen();
+		TravelStartTime = FPlatformTime::Seconds();
+		TravelMapName = FPackageName::GetShortName(MapPackageName);
+
+		// map loads asynchronously until travel flushes it, and the ticker stops while the game thread waits in the flush
+		ProgressMapPackageName = *MapPackageName;
+		MapLoadProgress.Set(0);
+		FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+		ProgressTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float)
+		{
+			SampleLoadProgress();
+			return true;
+		}));
+
+		CreateScreen(*MapPackageName);
 
 		GetMoviePlayer()->PlayMovie();
 	}
 
-	virtual void CreateScreen()
+	virtual void CreateScreen(FName MapPackageName)
 	{
 		FLoadingScreenAttributes LoadingScreen;
 		LoadingScreen.bAutoCompleteWhenLoadingCompletes = true;
-		LoadingScreen.WidgetLoadingScreen = SNew(SVehicleLoadingScreen);
+		LoadingScreen.WidgetLoadingScreen = SNew(SVehicleLoadingScreen)
+			.Brush(LoadingScreenBrush)
+			.ShowProgress(!MapPackageName.IsNone());
 		GetMoviePlayer()->SetupLoadingScreen(LoadingScreen);
 	}
 
+private:
+	void OnPostEngineInit()
+	{
+		RecordPhase(TEXT("Startup"), TEXT("EngineInit"), FPlatformTime::Seconds() - ModuleStartTime);
+	}
+
+	void OnPreLoadMap(const FString& MapURL)
+	{
+		PreLoadMapTime = FPlatformTime::Seconds();
+	}
+
+	void OnPostLoadMap(UWorld* LoadedWorld)
+	{
+		const double Now = FPlatformTime::Seconds();
+		const FString MapName = LoadedWorld ? FPackageName::GetShortName(LoadedWorld->GetOutermost()->GetName()) : TravelMapName;
+		if (PreLoadMapTime > 0.0)
+		{
+			RecordPhase(*MapName, TEXT("MapLoad"), Now - PreLoadMapTime);
+		}
+		if (TravelStartTime > 0.0)
+		{
+			RecordPhase(*MapName, TEXT("Travel"), Now - TravelStartTime);
+		}
+
+		PreLoadMapTime = 0.0;
+		TravelStartTime = 0.0;
+
+		ProgressMapPackageName = NAME_None;
+		FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+		ProgressTickerHandle.Reset();
+	}
+
+	/**
+	 * Publish load progress of map being traveled to for the loading screen widget, game thread only.
+	 * Package is not known to async loader before travel starts loading it and after it finished,
+	 * the last value is kept so the bar never jumps back.
+	 */
+	void SampleLoadProgress()
+	{
+		if (ProgressMapPackageName.IsNone())
+		{
+			return;
+		}
+
+		const float Percentage = GetAsyncLoadPercentage(ProgressMapPackageName);
+		if (Percentage >= 0.0f)
+		{
+			MapLoadProgress.Set(FMath::Max(MapLoadProgress.GetValue(), FMath::RoundToInt(Percentage * 10.0f)));
+		}
+	}
+
+	/** log duration of load phase and append it to Saved/Logs/LoadTimes.csv, which is kept across runs */
+	void RecordPhase(const TCHAR* Context, const TCHAR* Phase, double Seconds)
+	{
+		UE_LOG(LogVehicleLoading, Log, TEXT("%s %s took %.3f s"), Context, Phase, Seconds);
+
+		const FString Filename = FPaths::ProjectLogDir() / TEXT("LoadTimes.csv");
+		FString Line;
+		if (IFileManager::Get().FileSize(*Filename) <= 0)
+		{
+			Line += TEXT("Timestamp,BuildVersion,Context,Phase,Seconds") LINE_TERMINATOR;
+		}
+		Line += FString::Printf(TEXT("%s,%s,%s,%s,%.4f") LINE_TERMINATOR, *FDateTime::UtcNow().ToIso8601(), FApp::GetBuildVersion(), Context, Phase, Seconds);
+		FFileHelper::SaveStringToFile(Line, *Filename, FFileHelper::EEncodingOptions::ForceAnsi, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	/** loading screen image shared by all screens */
+	TSharedPtr<FVehicleGameLoadingScreenBrush> LoadingScreenBrush;
+
+	/** time module started, startup phases are measured from it */
+	double ModuleStartTime;
+
+	/** time in game loading screen started, 0 if none is pending */
+	double TravelStartTime;
+
+	/** time current map load started, 0 if none is pending */
+	double PreLoadMapTime;
+
+	/** map being traveled to */
+	FString TravelMapName;
+
+	/** long package name of map whose load progress is sampled, none if no travel is pending */
+	FName ProgressMapPackageName;
+
+	/** handle of ticker sampling load progress before travel flushes loading */
+	FDelegateHandle ProgressTickerHandle;
 };
 
 IMPLEMENT_GAME_MODULE(FVehicleGameLoadingScreenModule, VehicleGameLoadingScreen);
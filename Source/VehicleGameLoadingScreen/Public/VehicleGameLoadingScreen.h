@@ -9,6 +9,10 @@
 class IVehicleGameLoadingScreenModule : public IModuleInterface
 {
 public:
-	/** Kicks off the loading screen for in game loading (not startup) */
-	virtual void StartInGameLoadingScreen() = 0;
+	/**
+	 * Kicks off the loading screen for in game loading (not startup)
+	 *
+	 * @param	MapPackageName	long package name of the map being traveled to, its load progress is shown
+	 */
+	virtual void StartInGameLoadingScreen(const FString& MapPackageName) = 0;
 };